@@ -0,0 +1,1449 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Cycle count benchmark of the Blinky firmware. The unmodified firmware ELF is
+ * run in simavr. The entry and return of the profiled functions are detected by
+ * watching the program counter and the stack pointer, so no instrumentation of
+ * the firmware is needed.
+ *
+ * There is no USB host in the simulation, so reports from the host are injected
+ * by calling Command_Handle() from the main loop, right before HID_Task() runs.
+ *
+ * With -u the harness also acts as the host of a firmware update: it transfers
+ * the given image with the flash commands, lets the device install it and
+ * compares the flash afterwards. There is no bootloader in the simulation, so
+ * the harness provides the flash functions of its API table.
+ *
+ * With -k the harness measures the skew of scheduled triggers: each simulated
+ * unit has its own crystal error and power-on time. The harness synchronizes
+ * with its clock by Echo reports like the host does, with a random USB latency
+ * of up to one polling interval per direction, and schedules a trigger for the
+ * same host time on all units. The time when Blinker_Enable() is entered is
+ * compared with the scheduled time. The host clocks are assumed to be exact.
+ *
+ * With -w the AUX pin is traced into a VCD file and decoded as the data line
+ * of a WS2812 LED strip. Every pulse is checked against the timing of the
+ * datasheet, and each frame is printed with its number of pixels.
+ *
+ * With -t the reports of a HID trace recorded by the host are injected instead
+ * of a report file, as fast as possible or with -r at their recorded times in
+ * simulated time. Each response is compared with the recorded answer that has
+ * the same sync byte. Answers containing the clock or counters of the device
+ * are not compared. The recorded latency includes the USB polling, so it is
+ * printed next to the simulated cycles only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <gelf.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_vcd_file.h>
+#include <simavr/avr_ioport.h>
+
+#define REPORT_SIZE 8
+#define MAX_PROBES 16
+#define MAX_REPORTS 64
+#define FILL_SIZE 6
+#define WRITE_ATTEMPTS 3
+// Approximate duration of a page erase or write (4 ms), the CPU is halted meanwhile.
+#define SPM_CYCLES 64000
+
+#define CMD_FlashInfo 12
+#define CMD_FlashCrc 13
+#define CMD_FlashBegin 14
+#define CMD_FlashFill 15
+#define CMD_FlashWrite 16
+#define CMD_FlashCommit 17
+#define CMD_GetStats 9
+#define CMD_Echo 10
+#define CMD_ScheduleTrigger 20
+
+#define FLASH_OK 0
+#define FLASH_ERR_CRC 3
+
+#define SCHEDULE_OK 0
+
+#define MAX_UNITS 64
+#define SKEW_SAMPLES 16
+// Maximum crystal error of a unit and maximum delay of its power-on
+#define SKEW_PPM 50
+#define SKEW_BOOT_US 50000
+// Host time when all units are triggered
+#define SKEW_FIRE_US 250000
+// Time the host needs between two reports
+#define SKEW_GAP_US 1000
+
+// WS2812 timing at 16 MHz in cycles: high time of a 0 and a 1 with a tolerance
+// of 150 ns, and the low time after which the pixels latch the frame (50 us).
+#define STRIP_PIN 6
+#define STRIP_T0H_MIN 4
+#define STRIP_T0H_MAX 8
+#define STRIP_T1H_MIN 11
+#define STRIP_T1H_MAX 15
+#define STRIP_LATCH 800
+
+// Header of a trace file: magic "BLTR", version, record size, timer frequency,
+// start time and dropped records. A record is the timer ticks since the start
+// shifted by 8 bits with the kind in the lowest byte, followed by the report.
+#define TRACE_MAGIC 0x52544C42
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 32
+#define TRACE_RECORD_SIZE 16
+#define TRACE_Sent 1
+#define TRACE_Received 2
+#define TRACE_Timeout 3
+
+typedef struct
+{
+	const char* symbol;
+	const char* label;
+	uint32_t address;
+	int active;
+	uint16_t sp;
+	avr_cycle_count_t start;
+	unsigned long calls;
+	avr_cycle_count_t min;
+	avr_cycle_count_t max;
+	avr_cycle_count_t sum;
+} Probe_t;
+
+typedef struct
+{
+	char name[32];
+	uint8_t data[REPORT_SIZE];
+	int update;
+	int skew;
+	int trace;
+} Report_t;
+
+enum
+{
+	UPDATE_Info,
+	UPDATE_Crc,
+	UPDATE_Begin,
+	UPDATE_Fill,
+	UPDATE_Write,
+	UPDATE_Commit,
+	UPDATE_Restart,
+	UPDATE_Done
+};
+
+typedef struct
+{
+	uint8_t* file;
+	long fileSize;
+	int extraPages;
+	uint8_t* image;
+	int pages;
+	int pageSize;
+	int stagingBase;
+	int state;
+	int page;
+	int offset;
+	int attempt;
+	uint8_t* needed;
+	unsigned long reports;
+	int skipped;
+	int written;
+	int retries;
+	avr_cycle_count_t start;
+	avr_cycle_count_t end;
+	const char* error;
+} Update_t;
+
+enum
+{
+	SKEW_Sync,
+	SKEW_Schedule,
+	SKEW_Wait,
+	SKEW_Done
+};
+
+typedef struct
+{
+	int units;
+	int unit;
+	int pollingUs;
+	double ppm;
+	double boot;
+	int state;
+	int samples;
+	double sent;
+	avr_cycle_count_t due;
+	double bestRtt;
+	double offset;
+	double error[MAX_UNITS];
+	const char* failure;
+} Skew_t;
+
+enum
+{
+	INJECT_None,
+	INJECT_Clock,
+	INJECT_Command
+};
+
+typedef struct
+{
+	const char* file;
+	avr_vcd_t vcd;
+	avr_cycle_count_t rise;
+	avr_cycle_count_t fall;
+	avr_cycle_count_t frameStart;
+	int high;
+	int bits;
+	uint8_t data[3];
+	unsigned long frames;
+	int pixels;
+	unsigned long errors;
+	avr_cycle_count_t t0Min, t0Max, t1Min, t1Max, lowMax;
+} Strip_t;
+
+typedef struct
+{
+	uint8_t report[REPORT_SIZE];
+	uint8_t answer[REPORT_SIZE];
+	int answered;
+	double time;
+	double latency;
+} TraceStep_t;
+
+typedef struct
+{
+	TraceStep_t* steps;
+	int count;
+	int next;
+	int realtime;
+	avr_cycle_count_t start;
+	avr_cycle_count_t end;
+	unsigned long compared;
+	unsigned long clock;
+	unsigned long differences;
+	double duration;
+} Trace_t;
+
+static Probe_t probes[MAX_PROBES];
+static int probeCount;
+static Report_t reports[MAX_REPORTS];
+static int reportCount;
+static int nextReport;
+static Report_t updateReport;
+static Update_t update;
+static Report_t skewReport;
+static Skew_t skew;
+static Strip_t strip;
+static Report_t traceReport;
+static Trace_t trace;
+static uint32_t hidTask;
+static uint32_t commandHandle;
+static uint32_t clockMicros;
+static uint32_t commandArrival;
+static uint32_t blinkerEnable;
+static uint8_t pageBuffer[256];
+
+static uint32_t lookupSymbol(const char* file, const char* name)
+{
+	uint32_t result = 0;
+	int fd = open(file, O_RDONLY);
+
+	if (fd < 0)
+		return 0;
+
+	elf_version(EV_CURRENT);
+	Elf* elf = elf_begin(fd, ELF_C_READ, NULL);
+	Elf_Scn* scn = NULL;
+
+	while (result == 0 && (scn = elf_nextscn(elf, scn)) != NULL)
+	{
+		GElf_Shdr shdr;
+		gelf_getshdr(scn, &shdr);
+
+		if (shdr.sh_type != SHT_SYMTAB)
+			continue;
+
+		Elf_Data* data = elf_getdata(scn, NULL);
+		size_t count = shdr.sh_size / shdr.sh_entsize;
+
+		for (size_t a = 0; a < count; a++)
+		{
+			GElf_Sym sym;
+			gelf_getsym(data, a, &sym);
+
+			if (strcmp(elf_strptr(elf, shdr.sh_link, sym.st_name), name) == 0)
+			{
+				result = (uint32_t)sym.st_value;
+				break;
+			}
+		}
+	}
+
+	elf_end(elf);
+	close(fd);
+
+	return result;
+}
+
+static void loadSection(avr_t* avr, const char* file, const char* name)
+{
+	// simavr only loads the standard sections of the firmware.
+	int fd = open(file, O_RDONLY);
+	size_t strings;
+
+	if (fd < 0)
+		return;
+
+	elf_version(EV_CURRENT);
+	Elf* elf = elf_begin(fd, ELF_C_READ, NULL);
+	Elf_Scn* scn = NULL;
+
+	elf_getshdrstrndx(elf, &strings);
+
+	while ((scn = elf_nextscn(elf, scn)) != NULL)
+	{
+		GElf_Shdr shdr;
+		gelf_getshdr(scn, &shdr);
+
+		if (strcmp(elf_strptr(elf, strings, shdr.sh_name), name) != 0)
+			continue;
+
+		Elf_Data* data = elf_getdata(scn, NULL);
+
+		if (shdr.sh_addr + data->d_size > avr->flashend + 1)
+		{
+			fprintf(stderr, "Section %s doesn't fit into the flash of the simulated MCU.\n", name);
+			exit(1);
+		}
+
+		memcpy(&avr->flash[shdr.sh_addr], data->d_buf, data->d_size);
+	}
+
+	elf_end(elf);
+	close(fd);
+}
+
+static void addProbe(const char* file, char* spec)
+{
+	// A probe is specified as "symbol" or "symbol:label".
+	char* label = strchr(spec, ':');
+
+	if (label)
+		*label++ = 0;
+
+	if (probeCount == MAX_PROBES)
+	{
+		fprintf(stderr, "Too many probes.\n");
+		exit(1);
+	}
+
+	Probe_t* probe = &probes[probeCount++];
+	probe->symbol = spec;
+	probe->label = label ? label : spec;
+	probe->address = lookupSymbol(file, spec);
+	probe->min = (avr_cycle_count_t)-1;
+
+	if (probe->address == 0)
+	{
+		fprintf(stderr, "Symbol %s not found in %s.\n", spec, file);
+		exit(1);
+	}
+}
+
+static void loadReports(const char* file)
+{
+	// One report per line: a name followed by the report bytes in hex.
+	// Empty lines and lines starting with # are ignored.
+	char line[256];
+	FILE* f = fopen(file, "r");
+
+	if (f == NULL)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	while (fgets(line, sizeof(line), f) && reportCount < MAX_REPORTS)
+	{
+		Report_t* report = &reports[reportCount];
+		unsigned int b[REPORT_SIZE];
+
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+
+		if (sscanf(line, "%31s %x %x %x %x %x %x %x %x", report->name,
+			&b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]) != REPORT_SIZE + 1)
+		{
+			fprintf(stderr, "%s: invalid line: %s", file, line);
+			exit(1);
+		}
+
+		for (int a = 0; a < REPORT_SIZE; a++)
+			report->data[a] = (uint8_t)b[a];
+
+		reportCount++;
+	}
+
+	fclose(f);
+}
+
+static void loadUpdate(const char* file)
+{
+	FILE* f = fopen(file, "rb");
+
+	if (f == NULL)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	fseek(f, 0, SEEK_END);
+	update.fileSize = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	update.file = malloc(update.fileSize);
+	if (fread(update.file, 1, update.fileSize, f) != (size_t)update.fileSize)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	fclose(f);
+}
+
+static uint64_t readLE(const uint8_t* data, int size)
+{
+	uint64_t value = 0;
+
+	while (size--)
+		value = (value << 8) | data[size];
+
+	return value;
+}
+
+static void loadTrace(const char* file)
+{
+	uint8_t header[TRACE_HEADER_SIZE], record[TRACE_RECORD_SIZE];
+	FILE* f = fopen(file, "rb");
+
+	if (f == NULL)
+	{
+		perror(file);
+		exit(1);
+	}
+
+	if (fread(header, 1, sizeof(header), f) != sizeof(header) || readLE(header, 4) != TRACE_MAGIC
+		|| readLE(&header[4], 2) != TRACE_VERSION || readLE(&header[6], 2) != TRACE_RECORD_SIZE)
+	{
+		fprintf(stderr, "%s: not a trace file of version %d.\n", file, TRACE_VERSION);
+		exit(1);
+	}
+
+	double frequency = (double)readLE(&header[8], 8);
+	int capacity = 0;
+
+	if (readLE(&header[24], 8))
+		fprintf(stderr, "%s: %llu records were dropped while recording.\n", file, (unsigned long long)readLE(&header[24], 8));
+
+	// A trace which wasn't closed ends at the first empty record.
+	while (fread(record, 1, sizeof(record), f) == sizeof(record))
+	{
+		uint64_t word = readLE(record, 8);
+		int kind = word & 0xFF;
+		double time = (word >> 8) / frequency;
+
+		if (word == 0)
+			break;
+
+		trace.duration = time;
+
+		if (kind == TRACE_Sent)
+		{
+			if (trace.count == capacity)
+			{
+				capacity = capacity ? 2 * capacity : 256;
+				trace.steps = realloc(trace.steps, capacity * sizeof(TraceStep_t));
+			}
+
+			TraceStep_t* step = &trace.steps[trace.count++];
+			memcpy(step->report, &record[8], REPORT_SIZE);
+			step->answered = 0;
+			step->time = time;
+		}
+		else if (kind == TRACE_Received && trace.count)
+		{
+			// The answer has the sync byte of the last report sent. Earlier answers
+			// repeated by the device are skipped.
+			TraceStep_t* step = &trace.steps[trace.count - 1];
+
+			if (!step->answered && record[15] == step->report[REPORT_SIZE - 1])
+			{
+				memcpy(step->answer, &record[8], REPORT_SIZE);
+				step->answered = 1;
+				step->latency = time - step->time;
+			}
+		}
+	}
+
+	fclose(f);
+}
+
+static uint16_t getSP(avr_t* avr)
+{
+	return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+static void setSP(avr_t* avr, uint16_t sp)
+{
+	avr->data[R_SPL] = sp & 0xFF;
+	avr->data[R_SPH] = sp >> 8;
+}
+
+static uint16_t crcUpdate(uint16_t crc, uint8_t data)
+{
+	// Same as _crc_ccitt_update() of avr-libc.
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+
+	return (((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3);
+}
+
+static uint16_t pageCrc(const uint8_t* page, int size)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (int a = 0; a < size; a++)
+		crc = crcUpdate(crc, page[a]);
+
+	return crc;
+}
+
+static int bootloaderCall(avr_t* avr)
+{
+	// Flash functions of the LUFA DFU bootloader API table at the end of the flash.
+	uint32_t table = avr->flashend + 1 - 32;
+
+	if (avr->pc < table || avr->pc >= table + 32)
+		return 0;
+
+	uint8_t* r = avr->data;
+	uint32_t address = r[22] | (r[23] << 8) | ((uint32_t)r[24] << 16) | ((uint32_t)r[25] << 24);
+	int size = update.pageSize ? update.pageSize : 128;
+	uint32_t page = address & ~(uint32_t)(size - 1);
+
+	switch ((avr->pc - table) / 2)
+	{
+		case 0:
+			// ErasePage(address); this also clears the temporary page buffer.
+			memset(&avr->flash[page], 0xFF, size);
+			memset(pageBuffer, 0xFF, sizeof(pageBuffer));
+			avr->cycle += SPM_CYCLES;
+			break;
+		case 1:
+			// WritePage(address)
+			memcpy(&avr->flash[page], pageBuffer, size);
+			memset(pageBuffer, 0xFF, sizeof(pageBuffer));
+			avr->cycle += SPM_CYCLES;
+			break;
+		case 2:
+			// FillWord(address, word)
+			pageBuffer[(address & (size - 1)) & ~1] = r[20];
+			pageBuffer[(address & (size - 1)) | 1] = r[21];
+			break;
+		default:
+			fprintf(stderr, "Bootloader API function %u is not simulated.\n", (avr->pc - table) / 2);
+			break;
+	}
+
+	// Return to the caller (word address, high byte on top).
+	uint16_t sp = getSP(avr);
+	avr->pc = ((avr->data[sp + 1] << 8) | avr->data[sp + 2]) << 1;
+	setSP(avr, sp + 2);
+
+	return 1;
+}
+
+static void updateFail(const char* error)
+{
+	update.error = error;
+	update.state = UPDATE_Done;
+}
+
+static void updateNextPage(void)
+{
+	// Skip the pages which already match.
+	while (update.page < update.pages && !update.needed[update.page])
+		update.page++;
+
+	update.attempt = 0;
+	update.state = update.page < update.pages ? UPDATE_Begin : UPDATE_Commit;
+}
+
+static int updateNext(uint8_t* report, avr_t* avr)
+{
+	uint8_t* page = &update.image[update.page * update.pageSize];
+
+	memset(report, 0, REPORT_SIZE);
+	report[REPORT_SIZE - 1] = (uint8_t)update.reports;
+
+	switch (update.state)
+	{
+		case UPDATE_Info:
+			update.start = avr->cycle;
+			report[0] = CMD_FlashInfo;
+			break;
+		case UPDATE_Crc:
+			report[0] = CMD_FlashCrc;
+			report[1] = update.page;
+			break;
+		case UPDATE_Begin:
+			report[0] = CMD_FlashBegin;
+			report[1] = update.page;
+			update.offset = 0;
+			break;
+		case UPDATE_Fill:
+			report[0] = CMD_FlashFill;
+			for (int a = 0; a < FILL_SIZE && update.offset + a < update.pageSize; a++)
+				report[a + 1] = page[update.offset + a];
+			break;
+		case UPDATE_Write:
+		{
+			uint16_t crc = pageCrc(page, update.pageSize);
+
+			// The first transfer is sent with a wrong CRC, it must be rejected.
+			if (update.written == 0 && update.retries == 0)
+				crc ^= 1;
+
+			report[0] = CMD_FlashWrite;
+			report[1] = update.page;
+			report[2] = crc & 0xFF;
+			report[3] = crc >> 8;
+			break;
+		}
+		case UPDATE_Commit:
+			if (update.written == 0)
+			{
+				updateFail("nothing to update");
+				return 0;
+			}
+			report[0] = CMD_FlashCommit;
+			report[1] = update.pages;
+			update.state = UPDATE_Restart;
+			break;
+		default:
+			return 0;
+	}
+
+	update.reports++;
+	return 1;
+}
+
+static void updateResponse(const uint8_t* response)
+{
+	switch (update.state)
+	{
+		case UPDATE_Info:
+		{
+			if (response[1] != FLASH_OK)
+			{
+				updateFail("bootloader API not available");
+				return;
+			}
+
+			update.pageSize = response[2] | (response[3] << 8);
+			update.stagingBase = response[4];
+			update.pages = (update.fileSize + update.pageSize - 1) / update.pageSize + update.extraPages;
+
+			if (update.pages > response[5] || update.pageSize > (int)sizeof(pageBuffer))
+			{
+				updateFail("image too large");
+				return;
+			}
+
+			// The image padded to whole pages, followed by the extra pages.
+			update.image = malloc(update.pages * update.pageSize);
+			update.needed = calloc(update.pages, 1);
+			memset(update.image, 0xFF, update.pages * update.pageSize);
+			memcpy(update.image, update.file, update.fileSize);
+
+			for (int a = (update.pages - update.extraPages) * update.pageSize; a < update.pages * update.pageSize; a++)
+				update.image[a] = (uint8_t)(a * 7);
+
+			update.page = 0;
+			update.state = UPDATE_Crc;
+			break;
+		}
+		case UPDATE_Crc:
+		{
+			uint16_t crc = response[2] | (response[3] << 8);
+
+			// Pages in the staging area are overwritten during the transfer.
+			update.needed[update.page] = update.page >= update.stagingBase ||
+				crc != pageCrc(&update.image[update.page * update.pageSize], update.pageSize);
+			if (!update.needed[update.page])
+				update.skipped++;
+
+			if (++update.page == update.pages)
+			{
+				update.page = 0;
+				updateNextPage();
+			}
+			break;
+		}
+		case UPDATE_Begin:
+			if (response[2] != FLASH_OK)
+				updateFail("page rejected");
+			else
+				update.state = UPDATE_Fill;
+			break;
+		case UPDATE_Fill:
+			update.offset += FILL_SIZE;
+			if (update.offset >= update.pageSize)
+				update.state = UPDATE_Write;
+			break;
+		case UPDATE_Write:
+			if (update.written == 0 && update.retries == 0 && response[2] != FLASH_ERR_CRC)
+				updateFail("wrong CRC not rejected");
+			else if (response[2] == FLASH_OK)
+			{
+				update.written++;
+				update.page++;
+				updateNextPage();
+			}
+			else if (++update.attempt < WRITE_ATTEMPTS)
+			{
+				update.retries++;
+				update.state = UPDATE_Begin;
+			}
+			else
+				updateFail("page not written");
+			break;
+		case UPDATE_Restart:
+			// Command_Handle() returned, so the commit was refused.
+			updateFail("commit refused");
+			break;
+	}
+}
+
+static void updateRestarted(avr_t* avr)
+{
+	if (update.state != UPDATE_Restart)
+	{
+		updateFail("unexpected restart");
+		return;
+	}
+
+	update.end = avr->cycle;
+	update.state = UPDATE_Done;
+
+	if (memcmp(avr->flash, update.image, update.pages * update.pageSize) != 0)
+		update.error = "flash doesn't match the image";
+}
+
+static double skewTime(avr_t* avr)
+{
+	// Host time in microseconds; the firmware assumes exactly 16 MHz.
+	return skew.boot + avr->cycle / (16.0 * (1 + skew.ppm * 1e-6));
+}
+
+static avr_cycle_count_t skewCycle(double time)
+{
+	return time <= skew.boot ? 0 : (avr_cycle_count_t)((time - skew.boot) * 16.0 * (1 + skew.ppm * 1e-6));
+}
+
+static double skewRandom(double max)
+{
+	return max * rand() / RAND_MAX;
+}
+
+static double skewLatency(void)
+{
+	// The report waits for the next poll of the endpoint.
+	return skewRandom(skew.pollingUs);
+}
+
+static void skewSend(double time)
+{
+	skew.sent = time;
+	skew.due = skewCycle(time + skewLatency());
+}
+
+static void skewBegin(void)
+{
+	skew.ppm = skewRandom(2 * SKEW_PPM) - SKEW_PPM;
+	skew.boot = skewRandom(SKEW_BOOT_US);
+	skew.state = SKEW_Sync;
+	skew.samples = 0;
+	skew.bestRtt = 1e12;
+	skew.failure = NULL;
+	skewSend(skew.boot);
+}
+
+static int skewNext(uint8_t* report, avr_t* avr)
+{
+	if (skew.state > SKEW_Schedule || avr->cycle < skew.due)
+		return 0;
+
+	memset(report, 0, REPORT_SIZE);
+	report[REPORT_SIZE - 1] = (uint8_t)skew.samples;
+
+	if (skew.state == SKEW_Sync)
+		report[0] = CMD_Echo;
+	else
+	{
+		// Device time of the host time to fire at (little endian)
+		uint32_t at = (uint32_t)(int64_t)(SKEW_FIRE_US + skew.offset);
+
+		report[0] = CMD_ScheduleTrigger;
+		report[1] = 1;
+		report[3] = at & 0xFF;
+		report[4] = (at >> 8) & 0xFF;
+		report[5] = (at >> 16) & 0xFF;
+		report[6] = at >> 24;
+	}
+
+	return 1;
+}
+
+static void skewResponse(const uint8_t* response, avr_t* avr)
+{
+	double received = skewTime(avr) + skewLatency();
+
+	if (skew.state == SKEW_Schedule)
+	{
+		if (response[1] != SCHEDULE_OK)
+		{
+			skew.failure = "schedule not accepted";
+			skew.state = SKEW_Done;
+		}
+		else
+			skew.state = SKEW_Wait;
+		return;
+	}
+
+	// Same as the host: the sample with the shortest round trip is used. The
+	// middle of the processing on the device is mapped to the middle of the
+	// round trip.
+	uint32_t arrival = response[1] | (response[2] << 8) | ((uint32_t)response[3] << 16) | ((uint32_t)response[4] << 24);
+	uint16_t processing = response[5] | (response[6] << 8);
+	double rtt = received - skew.sent;
+
+	if (rtt < skew.bestRtt)
+	{
+		skew.bestRtt = rtt;
+		skew.offset = (arrival + processing / 2.0) - (skew.sent + received) / 2;
+	}
+
+	if (++skew.samples == SKEW_SAMPLES)
+		skew.state = SKEW_Schedule;
+
+	skewSend(received + SKEW_GAP_US);
+}
+
+static int traceNext(uint8_t* report, avr_t* avr)
+{
+	if (trace.next == trace.count)
+		return 0;
+
+	TraceStep_t* step = &trace.steps[trace.next];
+
+	if (trace.start == 0)
+		trace.start = avr->cycle;
+	if (trace.realtime && avr->cycle < trace.start + (avr_cycle_count_t)((step->time - trace.steps[0].time) * avr->frequency))
+		return 0;
+
+	memcpy(report, step->report, REPORT_SIZE);
+	snprintf(traceReport.name, sizeof(traceReport.name), "%.3f", step->time * 1000);
+	trace.next++;
+	trace.end = avr->cycle;
+
+	return 1;
+}
+
+static void traceResponse(const uint8_t* response)
+{
+	TraceStep_t* step = &trace.steps[trace.next - 1];
+
+	if (!step->answered)
+		return;
+
+	if (step->report[0] == CMD_GetStats || step->report[0] == CMD_Echo || step->report[0] == CMD_ScheduleTrigger)
+	{
+		trace.clock++;
+		return;
+	}
+
+	trace.compared++;
+
+	// The sync byte is always the one of the report.
+	if (memcmp(response, step->answer, REPORT_SIZE - 1) == 0)
+		return;
+
+	trace.differences++;
+	printf("%14s recorded", "");
+	for (int a = 0; a < REPORT_SIZE; a++)
+		printf(" %02x", step->answer[a]);
+	printf(" after %.0f us\n", step->latency * 1e6);
+}
+
+static int traceResult(avr_t* avr)
+{
+	printf("\nTrace: %d reports in %.1f ms, recorded in %.1f ms; %lu answers compared, %lu differ, %lu depend on the clock\n",
+		trace.next, (trace.end - trace.start) * 1000.0 / avr->frequency, (trace.duration - trace.steps[0].time) * 1000,
+		trace.compared, trace.differences, trace.clock);
+
+	return trace.next != trace.count || trace.differences;
+}
+
+static Report_t* getReport(avr_t* avr)
+{
+	if (skew.units)
+	{
+		if (!skewNext(skewReport.data, avr))
+			return NULL;
+
+		skewReport.skew = 1;
+		return &skewReport;
+	}
+
+	if (nextReport < reportCount)
+		return &reports[nextReport++];
+
+	if (trace.steps && traceNext(traceReport.data, avr))
+	{
+		traceReport.trace = 1;
+		return &traceReport;
+	}
+
+	if (update.file && updateNext(updateReport.data, avr))
+	{
+		updateReport.update = 1;
+		return &updateReport;
+	}
+
+	return NULL;
+}
+
+static void updateProbes(avr_t* avr)
+{
+	uint16_t sp = getSP(avr);
+
+	for (int a = 0; a < probeCount; a++)
+	{
+		Probe_t* probe = &probes[a];
+
+		if (!probe->active && avr->pc == probe->address)
+		{
+			probe->active = 1;
+			probe->sp = sp;
+			probe->start = avr->cycle;
+		}
+		else if (probe->active && sp == probe->sp + 2)
+		{
+			// RET or RETI popped the return address of this call.
+			avr_cycle_count_t cycles = avr->cycle - probe->start;
+
+			probe->active = 0;
+			probe->calls++;
+			probe->sum += cycles;
+			if (cycles < probe->min)
+				probe->min = cycles;
+			if (cycles > probe->max)
+				probe->max = cycles;
+		}
+	}
+}
+
+static void stripError(avr_t* avr, const char* error, avr_cycle_count_t cycles)
+{
+	if (strip.errors++ < 10)
+		printf("Strip: %s (%llu cycles) at cycle %llu\n", error, (unsigned long long)cycles, (unsigned long long)avr->cycle);
+}
+
+static void stripFrameEnd(avr_t* avr)
+{
+	int pixels = strip.bits / 24;
+
+	if (strip.bits % 24)
+		stripError(avr, "frame with incomplete pixel", strip.bits);
+	else if (strip.frames && pixels != strip.pixels)
+		stripError(avr, "frame with a different number of pixels", pixels);
+
+	printf("Strip: frame %lu at cycle %llu, %d pixels in %llu cycles, first pixel %02x%02x%02x\n",
+		strip.frames + 1, (unsigned long long)strip.frameStart, pixels,
+		(unsigned long long)(strip.fall - strip.frameStart), strip.data[1], strip.data[0], strip.data[2]);
+
+	strip.frames++;
+	strip.pixels = pixels;
+	strip.bits = 0;
+}
+
+static void stripChanged(struct avr_irq_t* irq, uint32_t value, void* param)
+{
+	avr_t* avr = param;
+
+	// Writes to the port notify without a change of the pin, too.
+	if (!value == !strip.high)
+		return;
+
+	strip.high = value != 0;
+
+	if (value)
+	{
+		avr_cycle_count_t low = avr->cycle - strip.fall;
+
+		if (strip.bits && low >= STRIP_LATCH)
+			stripFrameEnd(avr);
+		else if (strip.bits && low > strip.lowMax)
+			strip.lowMax = low;
+
+		if (strip.bits == 0)
+			strip.frameStart = avr->cycle;
+
+		strip.rise = avr->cycle;
+		return;
+	}
+
+	// The high time determines the value of the bit.
+	avr_cycle_count_t high = avr->cycle - strip.rise;
+	int bit;
+
+	strip.fall = avr->cycle;
+
+	if (high >= STRIP_T0H_MIN && high <= STRIP_T0H_MAX)
+	{
+		bit = 0;
+		if (high < strip.t0Min)
+			strip.t0Min = high;
+		if (high > strip.t0Max)
+			strip.t0Max = high;
+	}
+	else if (high >= STRIP_T1H_MIN && high <= STRIP_T1H_MAX)
+	{
+		bit = 1;
+		if (high < strip.t1Min)
+			strip.t1Min = high;
+		if (high > strip.t1Max)
+			strip.t1Max = high;
+	}
+	else
+	{
+		stripError(avr, "invalid high time", high);
+		bit = high > STRIP_T0H_MAX;
+	}
+
+	// Keep the first pixel of the frame (green, red, blue).
+	if (strip.bits < 24)
+		strip.data[strip.bits / 8] = (strip.data[strip.bits / 8] << 1) | bit;
+
+	strip.bits++;
+}
+
+static void stripTrace(avr_t* avr)
+{
+	avr_irq_t* irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), STRIP_PIN);
+
+	strip.t0Min = strip.t1Min = (avr_cycle_count_t)-1;
+	avr_irq_register_notify(irq, stripChanged, avr);
+
+	avr_vcd_init(avr, strip.file, &strip.vcd, 100000);
+	avr_vcd_add_signal(&strip.vcd, irq, 1, "AUX");
+	avr_vcd_start(&strip.vcd);
+}
+
+static int stripResult(avr_t* avr)
+{
+	avr_vcd_stop(&strip.vcd);
+
+	if (strip.bits)
+		stripFrameEnd(avr);
+
+	if (strip.frames == 0)
+		stripError(avr, "no frame sent", 0);
+	else
+		printf("\nStrip: %lu frames, high time of a 0 %llu - %llu cycles, of a 1 %llu - %llu cycles, longest low time %llu cycles\n",
+			strip.frames, (unsigned long long)strip.t0Min, (unsigned long long)strip.t0Max,
+			(unsigned long long)strip.t1Min, (unsigned long long)strip.t1Max, (unsigned long long)strip.lowMax);
+
+	printf("Strip timing %s\n", strip.errors ? "FAILED" : "verified");
+
+	return strip.errors != 0;
+}
+
+static uint16_t call(avr_t* avr, uint16_t sp, uint32_t address)
+{
+	// Push the return address (word address, high byte on top).
+	uint16_t returnAddress = hidTask >> 1;
+	avr->data[sp--] = returnAddress & 0xFF;
+	avr->data[sp--] = returnAddress >> 8;
+
+	setSP(avr, sp);
+	avr->pc = address;
+
+	return sp;
+}
+
+static uint16_t callCommandHandle(avr_t* avr, uint16_t sp, const uint8_t* report, uint16_t* toHost)
+{
+	// Reserve space for both report buffers on the stack, so the callee
+	// doesn't overwrite them.
+	uint16_t fromHost = sp - 2 * REPORT_SIZE + 1;
+	*toHost = fromHost + REPORT_SIZE;
+	memcpy(&avr->data[fromHost], report, REPORT_SIZE);
+	memset(&avr->data[*toHost], 0, REPORT_SIZE);
+
+	// Arguments of Command_Handle(fromHost, toHost)
+	avr->data[24] = fromHost & 0xFF;
+	avr->data[25] = fromHost >> 8;
+	avr->data[22] = *toHost & 0xFF;
+	avr->data[23] = *toHost >> 8;
+
+	return call(avr, fromHost - 1, commandHandle);
+}
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s [-m mcu] [-c cycles] [-s reports] [-u image.bin [-x pages]] [-k units [-p polling ms]] [-w trace.vcd] [-t trace.bin [-r]] [-f symbol[:label]]... firmware.elf\n", name);
+	exit(1);
+}
+
+static int run(avr_t* avr, unsigned long long runCycles)
+{
+	Report_t* report = NULL;
+	int injecting = INJECT_None;
+	uint16_t injectSP = 0, savedSP = 0, toHost = 0;
+	avr_cycle_count_t injectStart = 0, endCycle = 0;
+	int state = cpu_Running;
+
+	while (state != cpu_Done && state != cpu_Crashed)
+	{
+		if (avr->pc == hidTask)
+		{
+			uint16_t sp = getSP(avr);
+
+			if (injecting == INJECT_Clock && sp == injectSP + 2)
+			{
+				// Clock_Micros() returned; HID_Task() stores the time of arrival of a
+				// report the same way.
+				memcpy(&avr->data[commandArrival], &avr->data[22], sizeof(uint32_t));
+				injectSP = callCommandHandle(avr, sp, report->data, &toHost);
+				injecting = INJECT_Command;
+				injectStart = avr->cycle;
+			}
+			else if (injecting == INJECT_Command && sp == injectSP + 2)
+			{
+				// Command_Handle() returned to the entry of HID_Task().
+				if (report->update)
+					updateResponse(&avr->data[toHost]);
+				else if (report->skew)
+					skewResponse(&avr->data[toHost], avr);
+				else
+				{
+					printf("%-14s", report->name);
+					for (int a = 0; a < REPORT_SIZE; a++)
+						printf(" %02x", report->data[a]);
+					printf(" ");
+					for (int a = 0; a < REPORT_SIZE; a++)
+						printf(" %02x", avr->data[toHost + a]);
+					printf(" %8llu%s\n", (unsigned long long)(avr->cycle - injectStart),
+						avr->data[24] ? " (unknown command)" : "");
+
+					if (report->trace)
+						traceResponse(&avr->data[toHost]);
+				}
+
+				setSP(avr, savedSP);
+				injecting = INJECT_None;
+			}
+			else if (injecting == INJECT_Command && sp == savedSP)
+			{
+				// Command_Handle() didn't return, the firmware was restarted.
+				updateRestarted(avr);
+				injecting = INJECT_None;
+			}
+			else if (!injecting && (report = getReport(avr)) != NULL)
+			{
+				savedSP = sp;
+
+				if (commandArrival)
+				{
+					// Like HID_Task(), get the time of arrival first.
+					injectSP = call(avr, sp, clockMicros);
+					injecting = INJECT_Clock;
+				}
+				else
+				{
+					injectSP = callCommandHandle(avr, sp, report->data, &toHost);
+					injecting = INJECT_Command;
+					injectStart = avr->cycle;
+				}
+			}
+			else if (!injecting && endCycle == 0 && !skew.units && trace.next == trace.count)
+			{
+				// All reports are processed, now let the firmware run for a while.
+				endCycle = avr->cycle + runCycles;
+			}
+		}
+
+		if (skew.state == SKEW_Wait && avr->pc == blinkerEnable)
+		{
+			skew.error[skew.unit] = skewTime(avr) - SKEW_FIRE_US;
+			skew.state = SKEW_Done;
+		}
+
+		if (skew.units && skew.state == SKEW_Done)
+			break;
+
+		if (bootloaderCall(avr))
+			continue;
+
+		if (!injecting)
+			updateProbes(avr);
+
+		if (endCycle && avr->cycle >= endCycle)
+			break;
+
+		if (endCycle == 0 && trace.start == 0 && avr->cycle >= 10 * runCycles)
+		{
+			fprintf(stderr, skew.units ? "Trigger not fired after %llu cycles.\n" : "Main loop not reached after %llu cycles.\n",
+				(unsigned long long)avr->cycle);
+			break;
+		}
+
+		state = avr_run(avr);
+	}
+
+	if (state == cpu_Crashed)
+		fprintf(stderr, "Firmware crashed at PC 0x%04x.\n", avr->pc);
+
+	return state;
+}
+
+static avr_t* createMcu(const char* mcu, elf_firmware_t* firmware, const char* firmwareFile)
+{
+	avr_t* avr = avr_make_mcu_by_name(mcu);
+
+	if (avr == NULL)
+	{
+		fprintf(stderr, "simavr does not support %s.\n", mcu);
+		exit(1);
+	}
+
+	avr_init(avr);
+	if (firmware->flashbase + firmware->flashsize > avr->flashend + 1)
+	{
+		fprintf(stderr, "The firmware doesn't fit into the flash of %s, build it for the simulated MCU.\n", mcu);
+		exit(1);
+	}
+
+	avr_load_firmware(avr, firmware);
+	avr->frequency = 16000000;
+
+	// The copier of the firmware update, which is placed before the bootloader of the
+	// MCU the firmware was built for; a firmware for a larger MCU is rejected here.
+	loadSection(avr, firmwareFile, ".flashcopy");
+
+	if (update.file)
+	{
+		// The signature of the bootloader API.
+		avr->flash[avr->flashend - 1] = 0xFB;
+		avr->flash[avr->flashend] = 0xDC;
+	}
+
+	return avr;
+}
+
+static int measureSkew(const char* mcu, elf_firmware_t* firmware, const char* firmwareFile, unsigned long long runCycles)
+{
+	double min = 0, max = 0, sum = 0;
+	int measured = 0;
+
+	if (blinkerEnable == 0 || commandArrival == 0)
+	{
+		fprintf(stderr, "Blinker_Enable, Clock_Micros or commandArrival not found in %s.\n", firmwareFile);
+		return 1;
+	}
+
+	srand(1);
+	printf("%-6s %8s %10s %10s %10s\n", "Unit", "PPM", "Boot [us]", "RTT [us]", "Skew [us]");
+
+	for (skew.unit = 0; skew.unit < skew.units; skew.unit++)
+	{
+		skewBegin();
+
+		avr_t* avr = createMcu(mcu, firmware, firmwareFile);
+		int state = run(avr, runCycles);
+
+		avr_terminate(avr);
+
+		if (state == cpu_Crashed || skew.state != SKEW_Done || skew.failure)
+		{
+			printf("%-6d FAILED: %s\n", skew.unit + 1, skew.failure ? skew.failure : "not triggered");
+			continue;
+		}
+
+		double error = skew.error[skew.unit];
+
+		printf("%-6d %8.1f %10.0f %10.0f %10.1f\n", skew.unit + 1, skew.ppm, skew.boot, skew.bestRtt, error);
+
+		if (measured == 0 || error < min)
+			min = error;
+		if (measured == 0 || error > max)
+			max = error;
+		sum += error;
+		measured++;
+	}
+
+	if (measured)
+		printf("\nSkew: min %.1f us, avg %.1f us, max %.1f us, spread %.1f us\n", min, sum / measured, max, max - min);
+
+	return measured != skew.units;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* mcu = "at90usb162";
+	const char* reportFile = NULL;
+	char* probeSpecs[MAX_PROBES];
+	int probeSpecCount = 0;
+	unsigned long long runCycles = 16000000;
+	int opt;
+
+	skew.pollingUs = 5000;
+
+	while ((opt = getopt(argc, argv, "m:c:s:u:x:k:p:w:t:rf:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'm':
+				mcu = optarg;
+				break;
+			case 'c':
+				runCycles = strtoull(optarg, NULL, 0);
+				break;
+			case 's':
+				reportFile = optarg;
+				break;
+			case 'u':
+				loadUpdate(optarg);
+				break;
+			case 'x':
+				update.extraPages = atoi(optarg);
+				break;
+			case 'k':
+				skew.units = atoi(optarg);
+				if (skew.units < 1 || skew.units > MAX_UNITS)
+					usage(argv[0]);
+				break;
+			case 'p':
+				skew.pollingUs = atoi(optarg) * 1000;
+				break;
+			case 'w':
+				strip.file = optarg;
+				break;
+			case 't':
+				loadTrace(optarg);
+				break;
+			case 'r':
+				trace.realtime = 1;
+				break;
+			case 'f':
+				if (probeSpecCount < MAX_PROBES)
+					probeSpecs[probeSpecCount++] = optarg;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (optind != argc - 1)
+		usage(argv[0]);
+
+	const char* firmwareFile = argv[optind];
+
+	for (int a = 0; a < probeSpecCount; a++)
+		addProbe(firmwareFile, probeSpecs[a]);
+	if (reportFile)
+		loadReports(reportFile);
+
+	hidTask = lookupSymbol(firmwareFile, "HID_Task");
+	commandHandle = lookupSymbol(firmwareFile, "Command_Handle");
+	clockMicros = lookupSymbol(firmwareFile, "Clock_Micros");
+	blinkerEnable = lookupSymbol(firmwareFile, "Blinker_Enable");
+
+	// Data addresses are offset by 0x800000 in the ELF file.
+	commandArrival = lookupSymbol(firmwareFile, "commandArrival") & 0xFFFF;
+	if (clockMicros == 0)
+		commandArrival = 0;
+
+	if (hidTask == 0 || commandHandle == 0)
+	{
+		fprintf(stderr, "HID_Task or Command_Handle not found in %s.\n", firmwareFile);
+		return 1;
+	}
+
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+
+	if (elf_read_firmware(firmwareFile, &firmware) != 0)
+	{
+		fprintf(stderr, "Unable to load %s.\n", firmwareFile);
+		return 1;
+	}
+
+	if (skew.units)
+		return measureSkew(mcu, &firmware, firmwareFile, runCycles);
+
+	avr_t* avr = createMcu(mcu, &firmware, firmwareFile);
+
+	if (strip.file)
+		stripTrace(avr);
+
+	printf("%-14s %-24s %-24s %8s\n", "Command", "Report", "Response", "Cycles");
+
+	int state = run(avr, runCycles);
+	int failed = strip.file && stripResult(avr);
+
+	if (trace.steps && traceResult(avr))
+		failed = 1;
+
+	if (update.file)
+	{
+		if (update.state != UPDATE_Done)
+			update.error = "not finished";
+
+		printf("\nUpdate: %d pages, %d skipped, %d written, %d retries, %lu reports",
+			update.pages, update.skipped, update.written, update.retries, update.reports);
+		if (update.end)
+			printf(", %llu cycles", (unsigned long long)(update.end - update.start));
+		printf("\nUpdate %s%s\n", update.error ? "FAILED: " : "verified", update.error ? update.error : "");
+	}
+
+	printf("\n%-14s %10s %8s %8s %8s\n", "Function", "Calls", "Min", "Avg", "Max");
+
+	for (int a = 0; a < probeCount; a++)
+	{
+		Probe_t* probe = &probes[a];
+
+		if (probe->calls == 0)
+		{
+			printf("%-14s %10s\n", probe->label, "-");
+			continue;
+		}
+
+		printf("%-14s %10lu %8llu %8llu %8llu\n", probe->label, probe->calls,
+			(unsigned long long)probe->min, (unsigned long long)(probe->sum / probe->calls),
+			(unsigned long long)probe->max);
+	}
+
+	return state == cpu_Crashed || (update.file && update.error) || failed;
+}
@@ -9,8 +9,10 @@
 #include "Blinker.h"
 
 static uint8_t blinkCounter;
+#if FEATURE_TIMEOUT
 static uint8_t ovrflwToSec;
 static uint16_t secondsCounter;
+#endif
 
 static void _display_enable(void)
 {
@@ -26,33 +28,46 @@ static void _display_disable(void)
 
 void Blinker_Setup(void)
 {
-	// Set BLINKER_TOUCH as input; BLINKER_AUX as output
+	// Set BLINKER_TOUCH as input; BLINKER_AUX as output, which is the data line
+	// of the LED strip, too.
+#if FEATURE_TOUCH
 	DDRB &= ~(_BV(BLINKER_TOUCH));
+#endif
+#if FEATURE_AUX || STRIP_PIXELS
 	DDRB |= _BV(BLINKER_AUX);
 	PORTB &= ~(_BV(BLINKER_AUX));
+#endif
 }
 
 void Blinker_Enable(uint8_t blinkerSettings)
 {
 	blinkCounter = 0;
+#if FEATURE_TIMEOUT
 	ovrflwToSec = 0;
 	secondsCounter = 0;
+#endif
 	
 	// Normal mode, with prescaler of 1024; overflow interrupt enabled
 	TCCR0B |= _BV(CS02) | _BV(CS00);
 	TIMSK0 |= _BV(TOIE0);
 	
+#if FEATURE_TOUCH
 	// Watch for changes on the touch sensor input pin
 	if (blinkerSettings & BLINKER_ENABLE_TOUCH)
 		BLINKER_STATR |= BLINKER_STAT_TOUCH;
+#endif
+#if FEATURE_TIMEOUT
 	// Enable blinker timeout
 	if (blinkerSettings & BLINKER_ENABLE_TIMEOUT)
 		BLINKER_STATR |= BLINKER_STAT_TIMEOUT;
+#endif
 	
 	 _display_enable();
 	 
+#if FEATURE_AUX && !STRIP_PIXELS
 	 // Set AUX output to high
 	 PORTB |= _BV(BLINKER_AUX);
+#endif
 }
 
 void Blinker_Disable(void)
@@ -65,15 +80,18 @@ void Blinker_Disable(void)
 	BLINKER_STATR &= ~BLINKER_STAT_TOUCH;
 	BLINKER_STATR &= ~BLINKER_STAT_TIMEOUT;
 	
+#if FEATURE_AUX && !STRIP_PIXELS
 	// Set AUX output to low
 	PORTB &= ~(_BV(BLINKER_AUX));
+#endif
 }
 
-ISR(TIMER0_OVF_vect)
+static inline void _blinker_tick(void)
 {
 	// Overflow of Timer0 happened. Increment our internal counter.
 	blinkCounter++;
 	
+#if FEATURE_TIMEOUT
 	// Timeout logic: 16.000.000 MHz F_CPU with a timer prescaler of 1024 and
 	// an overflow of an 8 bit timer results in 61.03 interrupts per second.
 	// The error of 0.0351... can be neglected here.
@@ -94,6 +112,7 @@ ISR(TIMER0_OVF_vect)
 				return;
 			}
 	}
+#endif
 	
 	// If the setpoint is reached, toggle the display.
 	if (blinkCounter >= settings.BlinkInterval)
@@ -110,9 +129,29 @@ ISR(TIMER0_OVF_vect)
 		blinkCounter = 0;
 	}
 	
+#if FEATURE_TOUCH
 	// Check if the touch sensor is enabled and if yes, check if it sensed a touch.
 	// (The output from the sensor is low-active.)
 	if (BLINKER_STATR & BLINKER_STAT_TOUCH)
 		if (!(PINB & _BV(BLINKER_TOUCH)))
 			Blinker_Disable();
+#endif
+}
+
+ISR(TIMER0_OVF_vect)
+{
+	// Timer1 runs with the CPU clock, so its counter is used to measure the
+	// duration of this interrupt.
+	uint16_t start = TCNT1;
+	
+	_blinker_tick();
+	
+	uint16_t end = TCNT1;
+	uint16_t duration = end - start;
+	
+	if (end < start)
+		duration += DISPLAY_PWM_TOP + 1;
+	
+	if (duration > stats.MaxIsrTicks)
+		stats.MaxIsrTicks = duration;
 }
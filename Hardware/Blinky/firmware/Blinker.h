@@ -6,6 +6,22 @@
 
 #include "Display.h"
 #include "Settings.h"
+#include "Stats.h"
+
+/*
+ * Optional features, set by the build variant in the makefile. A board without
+ * a touch sensor or AUX connector doesn't need their code, and the interrupt
+ * of the blinker gets shorter without their checks.
+ */
+#ifndef FEATURE_TOUCH
+#define FEATURE_TOUCH 1				// Touch sensor can disable the blinker
+#endif
+#ifndef FEATURE_TIMEOUT
+#define FEATURE_TIMEOUT 1			// Blinker is disabled after the timeout
+#endif
+#ifndef FEATURE_AUX
+#define FEATURE_AUX 1				// AUX output follows the blinker
+#endif
 
 #define BLINKER_STATR GPIOR0		// GPIO register for blinker status
 #define BLINKER_STAT_DISPLAY 1		// Bit for Display enabled in status register
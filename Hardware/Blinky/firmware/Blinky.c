@@ -55,6 +55,11 @@ int main(void)
 	{
 		HID_Task();
 		USB_USBTask();
+		Stats_Task();
+		Schedule_Task();
+#if STRIP_PIXELS
+		Strip_Task();
+#endif
 	}
 }
 
@@ -71,12 +76,17 @@ void SetupHardware(void)
 	/* Hardware Initialization */
 	USB_Init();
 	
-	// Load settings from EEPROM.
+	// Load settings and profiles from EEPROM.
 	Settings_Load();
+	Profiles_Load();
 	// Init display driver.
 	Display_Setup();
 	Display_Disable();
+	Clock_Setup();
 	Blinker_Setup();
+#if STRIP_PIXELS
+	Strip_Setup();
+#endif
 }
 
 /** Event handler for the USB_ConfigurationChanged event. This is fired when the host sets the current configuration
@@ -89,6 +99,18 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 	Endpoint_ConfigureEndpoint(GENERIC_OUT_EPADDR, EP_TYPE_INTERRUPT, GENERIC_EPSIZE, 1);
 }
 
+/** Event handler for the USB_Reset event. This is fired when the host resets the device. */
+void EVENT_USB_Device_Reset(void)
+{
+	stats.UsbResets++;
+}
+
+/** Event handler for the USB_Suspend event. This is fired when the host suspends the bus. */
+void EVENT_USB_Device_Suspend(void)
+{
+	stats.UsbSuspends++;
+}
+
 void HID_Task(void)
 {
 	/* Device must be connected and configured for the task to run */
@@ -103,11 +125,14 @@ void HID_Task(void)
 		/* Check to see if the packet contains data */
 		if (Endpoint_IsReadWriteAllowed())
 		{
+			commandArrival = Clock_Micros();
+
 			/* Create a temporary buffer to hold the read in report from the host */
 			uint8_t GenericData[GENERIC_REPORT_SIZE];
 
 			/* Read Generic Report Data */
 			Endpoint_Read_Stream_LE(&GenericData, sizeof(GenericData), NULL);
+			stats.Reports++;
 
 			/* Process Generic Report Data */
 			Command_Handle(GenericData, reportToHost);
@@ -122,7 +147,8 @@ void HID_Task(void)
 	/* Check to see if the host is ready to accept another packet */
 	if (Endpoint_IsINReady())
 	{
-		/* Write Generic Report Data */
+		/* Take the time of an Echo answer and write Generic Report Data */
+		Command_Queued(reportToHost);
 		Endpoint_Write_Stream_LE(&reportToHost, sizeof(reportToHost), NULL);
 
 		/* Finalize the stream transfer to send the last packet */
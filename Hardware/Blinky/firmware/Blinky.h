@@ -55,6 +55,9 @@
 		#include "Blinker.h"
 		#include "Commands.h"
 		#include "Bootloader.h"
+		#include "Clock.h"
+		#include "Stats.h"
+		#include "Strip.h"
 
 	/* Function Prototypes: */
 		void SetupHardware(void);
@@ -62,6 +65,8 @@
 
 		void EVENT_USB_Device_ConfigurationChanged(void);
 		void EVENT_USB_Device_ControlRequest(void);
+		void EVENT_USB_Device_Reset(void);
+		void EVENT_USB_Device_Suspend(void);
 
 		void ProcessGenericHIDReport(uint8_t* DataArray);
 		void CreateGenericHIDReport(uint8_t* DataArray);
@@ -24,14 +24,19 @@ void Bootloader_Jump_Check(void)
     }
 }
 
-void Bootloader_Execute(void)
+void Bootloader_Detach(void)
 {
     // If USB is used, detach from the bus and reset it
     USB_Disable();
     // Disable all interrupts
     cli();
-    // Wait two seconds for the USB detachment to register on the host
-    Delay_MS(2000);
+    // Wait for the USB detachment to register on the host
+    Delay_MS(BOOTLOADER_DETACH_DELAY_MS);
+}
+
+void Bootloader_Execute(void)
+{
+    Bootloader_Detach();
     // Set the bootloader key to the magic value and force a reset
     Boot_Key = MAGIC_BOOT_KEY;
     wdt_enable(WDTO_250MS);
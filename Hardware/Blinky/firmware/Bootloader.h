@@ -8,7 +8,13 @@
 #define MAGIC_BOOT_KEY            0xDEADBEEF
 #define BOOTLOADER_START_ADDRESS  ((FLASH_SIZE_BYTES - BOOTLOADER_SEC_SIZE_BYTES) >> 1)
 
+// Time the USB detachment needs to register on the host; set by the makefile.
+#ifndef BOOTLOADER_DETACH_DELAY_MS
+    #define BOOTLOADER_DETACH_DELAY_MS 100
+#endif
+
 void Bootloader_Jump_Check(void) ATTR_INIT_SECTION(3);
+void Bootloader_Detach(void);
 void Bootloader_Execute(void);
 
 #endif
\ No newline at end of file
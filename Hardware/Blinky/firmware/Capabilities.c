@@ -0,0 +1,54 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <avr/pgmspace.h>
+
+#include "Capabilities.h"
+#include "Commands.h"
+#include "Config/AppConfig.h"
+
+/*
+ * Describes what this build of the firmware supports, so the host doesn't
+ * have to probe for commands. Page 0 contains the version, the report size,
+ * the feature flags and the number of pages; page 1 the bitmap of the
+ * supported commands (bit n of byte n / 8 for command n).
+ */
+
+// Bit of a command in byte b of the command bitmap
+#define CMD_BIT(cmd, b) (((cmd) >> 3) == (b) ? 1 << ((cmd) & 7) : 0)
+
+#if STRIP_PIXELS
+#define CMD_BIT_STRIP(b) CMD_BIT(CMD_StripFill, b)
+#else
+#define CMD_BIT_STRIP(b) 0
+#endif
+
+// Features of the build variant; the LED strip replaces the AUX output.
+#define FEATURES ((FEATURE_TOUCH ? CAP_FEATURE_TOUCH : 0) | (FEATURE_TIMEOUT ? CAP_FEATURE_TIMEOUT : 0) \
+	| (FEATURE_AUX && !STRIP_PIXELS ? CAP_FEATURE_AUX : 0) | (STRIP_PIXELS ? CAP_FEATURE_STRIP : 0))
+
+#define COMMANDS(b) (CMD_BIT(CMD_Trigger, b) | CMD_BIT(CMD_SetSettings, b) | CMD_BIT(CMD_GetSettings, b) \
+	| CMD_BIT(CMD_SaveSettings, b) | CMD_BIT(CMD_ResetSettings, b) | CMD_BIT(CMD_Bootloader, b) \
+	| CMD_BIT(CMD_TurnOff, b) | CMD_BIT(CMD_Ping, b) | CMD_BIT(CMD_GetStats, b) | CMD_BIT(CMD_Echo, b) \
+	| CMD_BIT(CMD_GetMemory, b) | CMD_BIT(CMD_FlashInfo, b) | CMD_BIT(CMD_FlashCrc, b) \
+	| CMD_BIT(CMD_FlashBegin, b) | CMD_BIT(CMD_FlashFill, b) | CMD_BIT(CMD_FlashWrite, b) \
+	| CMD_BIT(CMD_FlashCommit, b) | CMD_BIT(CMD_SetProfile, b) | CMD_BIT(CMD_GetProfile, b) \
+	| CMD_BIT(CMD_ScheduleTrigger, b) | CMD_BIT_STRIP(b) | CMD_BIT(CMD_GetCapabilities, b))
+
+static const uint8_t capabilities[CAPABILITIES_PAGES][CAPABILITIES_PAGE_SIZE] PROGMEM =
+{
+	{ FIRMWARE_VERSION_MAJOR, FIRMWARE_VERSION_MINOR, GENERIC_REPORT_SIZE, FEATURES, CAPABILITIES_PAGES },
+	{ COMMANDS(0), COMMANDS(1), COMMANDS(2), COMMANDS(3), COMMANDS(4) }
+};
+
+void Capabilities_Get(uint8_t page, uint8_t* result)
+{
+	// An unknown page is answered with zeros.
+	if (page < CAPABILITIES_PAGES)
+		memcpy_P(result, capabilities[page], CAPABILITIES_PAGE_SIZE);
+}
@@ -0,0 +1,20 @@
+#ifndef _CAPABILITIES_H_
+#define _CAPABILITIES_H_
+
+#include <stdint.h>
+
+#define FIRMWARE_VERSION_MAJOR 0
+#define FIRMWARE_VERSION_MINOR 2
+
+// Feature flags; the trigger options have the bits of BLINKER_ENABLE_*.
+#define CAP_FEATURE_TOUCH 1			// Touch sensor can stop the blinking
+#define CAP_FEATURE_TIMEOUT 2		// Blinking stops after the timeout
+#define CAP_FEATURE_AUX 4			// AUX output follows the display
+#define CAP_FEATURE_STRIP 8			// LED strip on the AUX pin
+
+#define CAPABILITIES_PAGES 2
+#define CAPABILITIES_PAGE_SIZE 5	// Bytes of a page, the first byte of the answer is the page
+
+void Capabilities_Get(uint8_t page, uint8_t* result);
+
+#endif
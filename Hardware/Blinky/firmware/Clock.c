@@ -0,0 +1,57 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Clock.h"
+
+static volatile uint32_t ticks;
+
+void Clock_Setup(void)
+{
+	// Timer1 itself is configured and started by Display_Setup().
+	TIMSK1 |= _BV(TOIE1);
+}
+
+uint32_t Clock_Ticks(void)
+{
+	uint32_t result;
+	
+	// Reading the 32 bit value must not be interrupted by the overflow.
+	uint8_t sreg = SREG;
+	cli();
+	result = ticks;
+	SREG = sreg;
+	
+	return result;
+}
+
+uint32_t Clock_Micros(void)
+{
+	uint32_t result;
+	uint16_t count;
+	
+	uint8_t sreg = SREG;
+	cli();
+	result = ticks;
+	count = TCNT1;
+	
+	// Overflow which is not handled by the interrupt yet.
+	if ((TIFR1 & _BV(TOV1)) && count < DISPLAY_PWM_TOP / 2)
+		result++;
+	SREG = sreg;
+	
+	return result * CLOCK_TICK_US + count / (F_CPU / 1000000);
+}
+
+ISR(TIMER1_OVF_vect)
+{
+	ticks++;
+	
+	// New compare values of the display are applied right after TOP.
+	if (DISPLAY_STATR & DISPLAY_STAT_LATCH)
+		Display_Latch();
+}
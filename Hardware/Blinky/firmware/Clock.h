@@ -0,0 +1,18 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "Display.h"
+
+// Timer1 is shared with the display. Every overflow of it is a clock tick.
+// 16 MHz / (4095 + 1) = 3906.25 ticks per second; 256 us per tick.
+#define CLOCK_TICK_US 256
+
+void Clock_Setup(void);
+uint32_t Clock_Ticks(void);
+uint32_t Clock_Micros(void);
+
+#endif
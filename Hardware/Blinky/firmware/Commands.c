@@ -8,11 +8,43 @@
 
 #include "Commands.h"
 
-static void Command_Trigger(uint8_t blinkerSettings)
+uint32_t commandArrival;
+
+static void Command_Trigger(uint8_t blinkerSettings, uint8_t profile, uint8_t* result)
 {
+	// An unknown profile still triggers, with the current settings.
+	if (profile != PROFILES_NONE)
+		result[0] = Profiles_Apply(profile);
+	
 	Blinker_Enable(blinkerSettings);
 }
 
+static void Command_ScheduleTrigger(uint8_t blinkerSettings, uint8_t profile, uint8_t* at, uint8_t* result)
+{
+	// Device time (little endian) when to trigger. The answer contains the
+	// status and the device time when the command was handled.
+	uint32_t time = at[0] | ((uint32_t)at[1] << 8) | ((uint32_t)at[2] << 16) | ((uint32_t)at[3] << 24);
+	
+	result[0] = Schedule_Trigger(time, blinkerSettings, profile);
+	
+	uint32_t now = Clock_Micros();
+	
+	result[1] = now & 0xFF;
+	result[2] = (now >> 8) & 0xFF;
+	result[3] = (now >> 16) & 0xFF;
+	result[4] = now >> 24;
+}
+
+#if STRIP_PIXELS
+static void Command_StripFill(uint8_t* args, uint8_t* result)
+{
+	// A run of pixels with the same color: first pixel, number of pixels, r, g, b
+	// and whether to show the frame. No pixels just returns the number of pixels.
+	result[0] = args[1] ? Strip_Fill(args[0], args[1], args[2], args[3], args[4], args[5]) : STRIP_OK;
+	result[1] = STRIP_PIXELS;
+}
+#endif
+
 static void Command_SetSettings(uint8_t r, uint8_t g, uint8_t b, uint8_t blinkInterval, uint8_t blinkTimeout)
 {
 	if (settings.Color.R != r || settings.Color.G != g || settings.Color.B != b)
@@ -24,7 +56,9 @@ static void Command_SetSettings(uint8_t r, uint8_t g, uint8_t b, uint8_t blinkIn
 	}
 	
 	settings.BlinkInterval = blinkInterval;
+#if FEATURE_TIMEOUT
 	settings.BlinkTimeout = blinkTimeout;
+#endif
 }
 
 static void Command_GetSettings(uint8_t* r, uint8_t* g, uint8_t* b, uint8_t* blinkInterval, uint8_t* blinkTimeout)
@@ -58,6 +92,125 @@ static void Command_TurnOff(void)
 	Blinker_Disable();
 }
 
+static void Command_GetStats(uint8_t index, uint8_t* result)
+{
+	uint32_t value = Stats_Get(index);
+	
+	// Index of the counter, followed by its value (little endian)
+	result[0] = index;
+	result[1] = value & 0xFF;
+	result[2] = (value >> 8) & 0xFF;
+	result[3] = (value >> 16) & 0xFF;
+	result[4] = value >> 24;
+}
+
+static void Command_Echo(uint8_t* result)
+{
+	// Time of arrival of the report (little endian), followed by the time spent
+	// until the answer is queued for the host, see Command_Queued(); both in
+	// microseconds.
+	uint32_t arrival = commandArrival;
+	
+	result[0] = arrival & 0xFF;
+	result[1] = (arrival >> 8) & 0xFF;
+	result[2] = (arrival >> 16) & 0xFF;
+	result[3] = arrival >> 24;
+}
+
+static void Command_GetMemory(uint8_t* result)
+{
+	// All values are 16 bit (little endian): bytes of the stack which were never
+	// used, bytes available for the stack, bytes of the static variables.
+	uint16_t unused = Memory_StackUnused();
+	uint16_t stack = Memory_StackSize();
+	uint16_t data = Memory_StaticSize();
+	
+	result[0] = unused & 0xFF;
+	result[1] = unused >> 8;
+	result[2] = stack & 0xFF;
+	result[3] = stack >> 8;
+	result[4] = data & 0xFF;
+	result[5] = data >> 8;
+}
+
+static void Command_FlashInfo(uint8_t* result)
+{
+	// Status, page size (little endian), first page of the staging area, maximum
+	// number of pages of an image and the first page which can't be updated.
+	result[0] = Flash_Available() ? FLASH_OK : FLASH_ERR_UNSUPPORTED;
+	result[1] = SPM_PAGESIZE & 0xFF;
+	result[2] = SPM_PAGESIZE >> 8;
+	result[3] = Flash_StagingBase();
+	result[4] = Flash_MaxPages();
+	result[5] = FLASH_COPY_PAGE;
+}
+
+static void Command_FlashCrc(uint8_t page, uint8_t* result)
+{
+	uint16_t crc = Flash_PageCrc(page);
+	
+	result[0] = page;
+	result[1] = crc & 0xFF;
+	result[2] = crc >> 8;
+}
+
+static void Command_FlashBegin(uint8_t page, uint8_t* result)
+{
+	result[0] = page;
+	result[1] = Flash_Begin(page);
+}
+
+static void Command_FlashFill(uint8_t* data)
+{
+	Flash_Fill(data);
+}
+
+static void Command_FlashWrite(uint8_t page, uint8_t crcLow, uint8_t crcHigh, uint8_t* result)
+{
+	result[0] = page;
+	result[1] = Flash_Write(page, crcLow | (crcHigh << 8));
+}
+
+static void Command_FlashCommit(uint8_t pageCount, uint8_t* result)
+{
+	// Only returns if the image is incomplete; the device restarts otherwise.
+	result[0] = Flash_Commit(pageCount);
+}
+
+static void Command_SetProfile(uint8_t slot, uint8_t* data, uint8_t* result)
+{
+	// Same layout as the arguments of SetSettings.
+	Profile_t profile = { { data[0], data[1], data[2] }, data[3], data[4] };
+	
+	result[0] = slot;
+	result[1] = Profiles_Set(slot, &profile);
+}
+
+static void Command_GetProfile(uint8_t slot, uint8_t* result)
+{
+	// Slot zero or an unknown slot returns slot zero and the number of slots.
+	if (slot == PROFILES_NONE || slot > PROFILES_COUNT)
+	{
+		result[1] = PROFILES_COUNT;
+		return;
+	}
+	
+	Profile_t* profile = &profiles[slot - 1];
+	
+	result[0] = slot;
+	result[1] = profile->Color.R;
+	result[2] = profile->Color.G;
+	result[3] = profile->Color.B;
+	result[4] = profile->BlinkInterval;
+	result[5] = profile->BlinkTimeout;
+}
+
+static void Command_GetCapabilities(uint8_t page, uint8_t* result)
+{
+	result[0] = page;
+	Capabilities_Get(page, &result[1]);
+}
+
 static void Command_Ping(uint8_t* p, uint8_t* o, uint8_t* n, uint8_t* g)
 {
 	*p = 0x50;		// P
@@ -83,7 +236,7 @@ uint8_t Command_Handle(uint8_t* fromHost, uint8_t* toHost)
 	switch(cmdId)
 	{
 		case CMD_Trigger:
-			Command_Trigger(fromHost[1]);
+			Command_Trigger(fromHost[1], fromHost[2], &toHost[1]);
 			break;
 		case CMD_SetSettings:
 			Command_SetSettings(fromHost[1], fromHost[2], fromHost[3], fromHost[4], fromHost[5]);
@@ -106,7 +259,57 @@ uint8_t Command_Handle(uint8_t* fromHost, uint8_t* toHost)
 		case CMD_Ping:
 			Command_Ping(&toHost[1], &toHost[2], &toHost[3], &toHost[4]);
 			break;
+		case CMD_GetStats:
+			Command_GetStats(fromHost[1], &toHost[1]);
+			break;
+		case CMD_Echo:
+			Command_Echo(&toHost[1]);
+			break;
+		case CMD_GetMemory:
+			Command_GetMemory(&toHost[1]);
+			break;
+		case CMD_FlashInfo:
+			Command_FlashInfo(&toHost[1]);
+			break;
+		case CMD_FlashCrc:
+			Command_FlashCrc(fromHost[1], &toHost[1]);
+			break;
+		case CMD_FlashBegin:
+			Command_FlashBegin(fromHost[1], &toHost[1]);
+			break;
+		case CMD_FlashFill:
+			Command_FlashFill(&fromHost[1]);
+			break;
+		case CMD_FlashWrite:
+			Command_FlashWrite(fromHost[1], fromHost[2], fromHost[3], &toHost[1]);
+			break;
+		case CMD_FlashCommit:
+			Command_FlashCommit(fromHost[1], &toHost[1]);
+			break;
+		case CMD_SetProfile:
+			Command_SetProfile(fromHost[1], &fromHost[2], &toHost[1]);
+			break;
+		case CMD_GetProfile:
+			Command_GetProfile(fromHost[1], &toHost[1]);
+			break;
+		case CMD_ScheduleTrigger:
+			Command_ScheduleTrigger(fromHost[1], fromHost[2], &fromHost[3], &toHost[1]);
+			break;
+#if STRIP_PIXELS
+		case CMD_StripFill:
+			Command_StripFill(&fromHost[1], &toHost[1]);
+			break;
+#endif
+		case CMD_GetCapabilities:
+			Command_GetCapabilities(fromHost[1], &toHost[1]);
+			break;
 		default:
+			// Answer with command zero and the unknown command, so the host
+			// doesn't wait for a timeout.
+			stats.UnknownCommands++;
+			toHost[0] = 0;
+			toHost[1] = cmdId;
+			toHost[7] = fromHost[7];
 			return 1;
 	}
 	
@@ -115,3 +318,15 @@ uint8_t Command_Handle(uint8_t* fromHost, uint8_t* toHost)
 	
 	return 0;
 }
+
+void Command_Queued(uint8_t* toHost)
+{
+	// The time of the Echo answer includes the wait for the IN endpoint.
+	if (toHost[0] != CMD_Echo)
+		return;
+	
+	uint16_t processing = Clock_Micros() - commandArrival;
+	
+	toHost[5] = processing & 0xFF;
+	toHost[6] = processing >> 8;
+}
@@ -5,6 +5,14 @@
 #import "Display.h"
 #import "Blinker.h"
 #import "Bootloader.h"
+#import "Stats.h"
+#import "Clock.h"
+#import "Memory.h"
+#import "Flash.h"
+#import "Profiles.h"
+#import "Schedule.h"
+#import "Strip.h"
+#import "Capabilities.h"
 
 #define CMD_Trigger 1
 #define CMD_SetSettings 2
@@ -14,6 +22,25 @@
 #define CMD_Bootloader 6
 #define CMD_TurnOff 7
 #define CMD_Ping 8
+#define CMD_GetStats 9
+#define CMD_Echo 10
+#define CMD_GetMemory 11
+#define CMD_FlashInfo 12
+#define CMD_FlashCrc 13
+#define CMD_FlashBegin 14
+#define CMD_FlashFill 15
+#define CMD_FlashWrite 16
+#define CMD_FlashCommit 17
+#define CMD_SetProfile 18
+#define CMD_GetProfile 19
+#define CMD_ScheduleTrigger 20
+#define CMD_StripFill 21
+#define CMD_GetCapabilities 22
+
+// Clock_Micros() when the report currently handled was received; set by HID_Task().
+extern uint32_t commandArrival;
 
 uint8_t Command_Handle(uint8_t* fromHost, uint8_t* toHost);
+// Completes the answer right before it is sent to the host; called by HID_Task().
+void Command_Queued(uint8_t* toHost);
 #endif
\ No newline at end of file
@@ -45,4 +45,9 @@
 
 	#define GENERIC_REPORT_SIZE       8
 
+	/* Polling interval of the HID endpoints in milliseconds; set by the makefile. */
+	#ifndef GENERIC_POLLING_INTERVAL
+		#define GENERIC_POLLING_INTERVAL  5
+	#endif
+
 #endif
@@ -12,44 +12,75 @@
 // PC5 = OC.1B = G
 // PB7 = OC.1C = B
 
+// Gamma correction of a single color component. Zero stays zero, every other value
+// results in a duty cycle of at least one timer tick, so dark colors don't vanish.
+// The expression is constant and evaluated by the compiler.
+#define GAMMA(x) ((x) == 0 ? 0 : 1 + (uint16_t)(__builtin_pow((x) / 255.0, DISPLAY_GAMMA) * (DISPLAY_PWM_TOP - 1) + 0.5))
+#define GAMMA4(x) GAMMA(x), GAMMA(x + 1), GAMMA(x + 2), GAMMA(x + 3)
+#define GAMMA16(x) GAMMA4(x), GAMMA4(x + 4), GAMMA4(x + 8), GAMMA4(x + 12)
+#define GAMMA64(x) GAMMA16(x), GAMMA16(x + 16), GAMMA16(x + 32), GAMMA16(x + 48)
+
+static const uint16_t gammaTable[256] PROGMEM =
+{
+	GAMMA64(0), GAMMA64(64), GAMMA64(128), GAMMA64(192)
+};
+
+volatile uint16_t displayCompare[3];
+// COM1x1 bits of the channels which have a color value greater than zero.
+static uint8_t outputMask;
+
 void Display_Setup(void)
 {
-	// Fast PWM, 8-bit, clear on match, set on top, with prescaler of 1024
-	TCCR1A |= _BV(COM1A1) | _BV(COM1B1) | _BV(COM1C1) | _BV(WGM10);
-	TCCR1B |= _BV(WGM12) | _BV(CS12) | _BV(CS10);
-	
+	// Fast PWM with ICR1 as TOP, no prescaler. The compare outputs are connected
+	// by Display_Enable(), so the timer runs all the time.
+	TCCR1A = _BV(WGM11);
+	TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10);
+	ICR1 = DISPLAY_PWM_TOP;
+
 	// Set the pins as outputs (this also puts a low signal to the pin)
 	DDRC |= _BV(PC6) | _BV(PC5);
 	DDRB |= _BV(PB7);
-	
+
 	Display_Update();
 }
 
-void Display_Update()
+void Display_Update(void)
 {
-	OCR1A = settings.Color.R;
-	OCR1B = settings.Color.G;
-	OCR1C = settings.Color.B;
-	
+	uint16_t r = pgm_read_word(&gammaTable[settings.Color.R]);
+	uint16_t g = pgm_read_word(&gammaTable[settings.Color.G]);
+	uint16_t b = pgm_read_word(&gammaTable[settings.Color.B]);
+
+	// The clock interrupt copies the values into the OCR1x registers. It runs
+	// right after TOP, so all three channels are latched together at the next TOP.
+	DISPLAY_STATR &= ~DISPLAY_STAT_LATCH;
+	displayCompare[0] = r;
+	displayCompare[1] = g;
+	displayCompare[2] = b;
+	DISPLAY_STATR |= DISPLAY_STAT_LATCH;
+
+	outputMask = 0;
+	if (r > 0)
+		outputMask |= _BV(COM1A1);
+	if (g > 0)
+		outputMask |= _BV(COM1B1);
+	if (b > 0)
+		outputMask |= _BV(COM1C1);
+
 	// Enable / disable the display depending if the LED should be active
-	if (OCR1A > 0 || OCR1B > 0 || OCR1C > 0)
+	if (outputMask)
 		Display_Enable();
-	else if (OCR1A == 0 && OCR1B == 0 && OCR1C == 0)
+	else
 		Display_Disable();
 }
 
 void Display_Enable(void)
 {
-	// Start the timer
-	TCCR1B |= _BV(CS12) | _BV(CS10);
+	// Connect the compare outputs of the channels in use to the pins
+	TCCR1A = (TCCR1A & ~(_BV(COM1A1) | _BV(COM1B1) | _BV(COM1C1))) | outputMask;
 }
 
 void Display_Disable(void)
 {
-	// Stop the timer
-	TCCR1B &= ~(_BV(CS10) | _BV(CS12));
-	
-	OCR1A = 0;
-	OCR1B = 0;
-	OCR1C = 0;
+	// Disconnect the compare outputs; the pins are driven low by the port again.
+	TCCR1A &= ~(_BV(COM1A1) | _BV(COM1B1) | _BV(COM1C1));
 }
@@ -2,12 +2,38 @@
 #define _DISPLAY_H_
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 #include "Settings.h"
 
+// TOP value of Timer1. 16 MHz / (4095 + 1) results in a PWM frequency of 3.9 kHz
+// with a resolution of 12 bits.
+#define DISPLAY_PWM_TOP 4095
+// Gamma value used for converting the linear 8 bit colors to PWM duty cycles.
+#define DISPLAY_GAMMA 2.2
+
+#define DISPLAY_STATR GPIOR1		// GPIO register for display status
+#define DISPLAY_STAT_LATCH 1		// Bit for new compare values pending
+
+// Compare values which are written to the OCR1x registers after the next TOP.
+extern volatile uint16_t displayCompare[3];
+
 void Display_Setup(void);
 void Display_Update(void);
 void Display_Enable(void);
 void Display_Disable(void);
 
-#endif
\ No newline at end of file
+// Called from the Timer1 overflow interrupt, if DISPLAY_STAT_LATCH is set.
+static inline void Display_Latch(void)
+{
+	// The OCR1x registers are double buffered by the hardware and take these
+	// values at the next TOP.
+	OCR1A = displayCompare[0];
+	OCR1B = displayCompare[1];
+	OCR1C = displayCompare[2];
+	
+	DISPLAY_STATR &= ~DISPLAY_STAT_LATCH;
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Flash.h"
+
+/*
+ * In-application firmware update. The new image is transferred page by page into
+ * the free flash above the running firmware (staging area). Pages which already
+ * match are not transferred at all. After all pages are staged, the copier
+ * writes them to their final location and resets the device.
+ */
+
+// Provided by the linker: end of the firmware image in the flash.
+extern uint8_t __data_load_end;
+
+// Image page currently transferred, bytes received so far and their CRC.
+static uint8_t fillPage = FLASH_NO_PAGE;
+static uint8_t fillCount;
+static uint8_t fillLow;
+static uint16_t fillCrc;
+// Image pages which are staged and have to be copied.
+static uint8_t stagedPages[FLASH_COPY_PAGE / 8 + 1];
+
+static uint16_t pageCrc(uint16_t address)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (uint8_t a = 0; a < SPM_PAGESIZE; a++)
+		crc = _crc_ccitt_update(crc, pgm_read_byte(address + a));
+
+	return crc;
+}
+
+uint8_t Flash_Available(void)
+{
+	return pgm_read_word(BOOTLOADER_MAGIC_SIGNATURE_START) == BOOTLOADER_MAGIC_SIGNATURE;
+}
+
+uint8_t Flash_StagingBase(void)
+{
+	// First page after the running firmware.
+	return ((uint16_t)&__data_load_end + SPM_PAGESIZE - 1) / SPM_PAGESIZE;
+}
+
+uint8_t Flash_MaxPages(void)
+{
+	uint8_t base = Flash_StagingBase();
+
+	return base < FLASH_COPY_PAGE ? FLASH_COPY_PAGE - base : 0;
+}
+
+uint16_t Flash_PageCrc(uint8_t page)
+{
+	return pageCrc(page * SPM_PAGESIZE);
+}
+
+uint8_t Flash_Begin(uint8_t page)
+{
+	fillPage = FLASH_NO_PAGE;
+
+	if (!Flash_Available())
+		return FLASH_ERR_UNSUPPORTED;
+	if (page >= Flash_MaxPages())
+		return FLASH_ERR_RANGE;
+
+	// Erasing also clears the temporary page buffer of the bootloader. The CPU
+	// is halted while the flash is written, so no interrupt may occur.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		BootloaderAPI_ErasePage((uint16_t)(Flash_StagingBase() + page) * SPM_PAGESIZE);
+	}
+
+	stagedPages[page >> 3] &= ~_BV(page & 7);
+	fillPage = page;
+	fillCount = 0;
+	fillCrc = 0xFFFF;
+
+	return FLASH_OK;
+}
+
+void Flash_Fill(const uint8_t* data)
+{
+	if (fillPage == FLASH_NO_PAGE)
+		return;
+
+	// The last report of a page carries fewer bytes; the rest is ignored.
+	for (uint8_t a = 0; a < FLASH_FILL_SIZE && fillCount < SPM_PAGESIZE; a++, fillCount++)
+	{
+		fillCrc = _crc_ccitt_update(fillCrc, data[a]);
+
+		if (fillCount & 1)
+		{
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				BootloaderAPI_FillWord(fillCount - 1, fillLow | (data[a] << 8));
+			}
+		}
+		else
+			fillLow = data[a];
+	}
+}
+
+uint8_t Flash_Write(uint8_t page, uint16_t crc)
+{
+	uint8_t result = FLASH_OK;
+	uint16_t address = (uint16_t)(Flash_StagingBase() + page) * SPM_PAGESIZE;
+
+	if (page != fillPage || fillCount != SPM_PAGESIZE)
+		result = FLASH_ERR_INCOMPLETE;
+	else if (crc != fillCrc)
+		result = FLASH_ERR_CRC;
+	else
+	{
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			BootloaderAPI_WritePage(address);
+		}
+
+		// Read the page back, the temporary buffer may have been lost.
+		if (pageCrc(address) == crc)
+			stagedPages[page >> 3] |= _BV(page & 7);
+		else
+			result = FLASH_ERR_VERIFY;
+	}
+
+	// A page has to be started again with Flash_Begin() in any case.
+	fillPage = FLASH_NO_PAGE;
+
+	return result;
+}
+
+uint8_t Flash_Commit(uint8_t pageCount)
+{
+	uint8_t base = Flash_StagingBase();
+	uint8_t staged = 0;
+
+	if (!Flash_Available())
+		return FLASH_ERR_UNSUPPORTED;
+	if (pageCount == 0 || pageCount > Flash_MaxPages())
+		return FLASH_ERR_RANGE;
+
+	for (uint8_t page = 0; page < pageCount; page++)
+	{
+		if (stagedPages[page >> 3] & _BV(page & 7))
+			staged++;
+		else if (page >= base)
+		{
+			// The page may have been used for staging, so it has to be transferred.
+			return FLASH_ERR_INCOMPLETE;
+		}
+	}
+
+	if (staged == 0)
+		return FLASH_ERR_INCOMPLETE;
+
+	// Doesn't return, the new firmware is started after copying.
+	Bootloader_Detach();
+	Flash_Copy(base, pageCount, stagedPages);
+}
+
+void Flash_Copy(uint8_t base, uint8_t pageCount, const uint8_t* pages)
+{
+	// Only code of this section and the bootloader may be called in here, all
+	// other pages are overwritten. The pages are copied in ascending order, so a
+	// staged page is always copied before it is overwritten by the new image.
+	for (uint8_t page = 0; page < pageCount; page++)
+	{
+		if (!(pages[page >> 3] & _BV(page & 7)))
+			continue;
+
+		uint16_t to = page * SPM_PAGESIZE;
+		uint16_t from = (uint16_t)(base + page) * SPM_PAGESIZE;
+
+		BootloaderAPI_ErasePage(to);
+		for (uint8_t a = 0; a < SPM_PAGESIZE; a += 2)
+			BootloaderAPI_FillWord(a, pgm_read_word(from + a));
+		BootloaderAPI_WritePage(to);
+	}
+
+	// Start the new firmware.
+	wdt_enable(WDTO_15MS);
+	for (;;);
+}
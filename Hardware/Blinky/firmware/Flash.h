@@ -0,0 +1,53 @@
+#ifndef _FLASH_H_
+#define _FLASH_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+#include "Bootloader.h"
+
+// The flash can't be written by the application itself, only by code in the boot
+// section. The LUFA DFU bootloader exports a jump table for this at the end of
+// the flash (see LUFA/Bootloaders/DFU/BootloaderAPI.h).
+#define BOOTLOADER_API_TABLE_SIZE 32
+#define BOOTLOADER_API_TABLE_START (FLASH_SIZE_BYTES - BOOTLOADER_API_TABLE_SIZE)
+#define BOOTLOADER_API_CALL(index) ((BOOTLOADER_API_TABLE_START + (index) * 2) / 2)
+#define BOOTLOADER_MAGIC_SIGNATURE_START (BOOTLOADER_API_TABLE_START + BOOTLOADER_API_TABLE_SIZE - 2)
+#define BOOTLOADER_MAGIC_SIGNATURE 0xDCFB
+
+#define BootloaderAPI_ErasePage ((void (*)(uint32_t))BOOTLOADER_API_CALL(0))
+#define BootloaderAPI_WritePage ((void (*)(uint32_t))BOOTLOADER_API_CALL(1))
+#define BootloaderAPI_FillWord ((void (*)(uint32_t, uint16_t))BOOTLOADER_API_CALL(2))
+
+// The copier which installs the staged image is placed at this address by the
+// linker (set by the makefile). It is never overwritten by an update.
+#ifndef FLASH_COPY_ADDRESS
+	#define FLASH_COPY_ADDRESS (FLASH_SIZE_BYTES - BOOTLOADER_SEC_SIZE_BYTES - 2 * SPM_PAGESIZE)
+#endif
+#define FLASH_COPY_PAGE (FLASH_COPY_ADDRESS / SPM_PAGESIZE)
+
+#define FLASH_FILL_SIZE 6			// Bytes of page data in a single report
+#define FLASH_NO_PAGE 0xFF
+
+#define FLASH_OK 0
+#define FLASH_ERR_UNSUPPORTED 1		// Bootloader doesn't export the API
+#define FLASH_ERR_RANGE 2			// Page is out of the updatable area
+#define FLASH_ERR_CRC 3				// Received data doesn't match the CRC
+#define FLASH_ERR_VERIFY 4			// Written page doesn't match the CRC
+#define FLASH_ERR_INCOMPLETE 5		// Page or image wasn't transferred completely
+
+uint8_t Flash_Available(void);
+uint8_t Flash_StagingBase(void);
+uint8_t Flash_MaxPages(void);
+uint16_t Flash_PageCrc(uint8_t page);
+uint8_t Flash_Begin(uint8_t page);
+void Flash_Fill(const uint8_t* data);
+uint8_t Flash_Write(uint8_t page, uint16_t crc);
+uint8_t Flash_Commit(uint8_t pageCount);
+void Flash_Copy(uint8_t base, uint8_t pageCount, const uint8_t* pages) __attribute__((noreturn, noinline, section(".flashcopy")));
+
+#endif
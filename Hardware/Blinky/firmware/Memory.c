@@ -0,0 +1,57 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Memory.h"
+
+// Provided by the linker: end of .data, .bss and .noinit and the initial stack pointer.
+extern uint8_t _end;
+extern uint8_t __stack;
+
+void Memory_Paint(void)
+{
+	// Runs before the C runtime is initialized (r1 is not zero yet), so this has
+	// to be done in assembler. Fills everything between the end of the static
+	// variables and the top of the stack with the canary value.
+	__asm volatile (
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M" (MEMORY_CANARY)
+	);
+}
+
+uint16_t Memory_StaticSize(void)
+{
+	// .data, .bss and .noinit
+	return &_end - (uint8_t*)RAMSTART;
+}
+
+uint16_t Memory_StackSize(void)
+{
+	// There is no heap, so the stack may grow down to the static variables.
+	return &__stack - &_end + 1;
+}
+
+uint16_t Memory_StackUnused(void)
+{
+	// The stack grows downwards, so the canary values at the bottom of the
+	// stack area were never overwritten.
+	const uint8_t* p = &_end;
+	
+	while (p <= &__stack && *p == MEMORY_CANARY)
+		p++;
+	
+	return p - &_end;
+}
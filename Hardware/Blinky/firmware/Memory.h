@@ -0,0 +1,14 @@
+#ifndef _MEMORY_H_
+#define _MEMORY_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define MEMORY_CANARY 0xC5			// Value the free RAM is painted with at startup
+
+void Memory_Paint(void) __attribute__((naked, used, section(".init1")));
+uint16_t Memory_StaticSize(void);
+uint16_t Memory_StackSize(void);
+uint16_t Memory_StackUnused(void);
+
+#endif
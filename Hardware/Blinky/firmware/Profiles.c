@@ -0,0 +1,85 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Profiles.h"
+
+/*
+ * Profile slots for the settings. A trigger can select a slot, so a message
+ * specific color takes a single report. The profiles are read from the EEPROM
+ * once at start; triggering only copies them from RAM.
+ */
+
+Profile_t profiles[PROFILES_COUNT];
+
+static uint8_t EEMEM s_header;
+static Profile_t EEMEM s_profiles[PROFILES_COUNT];
+
+static uint8_t valid(uint8_t slot)
+{
+	return slot != PROFILES_NONE && slot <= PROFILES_COUNT;
+}
+
+void Profiles_Load(void)
+{
+	if (eeprom_read_byte(&s_header) == PROFILES_HEADER)
+	{
+		eeprom_read_block(profiles, s_profiles, sizeof(profiles));
+		return;
+	}
+	
+	// Looks like an uninitialized EEPROM. All slots start with the defaults.
+	for (uint8_t a = 0; a < PROFILES_COUNT; a++)
+	{
+		profiles[a].Color = (Color_t) SETTINGS_DEFAULT_COLOR;
+		profiles[a].BlinkInterval = SETTINGS_DEFAULT_INTERVAL;
+		profiles[a].BlinkTimeout = SETTINGS_DEFAULT_TIMEOUT;
+	}
+}
+
+uint8_t Profiles_Set(uint8_t slot, const Profile_t* profile)
+{
+	if (!valid(slot))
+		return PROFILES_ERR_RANGE;
+	
+	profiles[slot - 1] = *profile;
+	
+	// Only bytes which differ are written, so uploading an unchanged profile
+	// doesn't wear the EEPROM. The first upload writes all slots, so the
+	// others keep their defaults.
+	if (eeprom_read_byte(&s_header) != PROFILES_HEADER)
+	{
+		eeprom_update_block(profiles, s_profiles, sizeof(profiles));
+		eeprom_update_byte(&s_header, PROFILES_HEADER);
+	}
+	else
+		eeprom_update_block(profile, &s_profiles[slot - 1], sizeof(Profile_t));
+	
+	stats.EepromWrites++;
+	
+	return PROFILES_OK;
+}
+
+uint8_t Profiles_Apply(uint8_t slot)
+{
+	if (!valid(slot))
+		return PROFILES_ERR_RANGE;
+	
+	Profile_t* profile = &profiles[slot - 1];
+	
+	if (settings.Color.R != profile->Color.R || settings.Color.G != profile->Color.G
+		|| settings.Color.B != profile->Color.B)
+	{
+		settings.Color = profile->Color;
+		Display_Update();
+	}
+	
+	settings.BlinkInterval = profile->BlinkInterval;
+	settings.BlinkTimeout = profile->BlinkTimeout;
+	
+	return PROFILES_OK;
+}
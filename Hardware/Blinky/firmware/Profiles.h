@@ -0,0 +1,32 @@
+#ifndef _PROFILES_H_
+#define _PROFILES_H_
+
+#include <stdint.h>
+#include <avr/eeprom.h>
+
+#include "Settings.h"
+#include "Display.h"
+#include "Stats.h"
+
+#define PROFILES_COUNT 8			// Number of profile slots
+#define PROFILES_NONE 0				// Slot number selecting no profile; slots start at 1
+#define PROFILES_HEADER 0x50		// 'P'
+
+#define PROFILES_OK 0
+#define PROFILES_ERR_RANGE 1		// Slot doesn't exist
+
+typedef struct __attribute__((__packed__))
+{
+	Color_t Color;			// 0x00 - 0x02	LED color
+	uint8_t BlinkInterval;	// 0x03			blink interval
+	uint8_t BlinkTimeout;	// 0x04			blinker timeout
+} Profile_t;
+
+// Copy of the profiles in the EEPROM, loaded at start.
+extern Profile_t profiles[PROFILES_COUNT];
+
+void Profiles_Load(void);
+uint8_t Profiles_Set(uint8_t slot, const Profile_t* profile);
+uint8_t Profiles_Apply(uint8_t slot);
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Schedule.h"
+
+/*
+ * Triggers at a time of the device clock. The host converts a common "fire
+ * at" time into the time of its device, so devices attached to different
+ * hosts start blinking at the same time regardless of the USB latency.
+ */
+
+static uint8_t scheduled;
+static uint32_t scheduledAt;
+static uint8_t scheduledSettings;
+static uint8_t scheduledProfile;
+
+static void fire(uint8_t blinkerSettings, uint8_t profile)
+{
+	if (profile != PROFILES_NONE)
+		Profiles_Apply(profile);
+	
+	Blinker_Enable(blinkerSettings);
+}
+
+uint8_t Schedule_Trigger(uint32_t at, uint8_t blinkerSettings, uint8_t profile)
+{
+	// The difference is signed, so the wrap around of the clock doesn't matter.
+	int32_t ahead = (int32_t)(at - Clock_Micros());
+	
+	if (ahead > (int32_t)SCHEDULE_MAX_AHEAD)
+		return SCHEDULE_ERR_RANGE;
+	
+	// A new schedule replaces the pending one.
+	scheduled = 0;
+	
+	if (ahead <= 0)
+	{
+		fire(blinkerSettings, profile);
+		return SCHEDULE_LATE;
+	}
+	
+	scheduledAt = at;
+	scheduledSettings = blinkerSettings;
+	scheduledProfile = profile;
+	scheduled = 1;
+	
+	return SCHEDULE_OK;
+}
+
+void Schedule_Task(void)
+{
+	// Called from the main loop; its period is the resolution of the schedule.
+	if (!scheduled || (int32_t)(Clock_Micros() - scheduledAt) < 0)
+		return;
+	
+	scheduled = 0;
+	fire(scheduledSettings, scheduledProfile);
+}
@@ -0,0 +1,21 @@
+#ifndef _SCHEDULE_H_
+#define _SCHEDULE_H_
+
+#include <stdint.h>
+
+#include "Clock.h"
+#include "Blinker.h"
+#include "Profiles.h"
+
+// A trigger can be scheduled up to 60 seconds ahead. The clock wraps around
+// after about 71 minutes, so times further ahead are ambiguous.
+#define SCHEDULE_MAX_AHEAD 60000000UL
+
+#define SCHEDULE_OK 0
+#define SCHEDULE_LATE 1				// Time has passed already, triggered at once
+#define SCHEDULE_ERR_RANGE 2		// Time is too far in the future
+
+uint8_t Schedule_Trigger(uint32_t at, uint8_t blinkerSettings, uint8_t profile);
+void Schedule_Task(void);
+
+#endif
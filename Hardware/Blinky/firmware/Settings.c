@@ -7,6 +7,10 @@
  */
 
 #include "Settings.h"
+#include "Stats.h"
+#include "Blinker.h"
+
+Settings_t settings;
 
 static Settings_t EEMEM s_settings = {0, SETTINGS_HEADER, SETTINGS_VERSION, {0, 0, 0}, 0, 0};
 
@@ -26,18 +30,21 @@ void Settings_Save(void)
 	settings.Header = SETTINGS_HEADER;
 	settings.Version = SETTINGS_VERSION;
 	eeprom_write_block(&settings, &s_settings, sizeof(Settings_t));
+	stats.EepromWrites++;
 }
 
 uint8_t Settings_State(void)
 {
-	uint8_t byte = eeprom_read_byte(0x01);
+	uint8_t byte = eeprom_read_byte(&s_settings.Header);
+	Color_t defaultColor = SETTINGS_DEFAULT_COLOR;
 	
 	if (byte != SETTINGS_HEADER)
 		return SETTINGS_STATE_Empty;
 	
-	if (settings.Color == (struct Color_t) SETTINGS_DEFAULT_COLOR
+	if (settings.Color.R == defaultColor.R && settings.Color.G == defaultColor.G
+		&& settings.Color.B == defaultColor.B
 		&& settings.BlinkInterval == SETTINGS_DEFAULT_INTERVAL
-		&& settings.BlinkTimeout == SETTINGS_DEFAULT_TIMEOUT)
+		&& (!FEATURE_TIMEOUT || settings.BlinkTimeout == SETTINGS_DEFAULT_TIMEOUT))
 		return SETTINGS_STATE_Defaults;
 	
 	return SETTINGS_STATE_NonDefaults;
@@ -45,7 +52,7 @@ uint8_t Settings_State(void)
 
 void Settings_Clear(void)
 {
-	settings.Color = (struct Color_t) SETTINGS_DEFAULT_COLOR;
+	settings.Color = (Color_t) SETTINGS_DEFAULT_COLOR;
 	settings.BlinkInterval = SETTINGS_DEFAULT_INTERVAL;
 	settings.BlinkTimeout = SETTINGS_DEFAULT_TIMEOUT;
 }
\ No newline at end of file
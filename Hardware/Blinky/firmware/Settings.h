@@ -35,7 +35,7 @@ enum SettingsState_t
 	SETTINGS_STATE_NonDefaults = 2		// EEPROM contains non-default settings
 };
 
-Settings_t settings;
+extern Settings_t settings;
 
 void Settings_Load(void);
 void Settings_Save(void);
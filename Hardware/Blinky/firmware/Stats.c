@@ -0,0 +1,62 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Stats.h"
+
+Stats_t stats;
+
+static uint32_t secondStart;
+static uint32_t loopCounter;
+
+void Stats_Task(void)
+{
+	// Called once per main loop iteration.
+	loopCounter++;
+	
+	// A second has 3906.25 clock ticks. Every fourth second is one tick longer,
+	// so the uptime doesn't drift.
+	uint16_t secondTicks = (stats.Uptime & 3) == 3 ? 3907 : 3906;
+	
+	if (Clock_Ticks() - secondStart >= secondTicks)
+	{
+		secondStart += secondTicks;
+		stats.Uptime++;
+		
+		stats.LoopsPerSecond = loopCounter;
+		loopCounter = 0;
+	}
+}
+
+uint32_t Stats_Get(uint8_t index)
+{
+	switch (index)
+	{
+		case STATS_Reports:
+			return stats.Reports;
+		case STATS_UnknownCommands:
+			return stats.UnknownCommands;
+		case STATS_UsbResets:
+			return stats.UsbResets;
+		case STATS_UsbSuspends:
+			return stats.UsbSuspends;
+		case STATS_MaxIsrTicks:
+			// Written by the blinker interrupt.
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+			{
+				return stats.MaxIsrTicks;
+			}
+		case STATS_LoopsPerSecond:
+			return stats.LoopsPerSecond;
+		case STATS_Uptime:
+			return stats.Uptime;
+		case STATS_EepromWrites:
+			return stats.EepromWrites;
+		default:
+			return 0;
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdint.h>
+#include <util/atomic.h>
+
+#include "Clock.h"
+
+#define STATS_Reports 0				// Reports received from the host
+#define STATS_UnknownCommands 1		// Reports with an unknown command
+#define STATS_UsbResets 2			// USB bus resets
+#define STATS_UsbSuspends 3			// USB suspends
+#define STATS_MaxIsrTicks 4			// Longest run of the blinker interrupt in Timer1 ticks
+#define STATS_LoopsPerSecond 5		// Main loop iterations in the last second
+#define STATS_Uptime 6				// Seconds since power on / reset
+#define STATS_EepromWrites 7		// EEPROM block writes since power on / reset
+#define STATS_Count 8
+
+typedef struct
+{
+	uint32_t Reports;
+	uint32_t UnknownCommands;
+	uint16_t UsbResets;
+	uint16_t UsbSuspends;
+	uint16_t MaxIsrTicks;
+	uint32_t LoopsPerSecond;
+	uint32_t Uptime;
+	uint16_t EepromWrites;
+} Stats_t;
+
+extern Stats_t stats;
+
+void Stats_Task(void);
+uint32_t Stats_Get(uint8_t index);
+
+#endif
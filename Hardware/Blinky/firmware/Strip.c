@@ -0,0 +1,126 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "Strip.h"
+
+#if STRIP_PIXELS
+
+// Pixels in the order of transmission: green, red, blue.
+static uint8_t frame[STRIP_PIXELS * 3];
+static const uint8_t dark[3];
+
+static uint8_t dirty;
+static uint8_t shown;
+static uint32_t lastFrame;
+
+void Strip_Setup(void)
+{
+	// The pin is an output already, see Blinker_Setup(). Turn off all pixels.
+	dirty = 1;
+}
+
+uint8_t Strip_Fill(uint8_t first, uint8_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t show)
+{
+	if (first >= STRIP_PIXELS || count > STRIP_PIXELS - first)
+		return STRIP_ERR_RANGE;
+	
+	for (uint8_t* pixel = &frame[first * 3]; count; count--)
+	{
+		*pixel++ = g;
+		*pixel++ = r;
+		*pixel++ = b;
+	}
+	
+	if (show)
+		dirty = 1;
+	
+	return STRIP_OK;
+}
+
+/*
+ * Sends the bytes of a pixel with the timing of the WS2812 at 16 MHz: a bit
+ * takes 20 cycles (1.25 us). The line is high for 6 cycles (375 ns) for a 0
+ * and for 13 cycles (812 ns) for a 1. The low time after the last bit of a
+ * byte is 4 cycles longer. Only the 3 bytes of the pixel are read. Interrupts
+ * must be disabled.
+ */
+static inline void sendPixel(const uint8_t* data, uint8_t high, uint8_t low)
+{
+	uint8_t count = 3;
+	uint8_t byte, bit;
+	
+	asm volatile(
+		"ld   %[byte], %a[data]+"		"\n\t"
+		"ldi  %[bit], 8"				"\n"
+		"1:"							"\n\t"
+		"out  %[port], %[high]"			"\n\t"	// 0: line high
+		"rjmp .+0"						"\n\t"	// 1
+		"rjmp .+0"						"\n\t"	// 3
+		"sbrs %[byte], 7"				"\n\t"	// 5: skip for a 1
+		"out  %[port], %[low]"			"\n\t"	// 6: line low for a 0
+		"lsl  %[byte]"					"\n\t"	// 7
+		"rjmp .+0"						"\n\t"	// 8
+		"rjmp .+0"						"\n\t"	// 10
+		"nop"							"\n\t"	// 12
+		"out  %[port], %[low]"			"\n\t"	// 13: line low for a 1
+		"dec  %[bit]"					"\n\t"	// 14
+		"breq 2f"						"\n\t"	// 15
+		"rjmp .+0"						"\n\t"	// 16
+		"rjmp 1b"						"\n"	// 18
+		"2:"							"\n\t"
+		"dec  %[count]"					"\n\t"	// 17
+		"breq 3f"						"\n\t"	// 18: last byte sent
+		"ld   %[byte], %a[data]+"		"\n\t"	// 19: next byte
+		"ldi  %[bit], 8"				"\n\t"	// 21
+		"rjmp 1b"						"\n"	// 22
+		"3:"							"\n"
+		: [byte] "=&r" (byte), [bit] "=&d" (bit), [data] "+e" (data), [count] "+r" (count)
+		: [port] "I" (_SFR_IO_ADDR(PORTB)), [high] "r" (high), [low] "r" (low)
+		: "memory"
+	);
+}
+
+static void send(uint8_t on)
+{
+	for (uint8_t a = 0; a < STRIP_PIXELS; a++)
+	{
+		// Interrupts are only disabled for a single pixel (about 31 us), so they
+		// are delayed at most that long. An interrupt in between only stretches
+		// the low time, the pixels latch after STRIP_LATCH_US.
+		uint8_t sreg = SREG;
+		cli();
+		
+		uint8_t low = PORTB & ~_BV(STRIP_PIN);
+		sendPixel(on ? &frame[a * 3] : dark, low | _BV(STRIP_PIN), low);
+		
+		SREG = sreg;
+	}
+}
+
+void Strip_Task(void)
+{
+	// The strip follows the display while blinking.
+	uint8_t on = BLINKER_STATR & BLINKER_STAT_DISPLAY;
+	
+	if (!dirty && on == shown)
+		return;
+	
+	// A frame right after the previous one would be appended to it.
+	uint32_t now = Clock_Micros();
+	
+	if (now - lastFrame < STRIP_LATCH_US)
+		return;
+	
+	send(on);
+	
+	dirty = 0;
+	shown = on;
+	lastFrame = Clock_Micros();
+}
+
+#endif
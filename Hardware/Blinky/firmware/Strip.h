@@ -0,0 +1,41 @@
+#ifndef _STRIP_H_
+#define _STRIP_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "Blinker.h"
+#include "Clock.h"
+
+/*
+ * Optional WS2812 LED strip on the AUX pin (PB6), instead of the plain AUX
+ * output. It shows its frame while the display is on, so it blinks along.
+ */
+
+#ifndef STRIP_PIXELS
+#define STRIP_PIXELS 0
+#endif
+
+// Each pixel takes 3 bytes of the 1 KiB SRAM.
+#define STRIP_MAX_PIXELS 150
+
+#if STRIP_PIXELS > STRIP_MAX_PIXELS
+#error STRIP_PIXELS is too large for the SRAM.
+#endif
+
+#define STRIP_PIN BLINKER_AUX
+// The pixels take over the data after the line is low this long (WS2812B: 280 us).
+#define STRIP_LATCH_US 300
+
+#define STRIP_OK 0
+#define STRIP_ERR_RANGE 1
+
+#if STRIP_PIXELS
+
+void Strip_Setup(void);
+uint8_t Strip_Fill(uint8_t first, uint8_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t show);
+void Strip_Task(void);
+
+#endif
+
+#endif
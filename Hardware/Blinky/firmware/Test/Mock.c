@@ -0,0 +1,153 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * The hardware for the unit tests: I/O registers, the EEPROM and the modules
+ * which need the real device (bootloader, flash, stack measurement and the
+ * timing of the LED strip).
+ */
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+
+#include "Mock.h"
+#include "../Bootloader.h"
+#include "../Flash.h"
+#include "../Memory.h"
+#include "../Strip.h"
+
+volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, TCNT0;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint8_t GPIOR0, GPIOR1, GPIOR2;
+volatile uint8_t PORTB, PINB, DDRB, PORTC, PINC, DDRC, PORTD, PIND, DDRD;
+volatile uint8_t SREG, MCUSR;
+volatile uint16_t TCNT1, ICR1, OCR1A, OCR1B, OCR1C;
+
+uint8_t mockBootloaderCalls;
+uint8_t mockStripFills;
+
+// Bounds of the EEMEM section, provided by the linker.
+extern uint8_t __start_eeprom[];
+extern uint8_t __stop_eeprom[];
+
+void Mock_Reset(void)
+{
+	TCCR0A = TCCR0B = TIMSK0 = TIFR0 = TCNT0 = 0;
+	TCCR1A = TCCR1B = TCCR1C = TIMSK1 = TIFR1 = 0;
+	GPIOR0 = GPIOR1 = GPIOR2 = 0;
+	PORTB = PINB = DDRB = PORTC = PINC = DDRC = PORTD = PIND = DDRD = 0;
+	SREG = MCUSR = 0;
+	TCNT1 = ICR1 = OCR1A = OCR1B = OCR1C = 0;
+
+	mockBootloaderCalls = 0;
+	mockStripFills = 0;
+}
+
+void Mock_EraseEeprom(void)
+{
+	memset(__start_eeprom, 0xFF, __stop_eeprom - __start_eeprom);
+}
+
+uint8_t eeprom_read_byte(const uint8_t* address)
+{
+	return *address;
+}
+
+void eeprom_write_byte(uint8_t* address, uint8_t value)
+{
+	*address = value;
+}
+
+void eeprom_update_byte(uint8_t* address, uint8_t value)
+{
+	*address = value;
+}
+
+void eeprom_read_block(void* destination, const void* source, size_t size)
+{
+	memcpy(destination, source, size);
+}
+
+void eeprom_write_block(const void* source, void* destination, size_t size)
+{
+	memcpy(destination, source, size);
+}
+
+void eeprom_update_block(const void* source, void* destination, size_t size)
+{
+	memcpy(destination, source, size);
+}
+
+void Bootloader_Execute(void)
+{
+	mockBootloaderCalls++;
+}
+
+// There is no bootloader providing the flash functions.
+uint8_t Flash_Available(void)
+{
+	return 0;
+}
+
+uint8_t Flash_StagingBase(void)
+{
+	return FLASH_NO_PAGE;
+}
+
+uint8_t Flash_MaxPages(void)
+{
+	return 0;
+}
+
+uint16_t Flash_PageCrc(uint8_t page)
+{
+	return 0;
+}
+
+uint8_t Flash_Begin(uint8_t page)
+{
+	return FLASH_ERR_UNSUPPORTED;
+}
+
+void Flash_Fill(const uint8_t* data)
+{
+}
+
+uint8_t Flash_Write(uint8_t page, uint16_t crc)
+{
+	return FLASH_ERR_UNSUPPORTED;
+}
+
+uint8_t Flash_Commit(uint8_t pageCount)
+{
+	return FLASH_ERR_UNSUPPORTED;
+}
+
+uint16_t Memory_StaticSize(void)
+{
+	return 0;
+}
+
+uint16_t Memory_StackSize(void)
+{
+	return RAMEND + 1 - RAMSTART;
+}
+
+uint16_t Memory_StackUnused(void)
+{
+	return 0;
+}
+
+#if STRIP_PIXELS
+uint8_t Strip_Fill(uint8_t first, uint8_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t show)
+{
+	mockStripFills++;
+
+	return first + count > STRIP_PIXELS ? STRIP_ERR_RANGE : STRIP_OK;
+}
+#endif
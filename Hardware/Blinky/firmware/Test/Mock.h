@@ -0,0 +1,21 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _MOCK_H_
+#define _MOCK_H_
+
+#include <stdint.h>
+
+// Calls of the modules which are replaced by the mock.
+extern uint8_t mockBootloaderCalls;
+extern uint8_t mockStripFills;
+
+void Mock_Reset(void);
+void Mock_EraseEeprom(void);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of the LUFA common header for the unit tests; only the
+ * attributes used by the headers of the firmware.
+ */
+
+#ifndef _MOCK_LUFA_COMMON_H_
+#define _MOCK_LUFA_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ATTR_INIT_SECTION(section)
+#define ATTR_NO_INIT
+
+#endif
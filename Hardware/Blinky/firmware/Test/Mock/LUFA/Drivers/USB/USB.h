@@ -0,0 +1,17 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of the LUFA USB driver header for the unit tests. The tested
+ * modules don't use USB; Bootloader.h includes it for Bootloader_Detach().
+ */
+
+#ifndef _MOCK_LUFA_USB_H_
+#define _MOCK_LUFA_USB_H_
+
+#include <LUFA/Common/Common.h>
+
+#endif
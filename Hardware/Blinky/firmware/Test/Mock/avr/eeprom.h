@@ -0,0 +1,28 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <avr/eeprom.h> for the unit tests. The EEMEM variables are
+ * placed into their own section, which stands in for the EEPROM: it starts with
+ * the initial values of the .eep file and can be erased by Mock_EraseEeprom().
+ */
+
+#ifndef _MOCK_AVR_EEPROM_H_
+#define _MOCK_AVR_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EEMEM __attribute__((section("eeprom")))
+
+uint8_t eeprom_read_byte(const uint8_t* address);
+void eeprom_write_byte(uint8_t* address, uint8_t value);
+void eeprom_update_byte(uint8_t* address, uint8_t value);
+void eeprom_read_block(void* destination, const void* source, size_t size);
+void eeprom_write_block(const void* source, void* destination, size_t size);
+void eeprom_update_block(const void* source, void* destination, size_t size);
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <avr/interrupt.h> for the unit tests. An interrupt handler
+ * becomes a function named like its vector, which the tests call directly.
+ */
+
+#ifndef _MOCK_AVR_INTERRUPT_H_
+#define _MOCK_AVR_INTERRUPT_H_
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+
+#define cli()
+#define sei()
+
+#endif
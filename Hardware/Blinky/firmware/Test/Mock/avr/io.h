@@ -0,0 +1,68 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <avr/io.h> for the unit tests. The I/O registers used by
+ * the firmware are plain variables, defined in Test/Mock.c, so the tests can
+ * set inputs like PINB and check the timer configuration afterwards.
+ */
+
+#ifndef _MOCK_AVR_IO_H_
+#define _MOCK_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+// 8 bit registers
+extern volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, TCNT0;
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint8_t GPIOR0, GPIOR1, GPIOR2;
+extern volatile uint8_t PORTB, PINB, DDRB, PORTC, PINC, DDRC, PORTD, PIND, DDRD;
+extern volatile uint8_t SREG, MCUSR;
+
+// 16 bit registers
+extern volatile uint16_t TCNT1, ICR1, OCR1A, OCR1B, OCR1C;
+
+// Timer0
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define TOIE0 0
+#define TOV0 0
+
+// Timer1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define COM1C1 3
+#define COM1C0 2
+#define TOIE1 0
+#define TOV1 0
+
+// Pins
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC5 5
+#define PC6 6
+
+// ATmega32U2
+#define RAMSTART 0x100
+#define RAMEND 0x4FF
+#define FLASHEND 0x7FFF
+#define E2END 0x3FF
+#define SPM_PAGESIZE 128
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <avr/wdt.h> for the unit tests.
+ */
+
+#ifndef _MOCK_AVR_WDT_H_
+#define _MOCK_AVR_WDT_H_
+
+#define WDTO_15MS 0
+#define WDTO_250MS 4
+
+#define wdt_enable(timeout)
+#define wdt_disable()
+#define wdt_reset()
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <util/atomic.h> for the unit tests; the tests don't run
+ * interrupts concurrently, so the block runs once without protection.
+ */
+
+#ifndef _MOCK_UTIL_ATOMIC_H_
+#define _MOCK_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#define ATOMIC_BLOCK(type) for (uint8_t _atomic_once = 1; _atomic_once; _atomic_once = 0)
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Host replacement of <util/crc16.h> for the unit tests.
+ */
+
+#ifndef _MOCK_UTIL_CRC16_H_
+#define _MOCK_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data);
+
+#endif
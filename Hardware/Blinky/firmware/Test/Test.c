@@ -0,0 +1,509 @@
+/*
+ * BISS.Blinky: A USB device for notifying the user of a new BISS message.
+ *
+ * Copyright (C) 2018 Michael Bemmerl
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Unit tests of the firmware, built for the host by "make test". The modules
+ * run unmodified against the mock AVR headers in Test/Mock; the I/O registers
+ * and the EEPROM are variables of Test/Mock.c. Interrupt handlers are called
+ * like functions, one call per interrupt.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Mock.h"
+#include "../Commands.h"
+#include "../Config/AppConfig.h"
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(expected, actual) checkEqual((expected), (actual), #actual, __FILE__, __LINE__)
+
+#define SYNC 0xA5					// Sync byte of the reports sent
+#define BLINKER_RUNNING (_BV(CS02) | _BV(CS00))
+#define DISPLAY_OUTPUTS (_BV(COM1A1) | _BV(COM1B1) | _BV(COM1C1))
+
+void TIMER0_OVF_vect(void);
+
+static unsigned checks;
+static unsigned failures;
+
+static void check(int condition, const char* expression, const char* file, int line)
+{
+	checks++;
+
+	if (!condition)
+	{
+		failures++;
+		printf("%s:%d: check failed: %s\n", file, line, expression);
+	}
+}
+
+static void checkEqual(long expected, long actual, const char* expression, const char* file, int line)
+{
+	checks++;
+
+	if (expected != actual)
+	{
+		failures++;
+		printf("%s:%d: %s is %ld, expected %ld\n", file, line, expression, actual, expected);
+	}
+}
+
+// Starts every test with an erased EEPROM and the device set up like by main().
+static void setUp(void)
+{
+	Mock_Reset();
+	Mock_EraseEeprom();
+	memset(&stats, 0, sizeof(stats));
+
+	Settings_Load();
+	Profiles_Load();
+	Display_Setup();
+	Blinker_Setup();
+	Blinker_Disable();
+}
+
+// Handles a report with the command and its arguments; the rest is zero.
+static uint8_t command(uint8_t* toHost, uint8_t cmdId, uint8_t arg1, uint8_t arg2, uint8_t arg3, uint8_t arg4, uint8_t arg5)
+{
+	uint8_t fromHost[GENERIC_REPORT_SIZE] = { cmdId, arg1, arg2, arg3, arg4, arg5, 0, SYNC };
+
+	memset(toHost, 0xEE, GENERIC_REPORT_SIZE);
+
+	return Command_Handle(fromHost, toHost);
+}
+
+static void overflows(uint16_t count)
+{
+	while (count--)
+		TIMER0_OVF_vect();
+}
+
+static uint8_t blinkerRunning(void)
+{
+	return (TCCR0B & BLINKER_RUNNING) == BLINKER_RUNNING;
+}
+
+static uint8_t displayOn(void)
+{
+	return (BLINKER_STATR & BLINKER_STAT_DISPLAY) != 0;
+}
+
+static void Test_SettingsLoadErased(void)
+{
+	CHECK_EQUAL(10, settings.Color.R);
+	CHECK_EQUAL(10, settings.Color.G);
+	CHECK_EQUAL(10, settings.Color.B);
+	CHECK_EQUAL(SETTINGS_DEFAULT_INTERVAL, settings.BlinkInterval);
+	CHECK_EQUAL(SETTINGS_DEFAULT_TIMEOUT, settings.BlinkTimeout);
+	CHECK_EQUAL(SETTINGS_STATE_Empty, Settings_State());
+}
+
+static void Test_SettingsSaveLoad(void)
+{
+	settings.Color = (Color_t) { 1, 2, 3 };
+	settings.BlinkInterval = 4;
+	settings.BlinkTimeout = 5;
+	Settings_Save();
+
+	CHECK_EQUAL(1, stats.EepromWrites);
+	CHECK_EQUAL(SETTINGS_STATE_NonDefaults, Settings_State());
+
+	memset(&settings, 0, sizeof(settings));
+	Settings_Load();
+
+	CHECK_EQUAL(SETTINGS_HEADER, settings.Header);
+	CHECK_EQUAL(SETTINGS_VERSION, settings.Version);
+	CHECK_EQUAL(1, settings.Color.R);
+	CHECK_EQUAL(2, settings.Color.G);
+	CHECK_EQUAL(3, settings.Color.B);
+	CHECK_EQUAL(4, settings.BlinkInterval);
+	CHECK_EQUAL(5, settings.BlinkTimeout);
+}
+
+static void Test_SettingsClearKeepsEeprom(void)
+{
+	settings.Color = (Color_t) { 1, 2, 3 };
+	Settings_Save();
+	Settings_Clear();
+
+	CHECK_EQUAL(10, settings.Color.R);
+	CHECK_EQUAL(SETTINGS_DEFAULT_INTERVAL, settings.BlinkInterval);
+	CHECK_EQUAL(1, stats.EepromWrites);
+
+	// Only the RAM is cleared, the saved settings are loaded again.
+	Settings_Load();
+
+	CHECK_EQUAL(1, settings.Color.R);
+
+	// Saving the defaults makes them the saved state.
+	Settings_Clear();
+	Settings_Save();
+
+	CHECK_EQUAL(SETTINGS_STATE_Defaults, Settings_State());
+}
+
+static void Test_DisplayUpdateOff(void)
+{
+	settings.Color = (Color_t) { 0, 0, 0 };
+	Display_Update();
+
+	CHECK_EQUAL(0, displayCompare[0]);
+	CHECK_EQUAL(0, displayCompare[1]);
+	CHECK_EQUAL(0, displayCompare[2]);
+	CHECK_EQUAL(0, TCCR1A & DISPLAY_OUTPUTS);
+	CHECK(DISPLAY_STATR & DISPLAY_STAT_LATCH);
+}
+
+static void Test_DisplayUpdateColors(void)
+{
+	settings.Color = (Color_t) { 255, 0, 0 };
+	Display_Update();
+
+	CHECK_EQUAL(DISPLAY_PWM_TOP, displayCompare[0]);
+	CHECK_EQUAL(0, displayCompare[1]);
+	CHECK_EQUAL(0, displayCompare[2]);
+	CHECK_EQUAL(_BV(COM1A1), TCCR1A & DISPLAY_OUTPUTS);
+	// The waveform generation mode is kept.
+	CHECK(TCCR1A & _BV(WGM11));
+
+	// Dark colors still get a duty cycle; the gamma curve is increasing.
+	settings.Color = (Color_t) { 1, 128, 254 };
+	Display_Update();
+
+	CHECK_EQUAL(1, displayCompare[0]);
+	CHECK(displayCompare[1] > displayCompare[0]);
+	CHECK(displayCompare[2] > displayCompare[1]);
+	CHECK(displayCompare[2] < DISPLAY_PWM_TOP);
+	CHECK_EQUAL(DISPLAY_OUTPUTS, TCCR1A & DISPLAY_OUTPUTS);
+
+	// The compare values are latched by the clock interrupt.
+	DISPLAY_STATR &= ~DISPLAY_STAT_LATCH;
+	Display_Update();
+
+	CHECK(DISPLAY_STATR & DISPLAY_STAT_LATCH);
+
+	Display_Disable();
+	CHECK_EQUAL(0, TCCR1A & DISPLAY_OUTPUTS);
+	Display_Enable();
+	CHECK_EQUAL(DISPLAY_OUTPUTS, TCCR1A & DISPLAY_OUTPUTS);
+}
+
+static void Test_CommandPing(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	CHECK_EQUAL(0, command(toHost, CMD_Ping, 0, 0, 0, 0, 0));
+	CHECK_EQUAL(CMD_Ping, toHost[0]);
+	CHECK_EQUAL('P', toHost[1]);
+	CHECK_EQUAL('o', toHost[2]);
+	CHECK_EQUAL('n', toHost[3]);
+	CHECK_EQUAL('g', toHost[4]);
+	CHECK_EQUAL(0, toHost[5]);
+	CHECK_EQUAL(0, toHost[6]);
+	CHECK_EQUAL(SYNC, toHost[7]);
+}
+
+static void Test_CommandUnknown(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	CHECK_EQUAL(1, command(toHost, 0xC8, 1, 2, 3, 4, 5));
+	CHECK_EQUAL(0, toHost[0]);
+	CHECK_EQUAL(0xC8, toHost[1]);
+	CHECK_EQUAL(0, toHost[2]);
+	CHECK_EQUAL(SYNC, toHost[7]);
+	CHECK_EQUAL(1, stats.UnknownCommands);
+	CHECK_EQUAL(1, Stats_Get(STATS_UnknownCommands));
+}
+
+static void Test_CommandSettings(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	command(toHost, CMD_SetSettings, 255, 0, 128, 20, 30);
+
+	CHECK_EQUAL(DISPLAY_PWM_TOP, displayCompare[0]);
+	CHECK_EQUAL(0, displayCompare[1]);
+
+	command(toHost, CMD_GetSettings, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(CMD_GetSettings, toHost[0]);
+	CHECK_EQUAL(255, toHost[1]);
+	CHECK_EQUAL(0, toHost[2]);
+	CHECK_EQUAL(128, toHost[3]);
+	CHECK_EQUAL(20, toHost[4]);
+#if FEATURE_TIMEOUT
+	CHECK_EQUAL(30, toHost[5]);
+#endif
+	CHECK_EQUAL(SYNC, toHost[7]);
+
+	// Settings are only written to the EEPROM by SaveSettings.
+	CHECK_EQUAL(0, stats.EepromWrites);
+
+	command(toHost, CMD_SaveSettings, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(1, stats.EepromWrites);
+
+	command(toHost, CMD_ResetSettings, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(10, settings.Color.R);
+	CHECK_EQUAL(SETTINGS_DEFAULT_INTERVAL, settings.BlinkInterval);
+	CHECK_EQUAL(1, stats.EepromWrites);
+
+	Settings_Load();
+
+	CHECK_EQUAL(255, settings.Color.R);
+}
+
+static void Test_CommandTriggerTurnOff(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	CHECK_EQUAL(0, command(toHost, CMD_Trigger, BLINKER_ENABLE_TOUCH | BLINKER_ENABLE_TIMEOUT, PROFILES_NONE, 0, 0, 0));
+	CHECK_EQUAL(CMD_Trigger, toHost[0]);
+	CHECK_EQUAL(0, toHost[1]);
+	CHECK(blinkerRunning());
+	CHECK(TIMSK0 & _BV(TOIE0));
+	CHECK(displayOn());
+	CHECK_EQUAL(FEATURE_TOUCH, (BLINKER_STATR & BLINKER_STAT_TOUCH) != 0);
+	CHECK_EQUAL(FEATURE_TIMEOUT, (BLINKER_STATR & BLINKER_STAT_TIMEOUT) != 0);
+
+	command(toHost, CMD_TurnOff, 0, 0, 0, 0, 0);
+
+	CHECK(!blinkerRunning());
+	CHECK(!displayOn());
+	CHECK_EQUAL(0, BLINKER_STATR & (BLINKER_STAT_TOUCH | BLINKER_STAT_TIMEOUT));
+	CHECK_EQUAL(0, TCCR1A & DISPLAY_OUTPUTS);
+
+	// Saving the settings turns the blinker off, too.
+	command(toHost, CMD_Trigger, 0, PROFILES_NONE, 0, 0, 0);
+	command(toHost, CMD_SaveSettings, 0, 0, 0, 0, 0);
+
+	CHECK(!blinkerRunning());
+}
+
+static void Test_CommandTriggerProfile(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+	uint8_t fromHost[GENERIC_REPORT_SIZE] = { CMD_SetProfile, 2, 0, 255, 0, 7, 9, SYNC };
+
+	Command_Handle(fromHost, toHost);
+
+	CHECK_EQUAL(2, toHost[1]);
+	CHECK_EQUAL(PROFILES_OK, toHost[2]);
+
+	command(toHost, CMD_Trigger, 0, 2, 0, 0, 0);
+
+	CHECK_EQUAL(PROFILES_OK, toHost[1]);
+	CHECK_EQUAL(255, settings.Color.G);
+	CHECK_EQUAL(7, settings.BlinkInterval);
+	CHECK_EQUAL(_BV(COM1B1), TCCR1A & DISPLAY_OUTPUTS);
+	CHECK(blinkerRunning());
+
+	// An unknown profile is reported, but still triggers.
+	command(toHost, CMD_TurnOff, 0, 0, 0, 0, 0);
+	command(toHost, CMD_Trigger, 0, PROFILES_COUNT + 1, 0, 0, 0);
+
+	CHECK_EQUAL(PROFILES_ERR_RANGE, toHost[1]);
+	CHECK(blinkerRunning());
+}
+
+static void Test_CommandOthers(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	command(toHost, CMD_Bootloader, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(1, mockBootloaderCalls);
+
+	command(toHost, CMD_GetStats, STATS_Reports, 0, 0, 0, 0);
+
+	CHECK_EQUAL(STATS_Reports, toHost[1]);
+
+	stats.UsbResets = 0x1234;
+	command(toHost, CMD_GetStats, STATS_UsbResets, 0, 0, 0, 0);
+
+	CHECK_EQUAL(STATS_UsbResets, toHost[1]);
+	CHECK_EQUAL(0x34, toHost[2]);
+	CHECK_EQUAL(0x12, toHost[3]);
+
+	// Page 1 of the capabilities is the bitmap of the supported commands.
+	command(toHost, CMD_GetCapabilities, 1, 0, 0, 0, 0);
+
+	CHECK_EQUAL(1, toHost[1]);
+	CHECK_EQUAL(0xFE, toHost[2]);
+	CHECK(toHost[4] & _BV(CMD_GetCapabilities - 16));
+
+	command(toHost, CMD_FlashInfo, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(FLASH_ERR_UNSUPPORTED, toHost[1]);
+	CHECK_EQUAL(SPM_PAGESIZE, toHost[2]);
+}
+
+static void Test_CommandEcho(void)
+{
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	// Timer1 counts 16 per microsecond.
+	TCNT1 = 10 * 16;
+	commandArrival = Clock_Micros();
+	command(toHost, CMD_Echo, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(10, toHost[1]);
+	CHECK_EQUAL(0, toHost[2]);
+
+	// The time is taken when the answer is queued, not when it is ready.
+	TCNT1 = 60 * 16;
+	Command_Queued(toHost);
+
+	CHECK_EQUAL(50, toHost[5]);
+	CHECK_EQUAL(0, toHost[6]);
+	CHECK_EQUAL(SYNC, toHost[7]);
+
+	// Other answers are sent unchanged.
+	command(toHost, CMD_Ping, 0, 0, 0, 0, 0);
+	Command_Queued(toHost);
+
+	CHECK_EQUAL(0x67, toHost[4]);
+	CHECK_EQUAL(0, toHost[5]);
+}
+
+static void Test_CommandStripFill(void)
+{
+#if STRIP_PIXELS
+	uint8_t toHost[GENERIC_REPORT_SIZE];
+
+	// No pixels only return the number of pixels.
+	command(toHost, CMD_StripFill, 0, 0, 0, 0, 0);
+
+	CHECK_EQUAL(STRIP_OK, toHost[1]);
+	CHECK_EQUAL(STRIP_PIXELS, toHost[2]);
+	CHECK_EQUAL(0, mockStripFills);
+
+	command(toHost, CMD_StripFill, STRIP_PIXELS - 1, 2, 1, 2, 3);
+
+	CHECK_EQUAL(STRIP_ERR_RANGE, toHost[1]);
+	CHECK_EQUAL(1, mockStripFills);
+#endif
+}
+
+static void Test_Timer0Blink(void)
+{
+	settings.BlinkInterval = 3;
+	Blinker_Enable(0);
+
+	CHECK(displayOn());
+
+	overflows(2);
+	CHECK(displayOn());
+
+	overflows(1);
+	CHECK(!displayOn());
+	CHECK_EQUAL(0, TCCR1A & DISPLAY_OUTPUTS);
+	CHECK(blinkerRunning());
+
+	overflows(3);
+	CHECK(displayOn());
+	CHECK(TCCR1A & DISPLAY_OUTPUTS);
+}
+
+static void Test_Timer0Touch(void)
+{
+#if FEATURE_TOUCH
+	// The sensor is low-active; without the option a touch is ignored.
+	PINB = 0;
+	Blinker_Enable(0);
+	overflows(1);
+
+	CHECK(blinkerRunning());
+
+	PINB = _BV(BLINKER_TOUCH);
+	Blinker_Enable(BLINKER_ENABLE_TOUCH);
+	overflows(1);
+
+	CHECK(blinkerRunning());
+
+	PINB = 0;
+	overflows(1);
+
+	CHECK(!blinkerRunning());
+	CHECK(!displayOn());
+	CHECK_EQUAL(0, BLINKER_STATR & BLINKER_STAT_TOUCH);
+#endif
+}
+
+static void Test_Timer0Timeout(void)
+{
+#if FEATURE_TIMEOUT
+	// 61 overflows are a second; a timeout of zero stops after 45 seconds.
+	settings.BlinkTimeout = 0;
+	Blinker_Enable(BLINKER_ENABLE_TIMEOUT);
+	overflows(45 * 61 - 1);
+
+	CHECK(blinkerRunning());
+
+	overflows(1);
+
+	CHECK(!blinkerRunning());
+	CHECK(!displayOn());
+
+	// Each step of the timeout is a second more.
+	settings.BlinkTimeout = 10;
+	Blinker_Enable(BLINKER_ENABLE_TIMEOUT);
+	overflows(55 * 61 - 1);
+
+	CHECK(blinkerRunning());
+
+	overflows(1);
+
+	CHECK(!blinkerRunning());
+
+	// Without the option it blinks until turned off.
+	settings.BlinkTimeout = 0;
+	Blinker_Enable(0);
+	overflows(300 * 61);
+
+	CHECK(blinkerRunning());
+#endif
+}
+
+static void run(const char* name, void (*test)(void))
+{
+	unsigned before = failures;
+
+	setUp();
+	test();
+
+	if (failures != before)
+		printf("FAILED %s\n", name);
+}
+
+#define RUN(test) run(#test, test)
+
+int main(void)
+{
+	RUN(Test_SettingsLoadErased);
+	RUN(Test_SettingsSaveLoad);
+	RUN(Test_SettingsClearKeepsEeprom);
+	RUN(Test_DisplayUpdateOff);
+	RUN(Test_DisplayUpdateColors);
+	RUN(Test_CommandPing);
+	RUN(Test_CommandUnknown);
+	RUN(Test_CommandSettings);
+	RUN(Test_CommandTriggerTurnOff);
+	RUN(Test_CommandTriggerProfile);
+	RUN(Test_CommandOthers);
+	RUN(Test_CommandEcho);
+	RUN(Test_CommandStripFill);
+	RUN(Test_Timer0Blink);
+	RUN(Test_Timer0Touch);
+	RUN(Test_Timer0Timeout);
+
+	printf("%u checks, %u failed\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+# Breaks down the flash and RAM usage of the firmware by source file and symbol.
+# Input is the output of "avr-nm -S -l --size-sort" of the firmware ELF.
+#
+#   address size type name [file:line]
+#
+# Symbols in the data address space (0x800000 and above) use RAM. Initialized
+# variables (.data) use flash for their initial values, too.
+
+function hex(s,    a, result) {
+	result = 0
+	s = tolower(s)
+	for (a = 1; a <= length(s); a++)
+		result = result * 16 + index("0123456789abcdef", substr(s, a, 1)) - 1
+	return result
+}
+
+BEGIN {
+	limit = limit ? limit : 20
+}
+
+NF >= 4 {
+	address = hex($1)
+	size = hex($2)
+	type = $3
+	name = $4
+
+	file = "(no debug info)"
+	if (NF >= 5) {
+		file = $5
+		sub(/:[0-9]+$/, "", file)
+		sub(/.*\//, "", file)
+	}
+
+	ram = 0
+	flash = 0
+	if (address >= 8388608) {	# 0x800000
+		ram = size
+		if (type == "D" || type == "d")
+			flash = size
+	} else {
+		flash = size
+	}
+
+	fileFlash[file] += flash
+	fileRam[file] += ram
+	totalFlash += flash
+	totalRam += ram
+
+	symbols[++count] = sprintf("%7d %7d  %-32s %s", flash, ram, name, file)
+}
+
+END {
+	printf "%7s %7s  %s\n", "Flash", "RAM", "Source file"
+	cmd = "sort -rn"
+	for (f in fileFlash)
+		printf "%7d %7d  %s\n", fileFlash[f], fileRam[f], f | cmd
+	close(cmd)
+	printf "%7d %7d  %s\n\n", totalFlash, totalRam, "Total (without vector table and startup code)"
+
+	printf "%7s %7s  %-32s %s\n", "Flash", "RAM", "Largest symbols", "Source file"
+	# nm sorted by size ascending, so the largest symbols are at the end.
+	for (a = count; a > count - limit && a > 0; a--)
+		print symbols[a]
+}
@@ -0,0 +1,172 @@
+﻿using System;
+using System.Diagnostics;
+using System.Net;
+using System.Net.Sockets;
+using System.Threading;
+using BISS.Networking;
+
+namespace BISS.Benchmark
+{
+	/// <summary>
+	/// Floods the BISS port on the loopback interface with junk and valid datagrams and counts how
+	/// often the receiver is woken up.
+	/// </summary>
+	class FloodBenchmark
+	{
+		/// <summary>
+		/// Port used for the BISS protocol.
+		/// </summary>
+		const int port = 15000;
+
+		/// <summary>
+		/// Time waited for the receiver to drain its queue after flooding.
+		/// </summary>
+		const int drainMilliseconds = 500;
+
+		readonly Random random = new Random(1);
+
+		/// <summary>
+		/// Gets or sets the number of datagrams sent.
+		/// </summary>
+		public int Count
+		{ get; set; } = 100000;
+
+		/// <summary>
+		/// Gets or sets every how many datagrams a valid packet is sent.
+		/// </summary>
+		public int ValidInterval
+		{ get; set; } = 100;
+
+		/// <summary>
+		/// Runs the flood once with and once without the kernel filter and prints the results.
+		/// </summary>
+		/// <returns>FALSE if the filter is not supported on this system.</returns>
+		public bool Run()
+		{
+			Console.WriteLine("Flooding 127.0.0.1:{0} with {1} datagrams, every {2}. is valid", port, Count, ValidInterval);
+			Console.WriteLine("{0,-10} {1,10} {2,10} {3,10} {4,12}", "Filter", "Wake-ups", "Valid", "Invalid", "CPU [ms]");
+
+			print("none", flood(false, false, false));
+			Result filtered = flood(true, false, false);
+
+			if (filtered == null)
+			{
+				Console.WriteLine("The kernel filter is not supported on this system.");
+				return false;
+			}
+
+			print("kernel", filtered);
+			return true;
+		}
+
+		/// <summary>
+		/// Runs a flood of valid packets from a single source once with and once without the rate limit
+		/// of the receiver and prints the results.
+		/// </summary>
+		public void RunThrottle()
+		{
+			Console.WriteLine("Flooding 127.0.0.1:{0} with {1} valid packets", port, Count);
+			// The receiver still wakes up for throttled datagrams, but doesn't parse or dispatch them.
+			Console.WriteLine("{0,-10} {1,10} {2,10} {3,10} {4,12}", "Limit", "Dispatched", "Valid", "Invalid", "CPU [ms]");
+
+			print("none", flood(false, false, true));
+			print("default", flood(false, true, true));
+		}
+
+		private static void print(string name, Result result)
+		{
+			Console.WriteLine("{0,-10} {1,10} {2,10} {3,10} {4,12:F1}", name, result.Valid + result.Invalid,
+				result.Valid, result.Invalid, result.Cpu.TotalMilliseconds);
+		}
+
+		/// <summary>
+		/// Sends the datagrams to a receiver.
+		/// </summary>
+		/// <param name="filter">TRUE if the kernel filter is attached to the receive socket.</param>
+		/// <param name="limit">TRUE if the receiver limits the rate of the source.</param>
+		/// <param name="allValid">TRUE if only valid packets are sent.</param>
+		/// <returns>The counted packets or NULL if the filter could not be attached.</returns>
+		private Result flood(bool filter, bool limit, bool allValid)
+		{
+			Result result = new Result();
+			UdpClient client = new UdpClient();
+
+			client.Client.SetSocketOption(SocketOptionLevel.Socket, SocketOptionName.ReuseAddress, true);
+			// Large enough for the whole flood, so the kernel doesn't drop datagrams for a slow receiver.
+			client.Client.ReceiveBufferSize = 8 * 1024 * 1024;
+			client.Client.Bind(new IPEndPoint(IPAddress.Any, port));
+
+			UdpTransport transport = new UdpTransport(client);
+
+			if (filter && !transport.AttachFilter())
+			{
+				transport.Dispose();
+				return null;
+			}
+
+			using (Receiver receiver = new Receiver(transport))
+			using (UdpClient sender = new UdpClient())
+			{
+				if (!limit)
+					receiver.RateLimiter = null;
+
+				receiver.PacketReceived += (s, e) => Interlocked.Increment(ref result.Valid);
+				receiver.ErrorReceived += (s, e) => Interlocked.Increment(ref result.Invalid);
+				receiver.StartReceiving();
+
+				IPEndPoint target = new IPEndPoint(IPAddress.Loopback, port);
+				TimeSpan cpu = Process.GetCurrentProcess().TotalProcessorTime;
+
+				for (int a = 0; a < Count; a++)
+				{
+					byte[] datagram = allValid || a % ValidInterval == 0 ? validDatagram((ushort)a) : junkDatagram();
+					sender.Send(datagram, datagram.Length, target);
+				}
+
+				Thread.Sleep(drainMilliseconds);
+				result.Cpu = Process.GetCurrentProcess().TotalProcessorTime - cpu;
+			}
+
+			return result;
+		}
+
+		private static byte[] validDatagram(ushort identifier)
+		{
+			return new byte[] { 0x02, (byte)'B', (byte)'I', (byte)'S', (byte)'S', 0x01,
+				(byte)(identifier >> 8), (byte)identifier, (byte)MessageType.BakeryIsThere, 0x03 };
+		}
+
+		/// <summary>
+		/// Returns a datagram which is no valid packet. Half of them only differ in a single byte from a
+		/// valid packet, the rest has random content and length.
+		/// </summary>
+		private byte[] junkDatagram()
+		{
+			byte[] result;
+
+			if (this.random.Next(2) == 0)
+			{
+				result = validDatagram((ushort)this.random.Next(ushort.MaxValue));
+				int index = new int[] { 0, 1, 2, 3, 4, 5, 9 }[this.random.Next(7)];
+				result[index] ^= 0x40;
+			}
+			else
+			{
+				result = new byte[this.random.Next(1, 64)];
+				this.random.NextBytes(result);
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Counters of a single run.
+		/// </summary>
+		class Result
+		{
+			public long Valid;
+			public long Invalid;
+			public TimeSpan Cpu;
+		}
+	}
+}
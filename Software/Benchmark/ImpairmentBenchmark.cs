@@ -0,0 +1,362 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Net;
+using BISS.Networking;
+
+namespace BISS.Benchmark
+{
+	/// <summary>
+	/// Simulates messages sent like by the <see cref="RepetitiveSender"/> over an impaired network
+	/// and received by a <see cref="FilteredReceiver"/>, to choose the number of repetitions and the
+	/// delay between them.
+	/// </summary>
+	/// <remarks>
+	/// The network runs in simulated time, so a day of messages takes a few milliseconds. The arrived
+	/// datagrams are passed in the order of their arrival to a real <see cref="FilteredReceiver"/>,
+	/// which ages the identifiers by the simulated time, so identifiers it forgot or which are used
+	/// twice show up like in operation.
+	/// </remarks>
+	class ImpairmentBenchmark
+	{
+		/// <summary>
+		/// A datagram which arrived at the receiver.
+		/// </summary>
+		struct Arrival
+		{
+			public int Message;
+			public int Transmission;
+			public TimeSpan Time;
+			public int Sequence;
+		}
+
+		/// <summary>
+		/// Results of a number of repetitions.
+		/// </summary>
+		class Result
+		{
+			public int Delivered;
+			public int Lost;
+			public int Filtered;
+			public long Duplicates;
+			public long Wasted;
+			public double MeanFirst;
+			public double P95First;
+		}
+
+		/// <summary>
+		/// Gets or sets the number of messages sent.
+		/// </summary>
+		public int Count
+		{ get; set; } = 10000;
+
+		/// <summary>
+		/// Gets or sets the impairment of the network.
+		/// </summary>
+		public Impairment Impairment
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the maximum number of repetitions compared.
+		/// </summary>
+		public int Repetitions
+		{ get; set; } = 9;
+
+		/// <summary>
+		/// Gets or sets the delay between the repetitions in milliseconds.
+		/// </summary>
+		public int Delay
+		{ get; set; } = 1000;
+
+		/// <summary>
+		/// Gets or sets the time between two messages in milliseconds.
+		/// </summary>
+		public int Interval
+		{ get; set; } = 60000;
+
+		/// <summary>
+		/// Gets or sets the seed of the identifiers, the impairment has its own.
+		/// </summary>
+		public int Seed
+		{ get; set; } = 1;
+
+		/// <summary>
+		/// Simulates the messages once and prints the results for each number of repetitions up to
+		/// <see cref="Repetitions"/>. As the network doesn't depend on later transmissions, fewer
+		/// repetitions are simulated by ignoring the later ones.
+		/// </summary>
+		public void Run()
+		{
+			Impairment impairment = Impairment ?? new Impairment(Seed);
+			Random random = new Random(Seed);
+			ushort[] identifiers = new ushort[Count];
+
+			for (int a = 0; a < Count; a++)
+				identifiers[a] = (ushort)random.Next(ushort.MaxValue + 1);
+
+			List<Arrival> arrivals = transmit(impairment);
+
+			Console.WriteLine("Network: {0}", impairment);
+			Console.WriteLine("{0} messages every {1} ms, repeated every {2} ms", Count, Interval, Delay);
+			Console.WriteLine("{0} of {1} datagrams lost, {2} duplicated, {3} reordered", impairment.Dropped,
+				(long)Count * (Repetitions + 1), impairment.Duplicated, impairment.Reordered);
+			Console.WriteLine("{0,-11} {1,13} {2,9} {3,12} {4,11} {5,10} {6,11} {7,10}", "Repetitions", "Delivered [%]",
+				"Lost [%]", "Filtered [%]", "First [ms]", "p95 [ms]", "Wasted/msg", "Duplicates");
+
+			int sufficient = -1;
+
+			for (int repetitions = 0; repetitions <= Repetitions; repetitions++)
+			{
+				Result result = receive(arrivals, identifiers, repetitions);
+
+				Console.WriteLine("{0,-11} {1,13:F3} {2,9:F3} {3,12:F3} {4,11:F1} {5,10:F1} {6,11:F2} {7,10}", repetitions,
+					percent(result.Delivered), percent(result.Lost), percent(result.Filtered), result.MeanFirst,
+					result.P95First, (double)result.Wasted / Count, result.Duplicates);
+
+				if (sufficient < 0 && result.Delivered + result.Filtered == Count)
+					sufficient = repetitions;
+			}
+
+			if (sufficient >= 0)
+				Console.WriteLine("No message was lost by the network with {0} repetitions.", sufficient);
+
+			Console.WriteLine("Filtered messages were dropped because the receiver remembered their identifier from another message.");
+		}
+
+		private double percent(int value)
+		{
+			return 100.0 * value / Count;
+		}
+
+		/// <summary>
+		/// Sends all transmissions of all messages in the order of their time through the impairment.
+		/// </summary>
+		/// <returns>The arrived datagrams in the order of their arrival.</returns>
+		private List<Arrival> transmit(Impairment impairment)
+		{
+			int transmissions = Repetitions + 1;
+			List<Arrival> sent = new List<Arrival>(Count * transmissions);
+			List<Arrival> result = new List<Arrival>(Count * transmissions);
+			TimeSpan[] delays = new TimeSpan[Impairment.MaxCopies];
+
+			for (int message = 0; message < Count; message++)
+			{
+				for (int transmission = 0; transmission < transmissions; transmission++)
+				{
+					Arrival send = new Arrival();
+					send.Message = message;
+					send.Transmission = transmission;
+					send.Time = sendTime(message, transmission);
+					send.Sequence = sent.Count;
+					sent.Add(send);
+				}
+			}
+
+			sent.Sort(compare);
+
+			foreach (Arrival send in sent)
+			{
+				int copies = impairment.Apply(send.Time, delays);
+
+				for (int a = 0; a < copies; a++)
+				{
+					Arrival arrival = send;
+					arrival.Time += delays[a];
+					arrival.Sequence = result.Count;
+					result.Add(arrival);
+				}
+			}
+
+			result.Sort(compare);
+			return result;
+		}
+
+		private static int compare(Arrival x, Arrival y)
+		{
+			int result = x.Time.CompareTo(y.Time);
+
+			return result != 0 ? result : x.Sequence.CompareTo(y.Sequence);
+		}
+
+		private TimeSpan sendTime(int message, int transmission)
+		{
+			return TimeSpan.FromMilliseconds((double)message * Interval + (double)transmission * Delay);
+		}
+
+		/// <summary>
+		/// Passes the datagrams of the first transmissions to a new receiver and evaluates what it received.
+		/// </summary>
+		private Result receive(List<Arrival> arrivals, ushort[] identifiers, int repetitions)
+		{
+			List<Arrival> used = arrivals.FindAll(arrival => arrival.Transmission <= repetitions);
+			byte[][] datagrams = new byte[used.Count][];
+			int[] accepted = new int[Count];
+			int[] arrived = new int[Count];
+			TimeSpan[] first = new TimeSpan[Count];
+
+			for (int a = 0; a < used.Count; a++)
+			{
+				datagrams[a] = datagram(identifiers[used[a].Message]);
+				arrived[used[a].Message]++;
+			}
+
+			ReplayTransport transport = new ReplayTransport(datagrams);
+			TimeSpan span = TimeSpan.FromMilliseconds((double)Repetitions * Delay) + TimeSpan.FromSeconds(10);
+
+			using (SimulatedReceiver receiver = new SimulatedReceiver(transport, used))
+			{
+				receiver.RateLimiter = null;
+				// Remember the identifiers as long as the simulated sender repeats them.
+				if (span > receiver.IdentifierLifetime)
+					receiver.IdentifierLifetime = span;
+				// The transport completes synchronously, so the datagram received is the current one.
+				receiver.PacketReceived += (s, e) =>
+				{
+					Arrival arrival = used[transport.Current];
+
+					if (accepted[arrival.Message]++ == 0)
+						first[arrival.Message] = arrival.Time;
+				};
+				receiver.StartReceiving();
+			}
+
+			Result result = new Result();
+			List<double> latencies = new List<double>(Count);
+
+			for (int message = 0; message < Count; message++)
+			{
+				if (arrived[message] == 0)
+				{
+					result.Lost++;
+					continue;
+				}
+
+				if (accepted[message] == 0)
+				{
+					result.Filtered++;
+					continue;
+				}
+
+				result.Delivered++;
+				result.Duplicates += accepted[message] - 1;
+				latencies.Add((first[message] - sendTime(message, 0)).TotalMilliseconds);
+
+				for (int transmission = 1; transmission <= repetitions; transmission++)
+				{
+					if (sendTime(message, transmission) >= first[message])
+						result.Wasted++;
+				}
+			}
+
+			if (latencies.Count > 0)
+			{
+				latencies.Sort();
+				double sum = 0;
+
+				foreach (double latency in latencies)
+					sum += latency;
+
+				result.MeanFirst = sum / latencies.Count;
+				result.P95First = latencies[(int)Math.Ceiling(latencies.Count * 0.95) - 1];
+			}
+
+			return result;
+		}
+
+		private static byte[] datagram(ushort identifier)
+		{
+			return new byte[] { 0x02, (byte)'B', (byte)'I', (byte)'S', (byte)'S', 0x01,
+				(byte)(identifier >> 8), (byte)identifier, (byte)MessageType.BakeryIsThere, 0x03 };
+		}
+
+		/// <summary>
+		/// Receives the simulated datagrams, aging the identifiers by the simulated arrival time.
+		/// </summary>
+		class SimulatedReceiver : FilteredReceiver
+		{
+			readonly ReplayTransport transport;
+			readonly List<Arrival> arrivals;
+
+			public SimulatedReceiver(ReplayTransport transport, List<Arrival> arrivals)
+				: base(transport)
+			{
+				this.transport = transport;
+				this.arrivals = arrivals;
+			}
+
+			protected override long GetTimestamp()
+			{
+				return (long)(this.arrivals[this.transport.Current].Time.TotalSeconds * Stopwatch.Frequency);
+			}
+		}
+
+		/// <summary>
+		/// Provides the simulated datagrams. All receives complete synchronously until the datagrams
+		/// run out; the last receive never completes.
+		/// </summary>
+		class ReplayTransport : Transport
+		{
+			readonly byte[][] datagrams;
+			int next;
+
+			/// <summary>
+			/// Gets the index of the datagram received last.
+			/// </summary>
+			public int Current
+			{
+				get
+				{
+					return this.next - 1;
+				}
+			}
+
+			public ReplayTransport(byte[][] datagrams)
+			{
+				this.datagrams = datagrams;
+			}
+
+			public override IAsyncResult BeginReceive(AsyncCallback callback, object state)
+			{
+				return new ReplayResult(state, this.next < this.datagrams.Length);
+			}
+
+			public override byte[] EndReceive(IAsyncResult asyncResult, out IPEndPoint remoteEndPoint)
+			{
+				remoteEndPoint = null;
+
+				return this.datagrams[this.next++];
+			}
+		}
+
+		class ReplayResult : IAsyncResult
+		{
+			public object AsyncState
+			{ get; private set; }
+
+			public System.Threading.WaitHandle AsyncWaitHandle
+			{
+				get
+				{
+					throw new NotSupportedException();
+				}
+			}
+
+			public bool CompletedSynchronously
+			{ get; private set; }
+
+			public bool IsCompleted
+			{
+				get
+				{
+					return this.CompletedSynchronously;
+				}
+			}
+
+			public ReplayResult(object state, bool completed)
+			{
+				this.AsyncState = state;
+				this.CompletedSynchronously = completed;
+			}
+		}
+	}
+}
@@ -0,0 +1,111 @@
+﻿using System;
+using BISS.Networking;
+
+namespace BISS.Benchmark
+{
+	/// <summary>
+	/// Runs benchmarks of the BISS networking.
+	/// </summary>
+	/// <remarks>
+	/// Command line: Benchmark flood|throttle|auth|impair [-count datagrams] [-valid interval]
+	/// [-impair settings] [-repetitions count] [-delay ms] [-interval ms] [-seed number]
+	/// </remarks>
+	static class Program
+	{
+		/// <summary>
+		/// Der Haupteinstiegspunkt für die Anwendung.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			if (args.Length == 0 || (args[0] != "flood" && args[0] != "throttle" && args[0] != "auth" && args[0] != "impair") || args.Length % 2 != 1)
+				return usage();
+
+			FloodBenchmark flood = new FloodBenchmark();
+			AuthBenchmark auth = new AuthBenchmark();
+			ImpairmentBenchmark impairment = new ImpairmentBenchmark();
+			string settings = null;
+
+			for (int a = 1; a < args.Length; a += 2)
+			{
+				int value;
+
+				if (args[a] == "-impair")
+				{
+					settings = args[a + 1];
+					continue;
+				}
+
+				if (!int.TryParse(args[a + 1], out value) || value <= 0)
+					return usage();
+
+				if (args[a] == "-count")
+				{
+					flood.Count = value;
+					auth.Count = value;
+					impairment.Count = value;
+				}
+				else if (args[a] == "-valid")
+					flood.ValidInterval = value;
+				else if (args[a] == "-repetitions")
+					impairment.Repetitions = value;
+				else if (args[a] == "-delay")
+					impairment.Delay = value;
+				else if (args[a] == "-interval")
+					impairment.Interval = value;
+				else if (args[a] == "-seed")
+					impairment.Seed = value;
+				else
+					return usage();
+			}
+
+			if (args[0] == "impair")
+			{
+				try
+				{
+					if (settings != null)
+						impairment.Impairment = Impairment.Parse(settings, impairment.Seed);
+				}
+				catch (FormatException ex)
+				{
+					Console.Error.WriteLine("Invalid impairment: {0}", ex.Message);
+					return 1;
+				}
+
+				impairment.Run();
+				return 0;
+			}
+
+			if (args[0] == "auth")
+			{
+				auth.Run();
+				return 0;
+			}
+
+			if (args[0] == "throttle")
+			{
+				flood.RunThrottle();
+				return 0;
+			}
+
+			return flood.Run() ? 0 : 1;
+		}
+
+		static int usage()
+		{
+			Console.Error.WriteLine("Usage: Benchmark flood|throttle|auth|impair [-count datagrams] [-valid interval]");
+			Console.Error.WriteLine("                 [-impair settings] [-repetitions count] [-delay ms] [-interval ms] [-seed number]");
+			Console.Error.WriteLine("  flood     Floods the BISS port on the loopback interface once with and once");
+			Console.Error.WriteLine("            without the kernel filter and counts the wake-ups of the receiver");
+			Console.Error.WriteLine("            (Linux only).");
+			Console.Error.WriteLine("  throttle  Floods the BISS port with valid packets once with and once without");
+			Console.Error.WriteLine("            the rate limit of the receiver.");
+			Console.Error.WriteLine("  auth      Verifies forged authenticated packets on a single thread and");
+			Console.Error.WriteLine("            measures the rate and the allocated memory.");
+			Console.Error.WriteLine("  impair    Simulates -count messages every -interval ms, each sent with up to");
+			Console.Error.WriteLine("            -repetitions repetitions every -delay ms over a network impaired by");
+			Console.Error.WriteLine("            e.g. \"loss=5,burst=30000/2000,latency=2,jitter=1,dup=1,reorder=1\"");
+			Console.Error.WriteLine("            (percent and ms), and compares the repetitions.");
+			return 1;
+		}
+	}
+}
@@ -31,6 +31,7 @@
 			this.btnSend = new System.Windows.Forms.Button();
 			this.label1 = new System.Windows.Forms.Label();
 			this.cbMessageType = new System.Windows.Forms.ComboBox();
+			this.chkSynchronized = new System.Windows.Forms.CheckBox();
 			this.SuspendLayout();
 			// 
 			// btnSend
@@ -63,11 +64,22 @@
 			this.cbMessageType.Size = new System.Drawing.Size(114, 21);
 			this.cbMessageType.TabIndex = 2;
 			// 
+			// chkSynchronized
+			// 
+			this.chkSynchronized.AutoSize = true;
+			this.chkSynchronized.Location = new System.Drawing.Point(12, 61);
+			this.chkSynchronized.Name = "chkSynchronized";
+			this.chkSynchronized.Size = new System.Drawing.Size(178, 17);
+			this.chkSynchronized.TabIndex = 3;
+			this.chkSynchronized.Text = "Trigger all devices synchronized";
+			this.chkSynchronized.UseVisualStyleBackColor = true;
+			// 
 			// MainForm
 			// 
 			this.AutoScaleDimensions = new System.Drawing.SizeF(6F, 13F);
 			this.AutoScaleMode = System.Windows.Forms.AutoScaleMode.Font;
-			this.ClientSize = new System.Drawing.Size(242, 63);
+			this.ClientSize = new System.Drawing.Size(242, 88);
+			this.Controls.Add(this.chkSynchronized);
 			this.Controls.Add(this.cbMessageType);
 			this.Controls.Add(this.label1);
 			this.Controls.Add(this.btnSend);
@@ -84,6 +96,7 @@
 		private System.Windows.Forms.Button btnSend;
 		private System.Windows.Forms.Label label1;
 		private System.Windows.Forms.ComboBox cbMessageType;
+		private System.Windows.Forms.CheckBox chkSynchronized;
 	}
 }
 
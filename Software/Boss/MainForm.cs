@@ -9,6 +9,11 @@ namespace BISS.Boss
 {
 	public partial class MainForm : Form
 	{
+		/// <summary>
+		/// Delay of synchronized triggers; the packet has to reach all hosts meanwhile.
+		/// </summary>
+		static readonly TimeSpan fireDelay = TimeSpan.FromMilliseconds(250);
+
 		public MainForm()
 		{
 			InitializeComponent();
@@ -37,7 +42,7 @@ namespace BISS.Boss
 
 			MessageType message = (MessageType)Enum.Parse(typeof(MessageType), item);
 			InterfaceSender s = new InterfaceSender();
-			Packet packet = PacketBuilder.Instance.Build(message);
+			Packet packet = this.chkSynchronized.Checked ? PacketBuilder.Instance.Build(message, fireDelay) : PacketBuilder.Instance.Build(message);
 			s.Send(packet);
 
 			this.btnSend.Text = "Done!";
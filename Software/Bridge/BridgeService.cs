@@ -0,0 +1,357 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Drawing;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using BISS.Hardware.Blinky;
+using BISS.Networking;
+
+namespace BISS.Bridge
+{
+	/// <summary>
+	/// Triggers all attached Blinky devices when a BISS packet is received.
+	/// </summary>
+	/// <remarks>
+	/// The stored settings and the colors of the actions are written into the profile slots of the
+	/// devices, so a message selects its color with the Trigger command alone. Devices without enough
+	/// slots get the color with an additional report. The devices are triggered on the thread pool,
+	/// one after another per device, so the receiving isn't blocked by the USB reports.
+	/// </remarks>
+	public class BridgeService : IDisposable
+	{
+		/// <summary>
+		/// Interval for looking for newly attached devices.
+		/// </summary>
+		static readonly TimeSpan scanInterval = TimeSpan.FromSeconds(5);
+
+		/// <summary>
+		/// State of an attached device.
+		/// </summary>
+		class AttachedDevice
+		{
+			public Device Device;
+			public TriggerScheduler Scheduler;
+			public DeviceClock Clock;
+			public Settings StoredSettings;
+			public Settings CurrentSettings;
+			// Profile slot by color (ARGB), or NULL if the color is sent with the settings.
+			public Dictionary<int, int> Profiles;
+			// The last trigger queued for the device.
+			public Task Work;
+		}
+
+		readonly HubReceiver receiver;
+		readonly IDictionary<MessageType, MessageAction> actions;
+		readonly Dictionary<string, AttachedDevice> devices;
+		readonly TextWriter log;
+		readonly object lockObject;
+		Timer scanTimer;
+		bool disposed;
+
+		/// <summary>
+		/// Gets the latencies of the packets which triggered a device.
+		/// </summary>
+		public LatencyTracer Tracer
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of attached devices.
+		/// </summary>
+		public int DeviceCount
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.devices.Count;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the BridgeService class.
+		/// </summary>
+		/// <param name="actions">Actions by message type. Message types without an action use
+		/// <see cref="MessageAction.Default"/>.</param>
+		/// <param name="log">Writer for log messages.</param>
+		/// <param name="authenticator">Verifies the packets received directly, or NULL if unauthenticated
+		/// packets are accepted.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="actions"/> or <paramref name="log"/> was NULL.</exception>
+		public BridgeService(IDictionary<MessageType, MessageAction> actions, TextWriter log, PacketAuthenticator authenticator = null)
+		{
+			if (actions == null)
+				throw new ArgumentNullException("actions");
+			if (log == null)
+				throw new ArgumentNullException("log");
+
+			this.actions = actions;
+			this.log = log;
+			this.lockObject = new object();
+			this.devices = new Dictionary<string, AttachedDevice>();
+			this.Tracer = new LatencyTracer();
+			this.receiver = new HubReceiver();
+			this.receiver.Authenticator = authenticator;
+			this.receiver.PacketReceived += receiver_PacketReceived;
+			this.receiver.TransportChanged += receiver_TransportChanged;
+		}
+
+		/// <summary>
+		/// Connects to the attached devices and starts receiving packets.
+		/// </summary>
+		public void Start()
+		{
+			if (this.disposed)
+				throw new ObjectDisposedException(GetType().FullName);
+
+			scanDevices();
+			this.scanTimer = new Timer(state => scanDevices(), null, scanInterval, scanInterval);
+			this.receiver.StartReceiving();
+		}
+
+		/// <summary>
+		/// Connects to all devices which are not connected yet.
+		/// </summary>
+		private void scanDevices()
+		{
+			foreach (string path in Device.GetDevicePaths())
+			{
+				AttachedDevice known;
+
+				lock (this.lockObject)
+				{
+					if (this.disposed)
+						continue;
+
+					this.devices.TryGetValue(path, out known);
+				}
+
+				// Synchronizing again measures the drift of the device clock.
+				if (known != null)
+				{
+					resynchronize(known);
+					continue;
+				}
+
+				Device device = new Device();
+
+				if (!device.Connect(path))
+				{
+					device.Dispose();
+					continue;
+				}
+
+				// The color stored in the device is restored after messages with an own color.
+				Settings settings = device.Settings;
+
+				if (settings == null)
+				{
+					device.Dispose();
+					continue;
+				}
+
+				// Without a synchronized clock, scheduled packets trigger the device at once.
+				DeviceClock clock = new DeviceClock(device);
+				clock.Synchronize();
+
+				Dictionary<int, int> profiles = storeProfiles(device, settings);
+
+				device.Removed += device_Removed;
+
+				TriggerScheduler scheduler = new TriggerScheduler(device);
+				scheduler.TriggerSent += scheduler_TriggerSent;
+
+				lock (this.lockObject)
+				{
+					this.devices[path] = new AttachedDevice() { Device = device, Scheduler = scheduler, Clock = clock, StoredSettings = settings, CurrentSettings = settings,
+						Profiles = profiles, Work = Task.FromResult(true) };
+				}
+
+				this.log.WriteLine("Device attached: {0} ({1}), {2}", path, device.Capabilities, profiles != null ? profiles.Count + " profiles" : "no profiles");
+			}
+		}
+
+		/// <summary>
+		/// Stores the stored settings and the colors of all actions in the profile slots of a device,
+		/// starting at the first slot.
+		/// </summary>
+		/// <param name="device">The device.</param>
+		/// <param name="stored">The settings stored in the device.</param>
+		/// <returns>The profile slot by color (ARGB), or NULL if the device has too few slots.</returns>
+		private Dictionary<int, int> storeProfiles(Device device, Settings stored)
+		{
+			Dictionary<int, int> profiles = new Dictionary<int, int>();
+			IEnumerable<Color> colors = this.actions.Values.Where(a => a.Color.HasValue).Select(a => a.Color.Value);
+
+			foreach (Color color in new Color[] { stored.Color }.Concat(colors))
+			{
+				if (!profiles.ContainsKey(color.ToArgb()))
+					profiles.Add(color.ToArgb(), profiles.Count + 1);
+			}
+
+			if (profiles.Count > device.GetProfileCount())
+				return null;
+
+			foreach (KeyValuePair<int, int> profile in profiles)
+			{
+				if (!device.SetProfile(profile.Value, new Settings(Color.FromArgb(profile.Key), stored.BlinkInterval, stored.BlinkTimeout)))
+					return null;
+			}
+
+			return profiles;
+		}
+
+		private void resynchronize(AttachedDevice attached)
+		{
+			try
+			{
+				attached.Clock.Synchronize();
+			}
+			catch (InvalidOperationException)
+			{
+				// The device was removed and disposed meanwhile.
+			}
+		}
+
+		private void device_Removed(object sender, EventArgs e)
+		{
+			AttachedDevice attached;
+
+			lock (this.lockObject)
+			{
+				string path = this.devices.Where(d => d.Value.Device == sender).Select(d => d.Key).FirstOrDefault();
+
+				if (path == null)
+					return;
+
+				attached = this.devices[path];
+				this.devices.Remove(path);
+				this.log.WriteLine("Device removed: {0}", path);
+			}
+
+			attached.Scheduler.Dispose();
+			attached.Device.Dispose();
+		}
+
+		private void receiver_TransportChanged(object sender, EventArgs e)
+		{
+			this.log.WriteLine(this.receiver.ReceivingFromHub ? "Receiving from the hub" : "Receiving directly");
+		}
+
+		private void receiver_PacketReceived(object sender, PacketReceivedEventArgs e)
+		{
+			MessageType messageType = e.ReceivedPacket.MessageType;
+			MessageAction action;
+			AttachedDevice[] attached;
+
+			if (messageType == MessageType.None)
+				return;
+
+			if (!this.actions.TryGetValue(messageType, out action))
+				action = MessageAction.Default;
+
+			// Each device has its own USB endpoint, so they are triggered in parallel. The triggers of
+			// a device stay in the order of the packets.
+			lock (this.lockObject)
+			{
+				attached = this.devices.Values.ToArray();
+
+				foreach (AttachedDevice device in attached)
+					device.Work = device.Work.ContinueWith(task => trigger(device, action, e), TaskScheduler.Default);
+			}
+
+			this.log.WriteLine("{0} received ({1}), {2} devices triggered", messageType, action, attached.Length);
+		}
+
+		/// <summary>
+		/// Triggers a device with the color of the action, selected by its profile slot or set before.
+		/// </summary>
+		/// <param name="attached">The device.</param>
+		/// <param name="action">The action to be done.</param>
+		/// <param name="e">The event data of the received packet.</param>
+		private void trigger(AttachedDevice attached, MessageAction action, PacketReceivedEventArgs e)
+		{
+			Settings settings = attached.StoredSettings;
+			int profile = 0;
+
+			if (action.Color.HasValue)
+				settings = new Settings(action.Color.Value, settings.BlinkInterval, settings.BlinkTimeout);
+
+			try
+			{
+				// Only send the color if it differs; every report adds latency.
+				if (attached.Profiles != null)
+					profile = attached.Profiles[settings.Color.ToArgb()];
+				else if (settings.Color.ToArgb() != attached.CurrentSettings.Color.ToArgb())
+				{
+					attached.Device.Settings = settings;
+					attached.CurrentSettings = settings;
+				}
+
+				// Repeated messages are coalesced, so the blink algorithm isn't restarted. Scheduled
+				// packets trigger all devices at the same time, if the clocks of the hosts are synchronized.
+				// The packet is traced when the Trigger command is sent, which may be deferred.
+				DateTime? fireAt = e.ReceivedPacket.FireAt;
+
+				if (fireAt.HasValue && attached.Clock.Synchronized)
+					attached.Scheduler.TriggerAt(attached.Clock.ToDeviceTime(fireAt.Value), action.Options, profile, e);
+				else
+					attached.Scheduler.Trigger(action.Options, profile, e);
+			}
+			catch (InvalidOperationException)
+			{
+				// The device was removed and disposed meanwhile.
+			}
+		}
+
+		private void scheduler_TriggerSent(object sender, TriggerSentEventArgs e)
+		{
+			PacketReceivedEventArgs received = e.State as PacketReceivedEventArgs;
+
+			if (received != null)
+				this.Tracer.Record(received, e.SentTimestamp);
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			if (!disposed)
+			{
+				if (disposing)
+				{
+					if (this.scanTimer != null)
+						this.scanTimer.Dispose();
+
+					this.receiver.Dispose();
+
+					lock (this.lockObject)
+					{
+						foreach (AttachedDevice attached in this.devices.Values)
+						{
+							attached.Scheduler.Dispose();
+							attached.Device.Dispose();
+						}
+
+						this.devices.Clear();
+					}
+				}
+
+				disposed = true;
+			}
+		}
+
+		/// <summary>
+		/// Releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
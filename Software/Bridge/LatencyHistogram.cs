@@ -0,0 +1,143 @@
+﻿using System;
+
+namespace BISS.Bridge
+{
+	/// <summary>
+	/// Counts latency samples in buckets of fixed width. Samples above the last bucket are counted
+	/// in an overflow bucket.
+	/// </summary>
+	/// <remarks>This class is not thread-safe.</remarks>
+	public class LatencyHistogram
+	{
+		/// <summary>
+		/// Width of a bucket.
+		/// </summary>
+		public static readonly TimeSpan BucketWidth = TimeSpan.FromTicks(TimeSpan.TicksPerMillisecond / 10);
+
+		/// <summary>
+		/// Number of buckets, without the overflow bucket. Covers 50 ms.
+		/// </summary>
+		public const int BucketCount = 500;
+
+		readonly long[] buckets;
+		TimeSpan sum;
+
+		/// <summary>
+		/// Gets the number of samples.
+		/// </summary>
+		public long Count
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the largest sample.
+		/// </summary>
+		public TimeSpan Maximum
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the arithmetic mean of the samples.
+		/// </summary>
+		public TimeSpan Mean
+		{
+			get
+			{
+				return Count == 0 ? TimeSpan.Zero : TimeSpan.FromTicks(this.sum.Ticks / Count);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of samples which exceeded the last bucket.
+		/// </summary>
+		public long Overflows
+		{
+			get
+			{
+				return this.buckets[BucketCount];
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the LatencyHistogram class.
+		/// </summary>
+		public LatencyHistogram()
+		{
+			this.buckets = new long[BucketCount + 1];
+		}
+
+		/// <summary>
+		/// Adds a sample to the histogram.
+		/// </summary>
+		/// <param name="sample">The latency.</param>
+		public void Add(TimeSpan sample)
+		{
+			long bucket = Math.Max(sample.Ticks, 0) / BucketWidth.Ticks;
+
+			this.buckets[Math.Min(bucket, BucketCount)]++;
+			this.sum += sample;
+			Count++;
+
+			if (sample > Maximum)
+				Maximum = sample;
+		}
+
+		/// <summary>
+		/// Returns the number of samples in a bucket.
+		/// </summary>
+		/// <param name="bucket">Index of the bucket; <see cref="BucketCount"/> is the overflow bucket.</param>
+		/// <returns>The number of samples.</returns>
+		public long GetCount(int bucket)
+		{
+			return this.buckets[bucket];
+		}
+
+		/// <summary>
+		/// Returns the upper bound of a bucket.
+		/// </summary>
+		/// <param name="bucket">Index of the bucket.</param>
+		/// <returns>The upper bound (exclusive).</returns>
+		public static TimeSpan GetUpperBound(int bucket)
+		{
+			return TimeSpan.FromTicks((bucket + 1) * BucketWidth.Ticks);
+		}
+
+		/// <summary>
+		/// Returns the upper bound of the bucket below which the specified percentage of the samples
+		/// falls (nearest-rank method).
+		/// </summary>
+		/// <param name="percent">Percentage between 0 and 100.</param>
+		/// <returns>The percentile or <see cref="TimeSpan.Zero"/> if there are no samples. The maximum
+		/// is returned if the percentile is in the overflow bucket.</returns>
+		public TimeSpan Percentile(double percent)
+		{
+			if (percent < 0 || percent > 100)
+				throw new ArgumentOutOfRangeException("percent");
+
+			if (Count == 0)
+				return TimeSpan.Zero;
+
+			long rank = Math.Max((long)Math.Ceiling(percent / 100 * Count), 1);
+			long cumulated = 0;
+
+			for (int bucket = 0; bucket < BucketCount; bucket++)
+			{
+				cumulated += this.buckets[bucket];
+
+				if (cumulated >= rank)
+					return TimeSpan.FromTicks(Math.Min(GetUpperBound(bucket).Ticks, Maximum.Ticks));
+			}
+
+			return Maximum;
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current instance.
+		/// </summary>
+		/// <returns>Number of samples, mean, median, 99th percentile and maximum in milliseconds.</returns>
+		public override string ToString()
+		{
+			return String.Format("n {0} / mean {1:0.00} / median {2:0.00} / p99 {3:0.00} / max {4:0.00} ms",
+				Count, Mean.TotalMilliseconds, Percentile(50).TotalMilliseconds, Percentile(99).TotalMilliseconds,
+				Maximum.TotalMilliseconds);
+		}
+	}
+}
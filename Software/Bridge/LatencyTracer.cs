@@ -0,0 +1,153 @@
+﻿using System;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using BISS.Networking;
+
+namespace BISS.Bridge
+{
+	/// <summary>
+	/// Records the latency of each stage from receiving a datagram until the Blinky devices are
+	/// triggered.
+	/// </summary>
+	/// <remarks>This class is thread-safe.</remarks>
+	public class LatencyTracer
+	{
+		readonly object lockObject;
+
+		/// <summary>
+		/// Gets the latency from receiving the datagram until it was parsed.
+		/// </summary>
+		public LatencyHistogram Parse
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the latency from parsing the datagram until duplicates were filtered.
+		/// </summary>
+		public LatencyHistogram Deduplicate
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the latency from filtering duplicates until the HID report to a device was written.
+		/// </summary>
+		public LatencyHistogram Trigger
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the latency from receiving the datagram until the HID report to a device was written.
+		/// </summary>
+		public LatencyHistogram Total
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the LatencyTracer class.
+		/// </summary>
+		public LatencyTracer()
+		{
+			this.lockObject = new object();
+			this.Parse = new LatencyHistogram();
+			this.Deduplicate = new LatencyHistogram();
+			this.Trigger = new LatencyHistogram();
+			this.Total = new LatencyHistogram();
+		}
+
+		/// <summary>
+		/// Converts the difference of two <see cref="Stopwatch"/> timestamps into a <see cref="TimeSpan"/>.
+		/// </summary>
+		/// <param name="from">The earlier timestamp.</param>
+		/// <param name="to">The later timestamp.</param>
+		/// <returns>The time between both timestamps.</returns>
+		private static TimeSpan elapsed(long from, long to)
+		{
+			return TimeSpan.FromTicks((to - from) * TimeSpan.TicksPerSecond / Stopwatch.Frequency);
+		}
+
+		/// <summary>
+		/// Records the stages of a packet which triggered a device.
+		/// </summary>
+		/// <param name="e">The event data of the received packet.</param>
+		/// <param name="triggeredTimestamp"><see cref="Stopwatch"/> timestamp when the HID report was written.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="e"/> was NULL.</exception>
+		public void Record(PacketReceivedEventArgs e, long triggeredTimestamp)
+		{
+			if (e == null)
+				throw new ArgumentNullException("e");
+
+			lock (this.lockObject)
+			{
+				this.Parse.Add(elapsed(e.ReceivedTimestamp, e.ParsedTimestamp));
+				this.Deduplicate.Add(elapsed(e.ParsedTimestamp, e.AcceptedTimestamp));
+				this.Trigger.Add(elapsed(e.AcceptedTimestamp, triggeredTimestamp));
+				this.Total.Add(elapsed(e.ReceivedTimestamp, triggeredTimestamp));
+			}
+		}
+
+		/// <summary>
+		/// Writes the histograms of all stages as CSV. Each line contains the upper bound of a bucket in
+		/// milliseconds, followed by the number of samples of each stage in that bucket.
+		/// </summary>
+		/// <param name="writer">The writer.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="writer"/> was NULL.</exception>
+		public void Export(TextWriter writer)
+		{
+			if (writer == null)
+				throw new ArgumentNullException("writer");
+
+			lock (this.lockObject)
+			{
+				LatencyHistogram[] stages = new LatencyHistogram[] { Parse, Deduplicate, Trigger, Total };
+				int last = 0;
+
+				// Omit the empty buckets at the end.
+				for (int bucket = 0; bucket < LatencyHistogram.BucketCount; bucket++)
+				{
+					foreach (LatencyHistogram stage in stages)
+					{
+						if (stage.GetCount(bucket) > 0)
+							last = bucket;
+					}
+				}
+
+				writer.WriteLine("UpperBoundMs,Parse,Deduplicate,Trigger,Total");
+
+				for (int bucket = 0; bucket <= last; bucket++)
+				{
+					writer.Write(LatencyHistogram.GetUpperBound(bucket).TotalMilliseconds.ToString("0.0", CultureInfo.InvariantCulture));
+					foreach (LatencyHistogram stage in stages)
+						writer.Write("," + stage.GetCount(bucket));
+					writer.WriteLine();
+				}
+
+				writer.Write("Overflow");
+				foreach (LatencyHistogram stage in stages)
+					writer.Write("," + stage.Overflows);
+				writer.WriteLine();
+			}
+		}
+
+		/// <summary>
+		/// Writes the histograms of all stages into a CSV file.
+		/// </summary>
+		/// <param name="path">Path of the file. An existing file is overwritten.</param>
+		public void Export(string path)
+		{
+			using (StreamWriter writer = new StreamWriter(path))
+			{
+				Export(writer);
+			}
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current instance.
+		/// </summary>
+		/// <returns>A summary of each stage, one per line.</returns>
+		public override string ToString()
+		{
+			lock (this.lockObject)
+			{
+				return String.Format("Parse:       {0}{4}Deduplicate: {1}{4}Trigger:     {2}{4}Total:       {3}",
+					Parse, Deduplicate, Trigger, Total, Environment.NewLine);
+			}
+		}
+	}
+}
@@ -0,0 +1,135 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Collections.Specialized;
+using System.Drawing;
+using System.Globalization;
+using BISS.Hardware.Blinky;
+using BISS.Networking;
+
+namespace BISS.Bridge
+{
+	/// <summary>
+	/// Represents what the Blinky devices do when a message of a certain type is received.
+	/// </summary>
+	public class MessageAction
+	{
+		/// <summary>
+		/// Gets the color of the LED or NULL if the color stored in the device is used.
+		/// </summary>
+		public Color? Color
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the options of the Trigger command.
+		/// </summary>
+		public TriggerOptions Options
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the action for message types without a configured action.
+		/// </summary>
+		public static MessageAction Default
+		{
+			get
+			{
+				return new MessageAction(null, Device.DefaultTriggerOptions);
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the MessageAction class.
+		/// </summary>
+		/// <param name="color">Color of the LED or NULL if the color stored in the device is used.</param>
+		/// <param name="options">Options of the Trigger command.</param>
+		public MessageAction(Color? color, TriggerOptions options)
+		{
+			this.Color = color;
+			this.Options = options;
+		}
+
+		/// <summary>
+		/// Converts an action in the format "color=RRGGBB; options=TouchSensor, Timeout" into an instance
+		/// of <see cref="MessageAction"/>. Both parts are optional.
+		/// </summary>
+		/// <param name="value">The action as string.</param>
+		/// <returns>Instance of <see cref="MessageAction"/>.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="value"/> was NULL.</exception>
+		/// <exception cref="FormatException">The action could not be converted.</exception>
+		public static MessageAction Parse(string value)
+		{
+			if (value == null)
+				throw new ArgumentNullException("value");
+
+			Color? color = null;
+			TriggerOptions options = Device.DefaultTriggerOptions;
+
+			foreach (string part in value.Split(new char[] { ';' }, StringSplitOptions.RemoveEmptyEntries))
+			{
+				string[] pair = part.Split('=');
+
+				if (pair.Length != 2)
+					throw new FormatException("Invalid action: " + part);
+
+				string key = pair[0].Trim().ToLowerInvariant();
+				string setting = pair[1].Trim();
+
+				try
+				{
+					if (key == "color")
+						color = System.Drawing.Color.FromArgb(int.Parse(setting, NumberStyles.HexNumber, CultureInfo.InvariantCulture) | unchecked((int)0xFF000000));
+					else if (key == "options")
+						options = (TriggerOptions)Enum.Parse(typeof(TriggerOptions), setting, true);
+					else
+						throw new FormatException("Unknown setting: " + key);
+				}
+				catch (ArgumentException ex)
+				{
+					throw new FormatException("Invalid action: " + part, ex);
+				}
+				catch (OverflowException ex)
+				{
+					throw new FormatException("Invalid action: " + part, ex);
+				}
+			}
+
+			return new MessageAction(color, options);
+		}
+
+		/// <summary>
+		/// Reads the actions of all message types from the settings of an application. The name of the
+		/// message type is used as key.
+		/// </summary>
+		/// <param name="settings">The settings, e.g. <see cref="System.Configuration.ConfigurationManager.AppSettings"/>.</param>
+		/// <returns>The actions by message type.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="settings"/> was NULL.</exception>
+		/// <exception cref="FormatException">An action could not be converted.</exception>
+		public static Dictionary<MessageType, MessageAction> Load(NameValueCollection settings)
+		{
+			if (settings == null)
+				throw new ArgumentNullException("settings");
+
+			Dictionary<MessageType, MessageAction> result = new Dictionary<MessageType, MessageAction>();
+
+			foreach (MessageType messageType in Enum.GetValues(typeof(MessageType)))
+			{
+				string value = settings[messageType.ToString()];
+
+				if (value != null)
+					result[messageType] = Parse(value);
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current object.
+		/// </summary>
+		/// <returns>A string that represents the current object.</returns>
+		public override string ToString()
+		{
+			string color = Color.HasValue ? (Color.Value.ToArgb() & 0xFFFFFF).ToString("X6") : "stored";
+
+			return string.Format("color {0}, options {1}", color, Options);
+		}
+	}
+}
@@ -0,0 +1,103 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Configuration;
+using System.Globalization;
+using System.IO;
+using System.Threading;
+using BISS.Networking;
+
+namespace BISS.Bridge
+{
+	/// <summary>
+	/// Bridges received BISS messages to the attached Blinky devices.
+	/// </summary>
+	/// <remarks>
+	/// Command line: Bridge [-histogram file.csv] [-report seconds] [-keyfile file]
+	/// </remarks>
+	static class Program
+	{
+		static readonly ManualResetEvent exit = new ManualResetEvent(false);
+
+		/// <summary>
+		/// Der Haupteinstiegspunkt für die Anwendung.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			string histogramPath = null;
+			int reportSeconds = 0;
+			string keyPath = null;
+			PacketAuthenticator authenticator = null;
+			IDictionary<MessageType, MessageAction> actions;
+
+			for (int a = 0; a < args.Length; a++)
+			{
+				if (args[a] == "-histogram" && a + 1 < args.Length)
+					histogramPath = args[++a];
+				else if (args[a] == "-report" && a + 1 < args.Length && int.TryParse(args[a + 1], NumberStyles.None, CultureInfo.InvariantCulture, out reportSeconds))
+					a++;
+				else if (args[a] == "-keyfile" && a + 1 < args.Length)
+					keyPath = args[++a];
+				else
+				{
+					Console.Error.WriteLine("Usage: Bridge [-histogram file.csv] [-report seconds] [-keyfile file]");
+					return 1;
+				}
+			}
+
+			try
+			{
+				actions = MessageAction.Load(ConfigurationManager.AppSettings);
+			}
+			catch (FormatException ex)
+			{
+				Console.Error.WriteLine("Invalid configuration: {0}", ex.Message);
+				return 1;
+			}
+
+			try
+			{
+				if (keyPath != null)
+					authenticator = PacketAuthenticator.FromKeyFile(keyPath);
+			}
+			catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException || ex is FormatException || ex is ArgumentException)
+			{
+				Console.Error.WriteLine("Invalid key file: {0}", ex.Message);
+				return 1;
+			}
+
+			Console.CancelKeyPress += (sender, e) =>
+			{
+				e.Cancel = true;
+				exit.Set();
+			};
+
+			using (BridgeService service = new BridgeService(actions, Console.Out, authenticator))
+			{
+				service.Start();
+				Console.WriteLine("Bridge started with {0} devices. Press Ctrl+C to exit.", service.DeviceCount);
+
+				TimeSpan reportInterval = reportSeconds > 0 ? TimeSpan.FromSeconds(reportSeconds) : Timeout.InfiniteTimeSpan;
+
+				while (!exit.WaitOne(reportInterval))
+				{
+					report(service, histogramPath);
+				}
+
+				report(service, histogramPath);
+			}
+
+			return 0;
+		}
+
+		/// <summary>
+		/// Prints the latency summary and exports the histograms, if requested.
+		/// </summary>
+		static void report(BridgeService service, string histogramPath)
+		{
+			Console.WriteLine(service.Tracer);
+
+			if (histogramPath != null)
+				service.Tracer.Export(histogramPath);
+		}
+	}
+}
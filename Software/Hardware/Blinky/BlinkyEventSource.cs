@@ -0,0 +1,248 @@
+﻿using System;
+using System.Diagnostics;
+using System.Diagnostics.Tracing;
+using System.Threading;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Provides the events and counters of the communication with Blinky devices.
+	/// </summary>
+	/// <remarks>
+	/// The event source is named "BISS-Blinky". On .NET Core the counters can be watched with
+	/// <c>dotnet-counters monitor --counters BISS-Blinky</c>.
+	/// </remarks>
+	[EventSource(Name = "BISS-Blinky")]
+	public sealed class BlinkyEventSource : EventSource
+	{
+		/// <summary>
+		/// The single instance of the event source.
+		/// </summary>
+		public static readonly BlinkyEventSource Log = new BlinkyEventSource();
+
+		long reportsWritten;
+		long writeFailures;
+		long syncMismatches;
+		long timeouts;
+		long unsupportedCommands;
+
+#if NETCOREAPP
+		DiagnosticCounter[] counters;
+		EventCounter writeLatency;
+		EventCounter readLatency;
+#endif
+
+		/// <summary>
+		/// Gets the number of reports written to devices.
+		/// </summary>
+		public long ReportsWritten
+		{
+			get
+			{
+				return Interlocked.Read(ref this.reportsWritten);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of reports which could not be written.
+		/// </summary>
+		public long WriteFailures
+		{
+			get
+			{
+				return Interlocked.Read(ref this.writeFailures);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of reports read which didn't belong to the last command sent.
+		/// </summary>
+		public long SyncMismatches
+		{
+			get
+			{
+				return Interlocked.Read(ref this.syncMismatches);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of commands which weren't answered within the timeout.
+		/// </summary>
+		public long Timeouts
+		{
+			get
+			{
+				return Interlocked.Read(ref this.timeouts);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of commands which weren't sent or were refused because the firmware doesn't support them.
+		/// </summary>
+		public long UnsupportedCommands
+		{
+			get
+			{
+				return Interlocked.Read(ref this.unsupportedCommands);
+			}
+		}
+
+		private BlinkyEventSource()
+		{ }
+
+		/// <summary>
+		/// Converts a duration in <see cref="Stopwatch"/> ticks into microseconds.
+		/// </summary>
+		private static long toMicroseconds(long ticks)
+		{
+			return ticks * 1000000 / Stopwatch.Frequency;
+		}
+
+		/// <summary>
+		/// A report was written to a device.
+		/// </summary>
+		/// <param name="command">The command of the report.</param>
+		/// <param name="microseconds">Duration of the write in microseconds.</param>
+		[Event(1, Level = EventLevel.Verbose)]
+		public void ReportWritten(string command, long microseconds)
+		{
+			Interlocked.Increment(ref this.reportsWritten);
+
+			if (!IsEnabled())
+				return;
+
+#if NETCOREAPP
+			this.writeLatency?.WriteMetric(microseconds / 1000.0);
+#endif
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(1, command, microseconds);
+		}
+
+		/// <summary>
+		/// A report was written to a device.
+		/// </summary>
+		/// <param name="command">The command of the report.</param>
+		/// <param name="started"><see cref="Stopwatch"/> timestamp when writing started.</param>
+		[NonEvent]
+		internal void ReportWritten(Command command, long started)
+		{
+			ReportWritten(command.ToString(), toMicroseconds(Stopwatch.GetTimestamp() - started));
+		}
+
+		/// <summary>
+		/// The answer to a command was read from a device.
+		/// </summary>
+		/// <param name="command">The command which was answered.</param>
+		/// <param name="microseconds">Time from sending the command until reading the answer in microseconds.</param>
+		[Event(2, Level = EventLevel.Verbose)]
+		public void AnswerRead(string command, long microseconds)
+		{
+			if (!IsEnabled())
+				return;
+
+#if NETCOREAPP
+			this.readLatency?.WriteMetric(microseconds / 1000.0);
+#endif
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(2, command, microseconds);
+		}
+
+		/// <summary>
+		/// The answer to a command was read from a device.
+		/// </summary>
+		/// <param name="command">The command which was answered.</param>
+		/// <param name="sent"><see cref="Stopwatch"/> timestamp when the command was sent.</param>
+		/// <param name="received"><see cref="Stopwatch"/> timestamp when the answer was received.</param>
+		[NonEvent]
+		internal void AnswerRead(Command command, long sent, long received)
+		{
+			if (IsEnabled())
+				AnswerRead(command.ToString(), toMicroseconds(received - sent));
+		}
+
+		/// <summary>
+		/// A report could not be written to a device.
+		/// </summary>
+		/// <param name="command">The command of the report.</param>
+		[Event(3, Level = EventLevel.Warning)]
+		public void WriteFailed(string command)
+		{
+			Interlocked.Increment(ref this.writeFailures);
+
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(3, command);
+		}
+
+		/// <summary>
+		/// A report was read whose sync byte doesn't match the last command sent.
+		/// </summary>
+		/// <param name="command">The command waiting for its answer.</param>
+		[Event(4, Level = EventLevel.Verbose)]
+		public void SyncMismatch(string command)
+		{
+			Interlocked.Increment(ref this.syncMismatches);
+
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(4, command);
+		}
+
+		/// <summary>
+		/// A command wasn't answered within the timeout.
+		/// </summary>
+		/// <param name="command">The command which wasn't answered.</param>
+		[Event(5, Level = EventLevel.Warning)]
+		public void Timeout(string command)
+		{
+			Interlocked.Increment(ref this.timeouts);
+
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(5, command);
+		}
+
+		/// <summary>
+		/// A command wasn't sent or was refused because the firmware doesn't support it.
+		/// </summary>
+		/// <param name="command">The unsupported command.</param>
+		[Event(6, Level = EventLevel.Warning)]
+		public void UnsupportedCommand(string command)
+		{
+			Interlocked.Increment(ref this.unsupportedCommands);
+
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(6, command);
+		}
+
+#if NETCOREAPP
+		/// <summary>
+		/// Creates the counters when a listener enables this event source.
+		/// </summary>
+		protected override void OnEventCommand(EventCommandEventArgs command)
+		{
+			if (command.Command != EventCommand.Enable || this.counters != null)
+				return;
+
+			this.writeLatency = new EventCounter("hid-write-latency", this) { DisplayName = "HID Write Latency", DisplayUnits = "ms" };
+			this.readLatency = new EventCounter("hid-read-latency", this) { DisplayName = "HID Answer Latency", DisplayUnits = "ms" };
+			this.counters = new DiagnosticCounter[]
+			{
+				this.writeLatency,
+				this.readLatency,
+				rateCounter("reports-written", "Reports Written", () => ReportsWritten),
+				rateCounter("write-failures", "Write Failures", () => WriteFailures),
+				rateCounter("sync-mismatches", "Sync Byte Mismatches", () => SyncMismatches),
+				rateCounter("timeouts", "Timeouts", () => Timeouts),
+				rateCounter("unsupported-commands", "Unsupported Commands", () => UnsupportedCommands)
+			};
+		}
+
+		private IncrementingPollingCounter rateCounter(string name, string displayName, Func<double> value)
+		{
+			return new IncrementingPollingCounter(name, this, value)
+			{
+				DisplayName = displayName,
+				DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+			};
+		}
+#endif
+	}
+}
@@ -40,6 +40,62 @@
 		/// <summary>
 		/// Request a heartbeat signal from the device.
 		/// </summary>
-		Ping = 8
+		Ping = 8,
+		/// <summary>
+		/// Get a statistics counter of the device.
+		/// </summary>
+		GetStatistics = 9,
+		/// <summary>
+		/// Request the arrival time and processing time of this report on the device.
+		/// </summary>
+		Echo = 10,
+		/// <summary>
+		/// Get the RAM usage of the device.
+		/// </summary>
+		GetMemoryUsage = 11,
+		/// <summary>
+		/// Get the flash layout relevant for a firmware update.
+		/// </summary>
+		FlashInfo = 12,
+		/// <summary>
+		/// Get the CRC of a flash page.
+		/// </summary>
+		FlashCrc = 13,
+		/// <summary>
+		/// Start the transfer of a page of a firmware image.
+		/// </summary>
+		FlashBegin = 14,
+		/// <summary>
+		/// Transfer data of a page of a firmware image.
+		/// </summary>
+		FlashFill = 15,
+		/// <summary>
+		/// Write the transferred page into the staging area, if the CRC matches.
+		/// </summary>
+		FlashWrite = 16,
+		/// <summary>
+		/// Install the staged firmware image and restart the device.
+		/// </summary>
+		FlashCommit = 17,
+		/// <summary>
+		/// Store settings in a profile slot in the EEPROM.
+		/// </summary>
+		SetProfile = 18,
+		/// <summary>
+		/// Get the settings of a profile slot, or the number of slots.
+		/// </summary>
+		GetProfile = 19,
+		/// <summary>
+		/// Trigger at a time of the device clock.
+		/// </summary>
+		ScheduleTrigger = 20,
+		/// <summary>
+		/// Set a run of pixels of the LED strip to the same color.
+		/// </summary>
+		StripFill = 21,
+		/// <summary>
+		/// Get a page of the capabilities of the firmware.
+		/// </summary>
+		GetCapabilities = 22
 	}
 }
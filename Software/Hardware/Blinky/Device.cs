@@ -1,4 +1,6 @@
 ﻿using System;
+using System.Diagnostics;
+using System.Drawing;
 using System.Linq;
 using System.Threading;
 using HidLibrary;
@@ -43,6 +45,7 @@ namespace BISS.Hardware.Blinky
 		Random random;
 		bool disposed;
 		byte lastSyncByte;
+		long lastWriteTimestamp;
 		readonly object lockObject;
 
 		/// <summary>
@@ -87,11 +90,34 @@ namespace BISS.Hardware.Blinky
 			}
 		}
 
+		/// <summary>
+		/// Gets the path of the device this instance is connected to, or NULL if it is not connected.
+		/// </summary>
+		public string DevicePath
+		{
+			get
+			{
+				return Connected ? this.hidDevice.DevicePath : null;
+			}
+		}
+
 		/// <summary>
 		/// Gets or sets the timeout value in milliseconds until a command to the device fails.
 		/// </summary>
 		public UInt32 Timeout { get; set; } = 100;
 
+		/// <summary>
+		/// Gets or sets the recorder of all reports sent to and received from the device, or NULL
+		/// if no trace is recorded.
+		/// </summary>
+		public TraceRecorder Recorder { get; set; }
+
+		/// <summary>
+		/// Gets what the firmware of the connected device supports, or NULL if not connected.
+		/// </summary>
+		/// <remarks>Commands the firmware doesn't support aren't sent, the methods fail at once.</remarks>
+		public DeviceCapabilities Capabilities { get; private set; }
+
 		/// <summary>
 		/// Gets or sets the settings of the blink algorithm.
 		/// </summary>
@@ -146,6 +172,25 @@ namespace BISS.Hardware.Blinky
 			return HidDevices.Enumerate(UsbVendorId, UsbProductId).FirstOrDefault();
 		}
 
+		/// <summary>
+		/// Returns the paths of all Blinky devices available.
+		/// </summary>
+		/// <returns>The device paths, which can be passed to <see cref="Connect(string)"/>.</returns>
+		public static string[] GetDevicePaths()
+		{
+			return HidDevices.Enumerate(UsbVendorId, UsbProductId).Select(d => d.DevicePath).ToArray();
+		}
+
+		/// <summary>
+		/// Determines whether the Blinky device with the specified path is available.
+		/// </summary>
+		/// <param name="devicePath">Path of the device.</param>
+		/// <returns>TRUE if the device is available.</returns>
+		public static bool IsPresent(string devicePath)
+		{
+			return GetDevicePaths().Contains(devicePath);
+		}
+
 		private void Device_Removed() => OnRemoved(EventArgs.Empty);
 
 		/// <summary>
@@ -182,6 +227,37 @@ namespace BISS.Hardware.Blinky
 			if (args.Length > maxArgCount)
 				throw new ArgumentOutOfRangeException("args");
 
+			// Always reset lockTaken.
+			lockTaken = false;
+
+			if (!Supports(cmd))
+			{
+				BlinkyEventSource.Log.UnsupportedCommand(cmd.ToString());
+				return false;
+			}
+
+			// Build a HID report. The first byte is the command byte and the last byte is
+			// the byte for syncing a (possible) answer to this report.
+			byte[] data = new byte[reportSize];
+			data[0] = (byte)cmd;
+			for (int a = 0; a < args.Length; a++)
+				data[a + 1] = args[a];
+
+			return writeReport(data, true, releaseLock, ref lockTaken);
+		}
+
+		/// <summary>
+		/// Writes a report to the connected Blinky device.
+		/// </summary>
+		/// <param name="data">The report of <see cref="reportSize"/> bytes.</param>
+		/// <param name="newSyncByte">TRUE if a new sync byte should be set; otherwise the sync byte
+		/// of the report is used.</param>
+		/// <param name="releaseLock">TRUE if the lock for thread-safety should be released after sending the report.</param>
+		/// <param name="lockTaken">TRUE if the lock was aquired.</param>
+		/// <returns>TRUE if the report was sent successfully.</returns>
+		private bool writeReport(byte[] data, bool newSyncByte, bool releaseLock, ref bool lockTaken)
+		{
+			Command cmd = (Command)data[0];
 			bool result = false;
 
 			// Always reset lockTaken.
@@ -191,16 +267,24 @@ namespace BISS.Hardware.Blinky
 			{
 				Monitor.Enter(this.lockObject, ref lockTaken);
 
-				// Build a HID report. The first byte is the command byte and the last byte is
-				// the byte for syncing a (possible) answer to this report.
+				if (newSyncByte)
+					data[7] = syncByte;
+				else
+					lastSyncByte = data[7];
+
 				HidReport report = new HidReport(reportSize);
-				report.Data = new byte[reportSize];
-				report.Data[0] = (byte)cmd;
-				for (int a = 0; a < args.Length; a++)
-					report.Data[a + 1] = args[a];
-				report.Data[7] = syncByte;
+				report.Data = data;
 
+				this.lastWriteTimestamp = Stopwatch.GetTimestamp();
 				result = this.hidDevice.WriteReport(report, (int)Timeout);
+
+				if (result)
+				{
+					BlinkyEventSource.Log.ReportWritten(cmd, this.lastWriteTimestamp);
+					Recorder?.Record(TraceKind.Sent, data, this.lastWriteTimestamp);
+				}
+				else
+					BlinkyEventSource.Log.WriteFailed(cmd.ToString());
 			}
 			finally
 			{
@@ -231,32 +315,129 @@ namespace BISS.Hardware.Blinky
 		/// <returns>Answer to the command or NULL if no answer was received.</returns>
 		private byte[] sendAndReceiveReport(Command cmd, params byte[] args)
 		{
-			bool lockTaken = false;
+			long sent, received;
 
-			if (!sendReport(cmd, false, ref lockTaken, args))
-				return null;
+			return sendAndReceiveReport(cmd, out sent, out received, args);
+		}
 
-			HidReport receivedReport = new HidReport(reportSize);
+		/// <summary>
+		/// Sends a command to the connected Blinky device and receive an answer to that command.
+		/// </summary>
+		/// <param name="cmd">Command to send.</param>
+		/// <param name="sent"><see cref="Stopwatch"/> timestamp when the command was sent.</param>
+		/// <param name="received"><see cref="Stopwatch"/> timestamp when the answer was received.</param>
+		/// <param name="args">Arguments to the command.</param>
+		/// <returns>Answer to the command or NULL if no answer was received within the timeout.</returns>
+		private byte[] sendAndReceiveReport(Command cmd, out long sent, out long received, params byte[] args)
+		{
+			if (cmd == Command.None)
+				throw new ArgumentException();
+			if (args.Length > maxArgCount)
+				throw new ArgumentOutOfRangeException("args");
 
-			// Ensure that the answer from the device belongs to the previously sent command.
-			// This is done by looping until the sync byte received from the device is the same
-			// as the sent one.
-			do
+			if (!Supports(cmd))
 			{
-				receivedReport = this.hidDevice.ReadReport((int)Timeout);
-			} while (receivedReport.Data[7] != lastSyncByte);
+				BlinkyEventSource.Log.UnsupportedCommand(cmd.ToString());
+				sent = 0;
+				received = 0;
+				return null;
+			}
+
+			byte[] data = new byte[reportSize];
+			data[0] = (byte)cmd;
+			for (int a = 0; a < args.Length; a++)
+				data[a + 1] = args[a];
+
+			byte[] answer = exchangeReport(data, true, out sent, out received);
+
+			if (answer == null)
+				return null;
 
-			if (lockTaken)
-				Monitor.Exit(this.lockObject);
+			// The device answers commands it doesn't know with command zero.
+			if (answer[0] == 0)
+			{
+				BlinkyEventSource.Log.UnsupportedCommand(cmd.ToString());
+				return null;
+			}
 
 			// Cut the answer from the received report. The first byte is the command to which
 			// this answer belongs to and the last byte is the sync byte sent with the command.
 			byte[] result = new byte[maxArgCount];
-			Array.Copy(receivedReport.Data, 1, result, 0, maxArgCount);
+			Array.Copy(answer, 1, result, 0, maxArgCount);
 
 			return result;
 		}
 
+		/// <summary>
+		/// Writes a report to the connected Blinky device and receives the answer to it.
+		/// </summary>
+		/// <param name="data">The report of <see cref="reportSize"/> bytes.</param>
+		/// <param name="newSyncByte">TRUE if a new sync byte should be set; otherwise the sync byte
+		/// of the report is used.</param>
+		/// <param name="sent"><see cref="Stopwatch"/> timestamp when the report was sent.</param>
+		/// <param name="received"><see cref="Stopwatch"/> timestamp when the answer was received.</param>
+		/// <returns>The complete answer report or NULL if no answer was received within the timeout.</returns>
+		private byte[] exchangeReport(byte[] data, bool newSyncByte, out long sent, out long received)
+		{
+			Command cmd = (Command)data[0];
+			bool lockTaken = false;
+			HidReport receivedReport;
+
+			sent = 0;
+			received = 0;
+
+			try
+			{
+				if (!writeReport(data, newSyncByte, false, ref lockTaken))
+					return null;
+
+				sent = this.lastWriteTimestamp;
+				long deadline = sent + Timeout * Stopwatch.Frequency / 1000;
+
+				// Ensure that the answer from the device belongs to the previously sent command.
+				// This is done by looping until the sync byte received from the device is the same
+				// as the sent one. The device repeats its last answer, so give up after the timeout.
+				while (true)
+				{
+					receivedReport = this.hidDevice.ReadReport((int)Timeout);
+
+					if (receivedReport.ReadStatus != HidDeviceData.ReadStatus.Success)
+					{
+						BlinkyEventSource.Log.Timeout(cmd.ToString());
+						Recorder?.Record(TraceKind.Timeout, data, Stopwatch.GetTimestamp());
+						return null;
+					}
+
+					long now = Stopwatch.GetTimestamp();
+					Recorder?.Record(TraceKind.Received, receivedReport.Data, now);
+
+					if (receivedReport.Data[7] == lastSyncByte)
+					{
+						received = now;
+						break;
+					}
+
+					BlinkyEventSource.Log.SyncMismatch(cmd.ToString());
+
+					if (now > deadline)
+					{
+						BlinkyEventSource.Log.Timeout(cmd.ToString());
+						Recorder?.Record(TraceKind.Timeout, data, now);
+						return null;
+					}
+				}
+
+				BlinkyEventSource.Log.AnswerRead(cmd, sent, received);
+			}
+			finally
+			{
+				if (lockTaken)
+					Monitor.Exit(this.lockObject);
+			}
+
+			return receivedReport.Data;
+		}
+
 		/// <summary>
 		/// Raises the <see cref="Removed"/> event.
 		/// </summary>
@@ -277,7 +458,36 @@ namespace BISS.Hardware.Blinky
 			if (Connected)
 				throw new InvalidOperationException("Already connected to device.");
 
-			this.hidDevice = enumerate();
+			return connect(enumerate());
+		}
+
+		/// <summary>
+		/// Connect to the device with the specified path.
+		/// </summary>
+		/// <param name="devicePath">Path of the device as returned by <see cref="GetDevicePaths"/>.</param>
+		/// <returns>TRUE on success.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="devicePath"/> was NULL.</exception>
+		/// <exception cref="InvalidOperationException">Thrown if this instance is already connected.</exception>
+		public bool Connect(string devicePath)
+		{
+			isValidCall(false);
+
+			if (devicePath == null)
+				throw new ArgumentNullException("devicePath");
+			if (Connected)
+				throw new InvalidOperationException("Already connected to device.");
+
+			return connect(HidDevices.GetDevice(devicePath));
+		}
+
+		/// <summary>
+		/// Opens the specified device for communication.
+		/// </summary>
+		/// <param name="device">The device or NULL if it is not available.</param>
+		/// <returns>TRUE on success.</returns>
+		private bool connect(HidDevice device)
+		{
+			this.hidDevice = device;
 
 			if (this.hidDevice == null)
 				return false;
@@ -286,9 +496,46 @@ namespace BISS.Hardware.Blinky
 			this.hidDevice.MonitorDeviceEvents = true;
 			this.hidDevice.OpenDevice();
 
+			Capabilities = getCapabilities();
+
 			return true;
 		}
 
+		/// <summary>
+		/// Reads the capabilities of the firmware.
+		/// </summary>
+		/// <returns>The capabilities; <see cref="DeviceCapabilities.Legacy"/> if the firmware doesn't
+		/// report them, which costs a timeout for firmware which doesn't answer unknown commands.</returns>
+		private DeviceCapabilities getCapabilities()
+		{
+			byte[] general = sendAndReceiveReport(Command.GetCapabilities, 0);
+
+			if (general == null || general[0] != 0)
+				return DeviceCapabilities.Legacy;
+
+			byte[] commands = sendAndReceiveReport(Command.GetCapabilities, 1);
+
+			if (commands == null || commands[0] != 1)
+				return DeviceCapabilities.Legacy;
+
+			byte[] bitmap = new byte[maxArgCount - 1];
+			Array.Copy(commands, 1, bitmap, 0, bitmap.Length);
+
+			return new DeviceCapabilities(new Version(general[1], general[2]), general[3], (DeviceFeatures)general[4], bitmap);
+		}
+
+		/// <summary>
+		/// Determines whether the firmware of the connected device supports a command.
+		/// </summary>
+		/// <param name="cmd">The command.</param>
+		/// <returns>TRUE if the command is supported or the capabilities are not known yet.</returns>
+		internal bool Supports(Command cmd)
+		{
+			DeviceCapabilities capabilities = Capabilities;
+
+			return capabilities == null || capabilities.Supports(cmd);
+		}
+
 		/// <summary>
 		/// Disconnect from the device.
 		/// </summary>
@@ -301,6 +548,7 @@ namespace BISS.Hardware.Blinky
 
 			this.hidDevice.Removed -= Device_Removed;
 			this.hidDevice.CloseDevice();
+			Capabilities = null;
 		}
 
 		/// <summary>
@@ -315,6 +563,51 @@ namespace BISS.Hardware.Blinky
 			return sendReport(Command.Trigger, (byte)flags);
 		}
 
+		/// <summary>
+		/// Enables the blink algorithm with the settings of a profile by sending the Trigger command.
+		/// </summary>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="profile">The profile slot, starting at 1. Zero keeps the current settings.</param>
+		/// <returns>TRUE on success.</returns>
+		/// <remarks>The device triggers with its current settings if the slot doesn't exist. The settings
+		/// of the profile remain the current settings afterwards.</remarks>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 0 and 255.</exception>
+		public bool Trigger(TriggerOptions flags, int profile)
+		{
+			isValidCall();
+
+			if (profile < 0 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			return sendReport(Command.Trigger, (byte)flags, (byte)profile);
+		}
+
+		/// <summary>
+		/// Enables the blink algorithm at a time of the device clock.
+		/// </summary>
+		/// <param name="deviceTime">Time of the device clock in microseconds, see <see cref="DeviceClock"/>.</param>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="profile">The profile slot, starting at 1. Zero keeps the current settings.</param>
+		/// <returns>The status of the schedule or NULL if the device did not answer.</returns>
+		/// <remarks>A new schedule replaces the pending one. The device triggers at once if the time has
+		/// already passed; it can't be more than 60 seconds ahead.</remarks>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 0 and 255.</exception>
+		public ScheduleStatus? ScheduleTrigger(uint deviceTime, TriggerOptions flags = DefaultTriggerOptions, int profile = 0)
+		{
+			isValidCall();
+
+			if (profile < 0 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			byte[] time = BitConverter.GetBytes(deviceTime);
+			byte[] received = sendAndReceiveReport(Command.ScheduleTrigger, (byte)flags, (byte)profile, time[0], time[1], time[2], time[3]);
+
+			if (received == null)
+				return null;
+
+			return (ScheduleStatus)received[0];
+		}
+
 		/// <summary>
 		/// Enables the blink algorithm by sending the Trigger command.
 		/// </summary>
@@ -405,6 +698,339 @@ namespace BISS.Hardware.Blinky
 
 			return devicePong != null && devicePong.SequenceEqual(pong);
 		}
+
+		/// <summary>
+		/// Sends an echo request to the device. The answer contains the arrival time of the request
+		/// on the device and its processing time there.
+		/// </summary>
+		/// <returns>Instance of <see cref="EchoResult"/> or NULL if the device did not answer.</returns>
+		/// <seealso cref="LatencyProfiler"/>
+		public EchoResult Echo()
+		{
+			isValidCall();
+
+			long sent, received;
+			byte[] answer = sendAndReceiveReport(Command.Echo, out sent, out received);
+
+			if (answer == null)
+				return null;
+
+			return new EchoResult(sent, received, BitConverter.ToUInt32(answer, 0), BitConverter.ToUInt16(answer, 4));
+		}
+
+		/// <summary>
+		/// Reads the RAM usage of the device, including the high-water mark of the stack.
+		/// </summary>
+		/// <returns>Instance of <see cref="MemoryUsage"/> or NULL if the usage could not be determined.</returns>
+		public MemoryUsage GetMemoryUsage()
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.GetMemoryUsage);
+
+			if (received == null)
+				return null;
+
+			return new MemoryUsage(BitConverter.ToUInt16(received, 4), BitConverter.ToUInt16(received, 2),
+				BitConverter.ToUInt16(received, 0));
+		}
+
+		/// <summary>
+		/// Reads the statistics counters of the device.
+		/// </summary>
+		/// <returns>Instance of <see cref="Statistics"/> or NULL if the statistics could not be determined.</returns>
+		public Statistics GetStatistics()
+		{
+			isValidCall();
+
+			uint[] counters = new uint[Statistics.CounterCount];
+
+			// Each report returns the index and the value of a single counter.
+			for (byte index = 0; index < counters.Length; index++)
+			{
+				byte[] received = sendAndReceiveReport(Command.GetStatistics, index);
+
+				if (received == null || received[0] != index)
+					return null;
+
+				counters[index] = BitConverter.ToUInt32(received, 1);
+			}
+
+			return new Statistics(counters);
+		}
+		#endregion
+
+		#region Profiles
+		/// <summary>
+		/// Reads the number of profile slots of the device.
+		/// </summary>
+		/// <returns>The number of slots or zero if the device doesn't support profiles.</returns>
+		public int GetProfileCount()
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.GetProfile, 0);
+
+			if (received == null || received[0] != 0)
+				return 0;
+
+			return received[1];
+		}
+
+		/// <summary>
+		/// Stores settings in a profile slot of the device. The slot is stored in the EEPROM, only bytes
+		/// which changed are written.
+		/// </summary>
+		/// <param name="profile">The profile slot, starting at 1.</param>
+		/// <param name="settings">The settings.</param>
+		/// <returns>TRUE if the device stored the profile.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="settings"/> was NULL.</exception>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 1 and 255.</exception>
+		public bool SetProfile(int profile, Settings settings)
+		{
+			isValidCall();
+
+			if (settings == null)
+				throw new ArgumentNullException("settings");
+			if (profile < 1 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			byte[] args = new byte[maxArgCount];
+			byte[] values = settings;
+
+			args[0] = (byte)profile;
+			Array.Copy(values, 0, args, 1, values.Length);
+
+			byte[] received = sendAndReceiveReport(Command.SetProfile, args);
+
+			return received != null && received[0] == (byte)profile && received[1] == 0;
+		}
+
+		/// <summary>
+		/// Reads the settings of a profile slot of the device.
+		/// </summary>
+		/// <param name="profile">The profile slot, starting at 1.</param>
+		/// <returns>The settings or NULL if the slot doesn't exist or the device did not answer.</returns>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 1 and 255.</exception>
+		public Settings GetProfile(int profile)
+		{
+			isValidCall();
+
+			if (profile < 1 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			byte[] received = sendAndReceiveReport(Command.GetProfile, (byte)profile);
+
+			if (received == null || received[0] != (byte)profile)
+				return null;
+
+			return new Settings(received[1], received[2], received[3], received[4], received[5]);
+		}
+		#endregion
+
+		#region LED strip
+		/// <summary>
+		/// Reads the number of pixels of the LED strip on the AUX output.
+		/// </summary>
+		/// <returns>The number of pixels or zero if the firmware was built without a LED strip.</returns>
+		public int GetStripLength()
+		{
+			isValidCall();
+
+			// A block without pixels only returns the number of pixels.
+			byte[] received = sendAndReceiveReport(Command.StripFill, 0, 0);
+
+			if (received == null)
+				return 0;
+
+			return received[1];
+		}
+
+		/// <summary>
+		/// Sets pixels of the LED strip and shows them, while the blink algorithm is enabled and the
+		/// display is on. A run of pixels with the same color is sent as a single report.
+		/// </summary>
+		/// <param name="pixels">The colors of the pixels.</param>
+		/// <param name="first">Index of the first pixel to be set.</param>
+		/// <returns>TRUE if the device accepted the last block; the reports are handled in order.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="pixels"/> was NULL.</exception>
+		/// <exception cref="ArgumentOutOfRangeException">The pixels are not between 0 and 255.</exception>
+		public bool SetPixels(Color[] pixels, int first = 0)
+		{
+			isValidCall();
+
+			if (pixels == null)
+				throw new ArgumentNullException("pixels");
+			if (first < 0 || first + pixels.Length > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("first");
+
+			int start = 0;
+
+			while (start < pixels.Length)
+			{
+				int end = start + 1;
+				Color color = pixels[start];
+
+				while (end < pixels.Length && pixels[end].ToArgb() == color.ToArgb())
+					end++;
+
+				// Only the last block shows the frame and is waited for.
+				byte show = (byte)(end == pixels.Length ? 1 : 0);
+				byte[] args = new byte[] { (byte)(first + start), (byte)(end - start), color.R, color.G, color.B, show };
+
+				if (show != 0)
+				{
+					byte[] received = sendAndReceiveReport(Command.StripFill, args);
+
+					return received != null && received[0] == 0;
+				}
+
+				if (!sendReport(Command.StripFill, args))
+					return false;
+
+				start = end;
+			}
+
+			return true;
+		}
+		#endregion
+
+		#region Replay
+		/// <summary>
+		/// Sends a report unchanged, including its sync byte, e.g. one of a <see cref="TraceFile"/>.
+		/// </summary>
+		/// <param name="report">The report of 8 bytes: command, arguments and sync byte.</param>
+		/// <param name="waitForAnswer">TRUE if the answer of the device should be received.</param>
+		/// <param name="sent"><see cref="Stopwatch"/> timestamp when the report was sent.</param>
+		/// <param name="received"><see cref="Stopwatch"/> timestamp when the answer was received.</param>
+		/// <returns>The complete answer report; an empty array if no answer was requested; NULL if the
+		/// report could not be sent or no answer was received within the timeout.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="report"/> was NULL.</exception>
+		/// <exception cref="ArgumentException">The report doesn't have 8 bytes.</exception>
+		public byte[] SendRawReport(byte[] report, bool waitForAnswer, out long sent, out long received)
+		{
+			isValidCall();
+
+			if (report == null)
+				throw new ArgumentNullException("report");
+			if (report.Length != reportSize)
+				throw new ArgumentException("A report has 8 bytes.", "report");
+
+			byte[] data = (byte[])report.Clone();
+
+			if (waitForAnswer)
+				return exchangeReport(data, false, out sent, out received);
+
+			bool lockTaken = false;
+
+			sent = 0;
+			received = 0;
+
+			try
+			{
+				if (!writeReport(data, false, false, ref lockTaken))
+					return null;
+
+				sent = this.lastWriteTimestamp;
+			}
+			finally
+			{
+				if (lockTaken)
+					Monitor.Exit(this.lockObject);
+			}
+
+			return new byte[0];
+		}
+		#endregion
+
+		#region Firmware update
+		/// <summary>
+		/// Reads the flash layout of the device.
+		/// </summary>
+		/// <returns>Instance of <see cref="FlashInfo"/> or NULL if the device did not answer.</returns>
+		internal FlashInfo GetFlashInfo()
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.FlashInfo);
+
+			if (received == null)
+				return null;
+
+			return new FlashInfo((FlashStatus)received[0], BitConverter.ToUInt16(received, 1), received[3], received[4], received[5]);
+		}
+
+		/// <summary>
+		/// Reads the CRC of a flash page of the device.
+		/// </summary>
+		/// <param name="page">Index of the page.</param>
+		/// <returns>The CRC or NULL if the device did not answer.</returns>
+		internal ushort? GetFlashPageCrc(int page)
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.FlashCrc, (byte)page);
+
+			if (received == null || received[0] != (byte)page)
+				return null;
+
+			return BitConverter.ToUInt16(received, 1);
+		}
+
+		/// <summary>
+		/// Transfers a page of a firmware image into the staging area of the device.
+		/// </summary>
+		/// <param name="page">Index of the page in the image.</param>
+		/// <param name="data">Content of the page.</param>
+		/// <returns>The result reported by the device or NULL if the device did not answer.</returns>
+		internal FlashStatus? WriteFlashPage(int page, byte[] data)
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.FlashBegin, (byte)page);
+
+			if (received == null || received[0] != (byte)page)
+				return null;
+			if ((FlashStatus)received[1] != FlashStatus.Ok)
+				return (FlashStatus)received[1];
+
+			// The data is sent without waiting for answers, the CRC sent afterwards
+			// tells whether the device received all of it.
+			for (int offset = 0; offset < data.Length; offset += maxArgCount)
+			{
+				byte[] fill = new byte[maxArgCount];
+				Array.Copy(data, offset, fill, 0, Math.Min(maxArgCount, data.Length - offset));
+
+				if (!sendReport(Command.FlashFill, fill))
+					return null;
+			}
+
+			ushort crc = FirmwareImage.ComputeCrc(data);
+			received = sendAndReceiveReport(Command.FlashWrite, (byte)page, (byte)crc, (byte)(crc >> 8));
+
+			if (received == null || received[0] != (byte)page)
+				return null;
+
+			return (FlashStatus)received[1];
+		}
+
+		/// <summary>
+		/// Installs the staged firmware image. The device restarts if the image is complete.
+		/// </summary>
+		/// <param name="pageCount">Number of pages of the image.</param>
+		/// <returns>The reason why the device refused to install the image, or NULL if the device
+		/// did not answer because it restarts.</returns>
+		internal FlashStatus? CommitFlash(int pageCount)
+		{
+			isValidCall();
+
+			byte[] received = sendAndReceiveReport(Command.FlashCommit, (byte)pageCount);
+
+			if (received == null)
+				return null;
+
+			return (FlashStatus)received[0];
+		}
 		#endregion
 
 		#region IDisposable Support
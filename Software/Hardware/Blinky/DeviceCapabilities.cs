@@ -0,0 +1,82 @@
+﻿using System;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents what the firmware of a Blinky device supports, as reported by the device once
+	/// when connecting.
+	/// </summary>
+	public class DeviceCapabilities
+	{
+		/// <summary>
+		/// Number of commands in the command bitmap.
+		/// </summary>
+		const int bitmapCommands = 40;
+
+		/// <summary>
+		/// Capabilities assumed for a firmware which doesn't report them. Only the first firmware lacks
+		/// <see cref="Command.GetCapabilities"/>; it has the commands up to <see cref="Command.Ping"/>
+		/// and the trigger options.
+		/// </summary>
+		internal static readonly DeviceCapabilities Legacy = new DeviceCapabilities(null, 8,
+			DeviceFeatures.TouchSensor | DeviceFeatures.Timeout | DeviceFeatures.AuxOutput,
+			new byte[] { 0xFE, 0x01, 0x00, 0x00, 0x00 });
+
+		readonly byte[] commands;
+
+		/// <summary>
+		/// Gets the version of the firmware, or NULL if the firmware doesn't report its capabilities.
+		/// </summary>
+		public Version Version
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the size of a HID report in bytes.
+		/// </summary>
+		public int ReportSize
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the optional features the firmware was built with.
+		/// </summary>
+		public DeviceFeatures Features
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the DeviceCapabilities class.
+		/// </summary>
+		/// <param name="version">Version of the firmware.</param>
+		/// <param name="reportSize">Size of a HID report in bytes.</param>
+		/// <param name="features">Optional features of the firmware.</param>
+		/// <param name="commands">Bitmap of the supported commands; bit n of byte n / 8 is set if
+		/// command n is supported.</param>
+		internal DeviceCapabilities(Version version, int reportSize, DeviceFeatures features, byte[] commands)
+		{
+			this.Version = version;
+			this.ReportSize = reportSize;
+			this.Features = features;
+			this.commands = commands;
+		}
+
+		/// <summary>
+		/// Determines whether the firmware supports a command.
+		/// </summary>
+		/// <param name="cmd">The command.</param>
+		/// <returns>TRUE if the command is supported.</returns>
+		internal bool Supports(Command cmd)
+		{
+			int index = (int)cmd;
+
+			return index < bitmapCommands && (this.commands[index / 8] & (1 << (index % 8))) != 0;
+		}
+
+		/// <summary>
+		/// Returns the capabilities as readable text.
+		/// </summary>
+		/// <returns>The version and the features.</returns>
+		public override string ToString()
+		{
+			return String.Format("Firmware {0}, {1}", Version != null ? Version.ToString() : "unknown", Features);
+		}
+	}
+}
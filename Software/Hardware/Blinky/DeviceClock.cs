@@ -0,0 +1,189 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Converts host times into times of the clock of a Blinky device, so triggers can be scheduled
+	/// with <see cref="Device.ScheduleTrigger"/>.
+	/// </summary>
+	/// <remarks>
+	/// <para>The clock is synchronized by echo requests. The request with the shortest round trip has
+	/// the least unknown delays, so its device time is mapped to the middle of its round trip. The
+	/// error is at most half of this round trip, which is usually a fraction of the polling interval.</para>
+	/// <para>The crystal of the device deviates by some ppm. Synchronizing again after some seconds
+	/// measures this drift, it is compensated afterwards.</para>
+	/// </remarks>
+	public class DeviceClock
+	{
+		/// <summary>
+		/// Default number of echo requests for a synchronization.
+		/// </summary>
+		public const int DefaultSamples = 8;
+
+		/// <summary>
+		/// Drifts larger than this are not caused by the crystal, e.g. the device restarted meanwhile.
+		/// </summary>
+		const double maxDrift = 500e-6;
+
+		/// <summary>
+		/// Minimum time between two synchronizations for measuring the drift.
+		/// </summary>
+		static readonly TimeSpan minDriftInterval = TimeSpan.FromSeconds(1);
+
+		readonly Device device;
+		readonly object lockObject;
+
+		// Host time (Stopwatch timestamp) and the device time (microseconds) at the same moment.
+		long hostReference;
+		uint deviceReference;
+		double drift;
+		bool synchronized;
+		TimeSpan uncertainty;
+
+		/// <summary>
+		/// Gets a value indicating whether the clock was synchronized successfully.
+		/// </summary>
+		public bool Synchronized
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.synchronized;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the maximum error of the last synchronization, which is half of the shortest round trip.
+		/// </summary>
+		public TimeSpan Uncertainty
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.uncertainty;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the measured drift of the device clock in ppm; positive if the device clock is fast.
+		/// </summary>
+		public double Drift
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.drift * 1e6;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the DeviceClock class.
+		/// </summary>
+		/// <param name="device">The connected device.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="device"/> was NULL.</exception>
+		public DeviceClock(Device device)
+		{
+			if (device == null)
+				throw new ArgumentNullException("device");
+
+			this.device = device;
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Synchronizes with the clock of the device.
+		/// </summary>
+		/// <param name="samples">Number of echo requests.</param>
+		/// <returns>TRUE on success; FALSE if the device didn't answer, the previous synchronization
+		/// is kept then.</returns>
+		/// <exception cref="ArgumentOutOfRangeException">The number of samples is less than 1.</exception>
+		public bool Synchronize(int samples = DefaultSamples)
+		{
+			if (samples < 1)
+				throw new ArgumentOutOfRangeException("samples");
+
+			EchoResult best = null;
+
+			for (int a = 0; a < samples; a++)
+			{
+				EchoResult result = this.device.Echo();
+
+				if (result != null && (best == null || result.RoundTrip < best.RoundTrip))
+					best = result;
+			}
+
+			if (best == null)
+				return false;
+
+			long hostTime = best.HostSent + (best.HostReceived - best.HostSent) / 2;
+			uint deviceTime = best.DeviceArrival + (uint)(best.DeviceProcessing.Ticks / (TimeSpan.TicksPerMillisecond / 1000) / 2);
+
+			lock (this.lockObject)
+			{
+				double hostElapsed = toMicroseconds(hostTime - this.hostReference);
+
+				// The device clock wraps around, the difference is right if less than half of its range elapsed.
+				if (this.synchronized && hostElapsed >= minDriftInterval.TotalMilliseconds * 1000 && hostElapsed < int.MaxValue)
+				{
+					double measured = (int)(deviceTime - this.deviceReference) / hostElapsed - 1;
+
+					this.drift = Math.Abs(measured) < maxDrift ? measured : 0;
+				}
+
+				this.hostReference = hostTime;
+				this.deviceReference = deviceTime;
+				this.uncertainty = TimeSpan.FromTicks(best.RoundTrip.Ticks / 2);
+				this.synchronized = true;
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// Converts a <see cref="Stopwatch"/> timestamp into the time of the device clock.
+		/// </summary>
+		/// <param name="timestamp">The timestamp.</param>
+		/// <returns>The time of the device clock in microseconds.</returns>
+		/// <exception cref="InvalidOperationException">The clock is not synchronized.</exception>
+		public uint ToDeviceTime(long timestamp)
+		{
+			lock (this.lockObject)
+			{
+				if (!this.synchronized)
+					throw new InvalidOperationException("The clock is not synchronized.");
+
+				double elapsed = toMicroseconds(timestamp - this.hostReference) * (1 + this.drift);
+
+				return unchecked(this.deviceReference + (uint)(long)Math.Round(elapsed));
+			}
+		}
+
+		/// <summary>
+		/// Converts a time of the host clock into the time of the device clock.
+		/// </summary>
+		/// <param name="time">The time.</param>
+		/// <returns>The time of the device clock in microseconds.</returns>
+		/// <exception cref="InvalidOperationException">The clock is not synchronized.</exception>
+		public uint ToDeviceTime(DateTime time)
+		{
+			// The Stopwatch doesn't jump when the host clock is adjusted, so the conversion is done
+			// relative to the current time.
+			long now = Stopwatch.GetTimestamp();
+			TimeSpan ahead = time.ToUniversalTime() - DateTime.UtcNow;
+
+			return ToDeviceTime(now + (long)(ahead.TotalSeconds * Stopwatch.Frequency));
+		}
+
+		private static double toMicroseconds(long ticks)
+		{
+			return ticks * 1e6 / Stopwatch.Frequency;
+		}
+	}
+}
@@ -0,0 +1,34 @@
+﻿using System;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Specifies the optional features of a Blinky firmware.
+	/// </summary>
+	/// <remarks>The values must be kept in sync with the CAP_FEATURE_* flags in the Blinky firmware.
+	/// The first flags are the same as the <see cref="TriggerOptions"/> they enable.</remarks>
+	[Flags()]
+	public enum DeviceFeatures : byte
+	{
+		/// <summary>
+		/// No optional feature.
+		/// </summary>
+		None = 0,
+		/// <summary>
+		/// The touch sensor can disable the blink algorithm.
+		/// </summary>
+		TouchSensor = 1,
+		/// <summary>
+		/// The blink algorithm can be disabled after a timeout.
+		/// </summary>
+		Timeout = 2,
+		/// <summary>
+		/// The auxiliary output follows the display.
+		/// </summary>
+		AuxOutput = 4,
+		/// <summary>
+		/// A LED strip is driven on the auxiliary output.
+		/// </summary>
+		LedStrip = 8
+	}
+}
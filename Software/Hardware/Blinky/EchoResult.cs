@@ -0,0 +1,62 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the answer of the device to an echo request.
+	/// </summary>
+	public class EchoResult
+	{
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the request was sent to the device.
+		/// </summary>
+		public long HostSent
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the answer was received from the device.
+		/// </summary>
+		public long HostReceived
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the clock of the device in microseconds when the request arrived at the device.
+		/// <remarks>The clock of the device wraps around after about 71 minutes.</remarks>
+		/// </summary>
+		public uint DeviceArrival
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the time from the arrival of the request until the answer was queued for the host.
+		/// </summary>
+		public TimeSpan DeviceProcessing
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the time between sending the request and receiving the answer.
+		/// </summary>
+		public TimeSpan RoundTrip
+		{
+			get
+			{
+				return TimeSpan.FromTicks((HostReceived - HostSent) * TimeSpan.TicksPerSecond / Stopwatch.Frequency);
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the EchoResult class.
+		/// </summary>
+		/// <param name="hostSent">Timestamp when the request was sent.</param>
+		/// <param name="hostReceived">Timestamp when the answer was received.</param>
+		/// <param name="deviceArrival">Device clock in microseconds when the request arrived.</param>
+		/// <param name="deviceProcessing">Processing time of the device in microseconds.</param>
+		internal EchoResult(long hostSent, long hostReceived, uint deviceArrival, ushort deviceProcessing)
+		{
+			this.HostSent = hostSent;
+			this.HostReceived = hostReceived;
+			this.DeviceArrival = deviceArrival;
+			this.DeviceProcessing = TimeSpan.FromTicks(deviceProcessing * (TimeSpan.TicksPerMillisecond / 1000));
+		}
+	}
+}
@@ -0,0 +1,232 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents a firmware image of the Blinky device, as built by the firmware makefile.
+	/// </summary>
+	public class FirmwareImage
+	{
+		/// <summary>
+		/// Value of erased flash memory.
+		/// </summary>
+		private const byte erasedValue = 0xFF;
+
+		readonly byte[] data;
+		readonly bool[] used;
+
+		/// <summary>
+		/// Gets the size of the image in bytes, from address 0 up to the last byte used.
+		/// </summary>
+		public int Length
+		{
+			get
+			{
+				return this.data.Length;
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the FirmwareImage class from a binary image.
+		/// </summary>
+		/// <param name="data">Content of the flash, starting at address 0.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="data"/> was NULL.</exception>
+		public FirmwareImage(byte[] data)
+		{
+			if (data == null)
+				throw new ArgumentNullException("data");
+
+			this.data = (byte[])data.Clone();
+			this.used = new bool[data.Length];
+
+			for (int a = 0; a < this.used.Length; a++)
+				this.used[a] = true;
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the FirmwareImage class.
+		/// </summary>
+		/// <param name="data">Content of the flash, starting at address 0.</param>
+		/// <param name="used">TRUE for each byte which is part of the image.</param>
+		private FirmwareImage(byte[] data, bool[] used)
+		{
+			this.data = data;
+			this.used = used;
+		}
+
+		/// <summary>
+		/// Reads a firmware image from a file in the Intel HEX format.
+		/// </summary>
+		/// <param name="path">Path of the file.</param>
+		/// <returns>The firmware image.</returns>
+		/// <exception cref="FormatException">The file is not a valid Intel HEX file.</exception>
+		public static FirmwareImage FromHexFile(string path)
+		{
+			using (StreamReader reader = new StreamReader(path))
+			{
+				return Parse(reader);
+			}
+		}
+
+		/// <summary>
+		/// Reads a firmware image in the Intel HEX format.
+		/// </summary>
+		/// <param name="reader">Reader providing the records.</param>
+		/// <returns>The firmware image.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="reader"/> was NULL.</exception>
+		/// <exception cref="FormatException">The input is not valid Intel HEX.</exception>
+		public static FirmwareImage Parse(TextReader reader)
+		{
+			if (reader == null)
+				throw new ArgumentNullException("reader");
+
+			SortedDictionary<int, byte> content = new SortedDictionary<int, byte>();
+			int baseAddress = 0;
+			string line;
+
+			while ((line = reader.ReadLine()) != null)
+			{
+				line = line.Trim();
+
+				if (line.Length == 0)
+					continue;
+				if (line[0] != ':' || line.Length < 11 || line.Length % 2 == 0)
+					throw new FormatException("Invalid record: " + line);
+
+				byte[] record = new byte[(line.Length - 1) / 2];
+				byte checksum = 0;
+
+				for (int a = 0; a < record.Length; a++)
+				{
+					record[a] = byte.Parse(line.Substring(1 + a * 2, 2), NumberStyles.HexNumber, CultureInfo.InvariantCulture);
+					checksum += record[a];
+				}
+
+				// Byte count, address, record type, data, checksum
+				if (checksum != 0 || record[0] != record.Length - 5)
+					throw new FormatException("Invalid record: " + line);
+
+				int address = (record[1] << 8) | record[2];
+
+				switch (record[3])
+				{
+					case 0x00:
+						for (int a = 0; a < record[0]; a++)
+							content[baseAddress + address + a] = record[4 + a];
+						break;
+					case 0x01:
+						return fromContent(content);
+					case 0x02:
+						baseAddress = ((record[4] << 8) | record[5]) << 4;
+						break;
+					case 0x04:
+						baseAddress = ((record[4] << 8) | record[5]) << 16;
+						break;
+				}
+			}
+
+			return fromContent(content);
+		}
+
+		/// <summary>
+		/// Creates a firmware image from the bytes of the parsed records.
+		/// </summary>
+		/// <param name="content">Bytes of the image by address.</param>
+		/// <returns>The firmware image.</returns>
+		private static FirmwareImage fromContent(SortedDictionary<int, byte> content)
+		{
+			int length = 0;
+
+			foreach (int address in content.Keys)
+				length = address + 1;
+
+			byte[] data = new byte[length];
+			bool[] used = new bool[length];
+
+			for (int a = 0; a < length; a++)
+				data[a] = erasedValue;
+
+			foreach (KeyValuePair<int, byte> b in content)
+			{
+				data[b.Key] = b.Value;
+				used[b.Key] = true;
+			}
+
+			return new FirmwareImage(data, used);
+		}
+
+		/// <summary>
+		/// Calculates the CRC of data as done by the Blinky firmware (CRC-CCITT of avr-libc).
+		/// </summary>
+		/// <param name="data">The data.</param>
+		/// <returns>The CRC.</returns>
+		internal static ushort ComputeCrc(byte[] data)
+		{
+			ushort crc = 0xFFFF;
+
+			foreach (byte b in data)
+			{
+				byte x = (byte)(b ^ (crc & 0xFF));
+				x ^= (byte)(x << 4);
+
+				crc = (ushort)(((x << 8) | (crc >> 8)) ^ (byte)(x >> 4) ^ (x << 3));
+			}
+
+			return crc;
+		}
+
+		/// <summary>
+		/// Returns a page of the image. Bytes which are not part of the image are erased.
+		/// </summary>
+		/// <param name="page">Index of the page.</param>
+		/// <param name="pageSize">Size of a flash page in bytes.</param>
+		/// <returns>Content of the page.</returns>
+		internal byte[] GetPage(int page, int pageSize)
+		{
+			byte[] result = new byte[pageSize];
+			int start = page * pageSize;
+
+			for (int a = 0; a < pageSize; a++)
+				result[a] = start + a < this.data.Length ? this.data[start + a] : erasedValue;
+
+			return result;
+		}
+
+		/// <summary>
+		/// Determines whether the image contains data in a page.
+		/// </summary>
+		/// <param name="page">Index of the page.</param>
+		/// <param name="pageSize">Size of a flash page in bytes.</param>
+		/// <returns>TRUE if at least one byte of the page is part of the image.</returns>
+		internal bool IsPageUsed(int page, int pageSize)
+		{
+			for (int a = page * pageSize; a < (page + 1) * pageSize && a < this.used.Length; a++)
+			{
+				if (this.used[a])
+					return true;
+			}
+
+			return false;
+		}
+
+		/// <summary>
+		/// Returns the number of pages of the image below a page. Pages above are not counted.
+		/// </summary>
+		/// <param name="pageSize">Size of a flash page in bytes.</param>
+		/// <param name="limit">First page which is not counted.</param>
+		/// <returns>Index of the last page used below <paramref name="limit"/> plus one.</returns>
+		internal int GetPageCount(int pageSize, int limit)
+		{
+			for (int page = Math.Min(limit, (this.data.Length + pageSize - 1) / pageSize) - 1; page >= 0; page--)
+			{
+				if (IsPageUsed(page, pageSize))
+					return page + 1;
+			}
+
+			return 0;
+		}
+	}
+}
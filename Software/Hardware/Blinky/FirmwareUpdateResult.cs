@@ -0,0 +1,107 @@
+﻿using System;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the result of a firmware update of a single Blinky device.
+	/// </summary>
+	public class FirmwareUpdateResult
+	{
+		/// <summary>
+		/// Gets the path of the updated device.
+		/// </summary>
+		public string DevicePath
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets a value indicating whether the device runs the new firmware.
+		/// </summary>
+		public bool Success
+		{
+			get
+			{
+				return Error == null;
+			}
+		}
+
+		/// <summary>
+		/// Gets the reason why the update failed. NULL if the update was successful.
+		/// </summary>
+		public string Error
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the status returned by the device if it refused a command; otherwise <see cref="FlashStatus.Ok"/>.
+		/// </summary>
+		public FlashStatus Status
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the number of pages of the image.
+		/// </summary>
+		public int Pages
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the number of pages which were not transferred because they already matched.
+		/// </summary>
+		public int PagesSkipped
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the number of pages transferred to the device.
+		/// </summary>
+		public int PagesWritten
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the number of page transfers which had to be repeated.
+		/// </summary>
+		public int Retries
+		{ get; internal set; }
+
+		/// <summary>
+		/// Gets the duration of the update, including the restart of the device.
+		/// </summary>
+		public TimeSpan Duration
+		{ get; internal set; }
+
+		/// <summary>
+		/// Initializes a new instance of the FirmwareUpdateResult class.
+		/// </summary>
+		/// <param name="devicePath">Path of the updated device.</param>
+		internal FirmwareUpdateResult(string devicePath)
+		{
+			this.DevicePath = devicePath;
+		}
+
+		/// <summary>
+		/// Marks the update as failed.
+		/// </summary>
+		/// <param name="error">Reason of the failure.</param>
+		/// <param name="status">Status returned by the device.</param>
+		/// <returns>This instance.</returns>
+		internal FirmwareUpdateResult Fail(string error, FlashStatus status = FlashStatus.Ok)
+		{
+			this.Error = error;
+			this.Status = status;
+
+			return this;
+		}
+
+		/// <summary>
+		/// Returns a summary of the update.
+		/// </summary>
+		/// <returns>A string which summarizes the update.</returns>
+		public override string ToString()
+		{
+			string result = string.Format("{0}: {1} pages, {2} skipped, {3} written, {4} retries, {5:0.0} s",
+				DevicePath, Pages, PagesSkipped, PagesWritten, Retries, Duration.TotalSeconds);
+
+			if (!Success)
+				result += string.Format(", failed: {0} ({1})", Error, Status);
+
+			return result;
+		}
+	}
+}
@@ -0,0 +1,234 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Updates the firmware of Blinky devices without the DFU bootloader. The image is transferred
+	/// page by page with CRC checked acknowledgements, pages which already match are skipped.
+	/// </summary>
+	/// <remarks>The update requires the LUFA DFU bootloader on the device, which provides the
+	/// functions for writing the flash to the firmware.</remarks>
+	public class FirmwareUpdater
+	{
+		/// <summary>
+		/// Number of attempts to transfer a single page.
+		/// </summary>
+		private const int writeAttempts = 3;
+
+		/// <summary>
+		/// Interval in milliseconds for checking if the device is available again after the restart.
+		/// </summary>
+		private const int restartPollInterval = 100;
+
+		readonly FirmwareImage image;
+
+		/// <summary>
+		/// Gets or sets the time to wait for the device after the new firmware was installed.
+		/// </summary>
+		public TimeSpan RestartTimeout { get; set; } = TimeSpan.FromSeconds(10);
+
+		/// <summary>
+		/// Initializes a new instance of the FirmwareUpdater class.
+		/// </summary>
+		/// <param name="image">The new firmware.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="image"/> was NULL.</exception>
+		public FirmwareUpdater(FirmwareImage image)
+		{
+			if (image == null)
+				throw new ArgumentNullException("image");
+
+			this.image = image;
+		}
+
+		/// <summary>
+		/// Updates all connected Blinky devices in parallel.
+		/// </summary>
+		/// <returns>The results of the updates.</returns>
+		public FirmwareUpdateResult[] UpdateAll()
+		{
+			return Update(Device.GetDevicePaths());
+		}
+
+		/// <summary>
+		/// Updates the specified Blinky devices in parallel.
+		/// </summary>
+		/// <param name="devicePaths">Paths of the devices.</param>
+		/// <returns>The results of the updates, in the same order as the paths.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="devicePaths"/> was NULL.</exception>
+		public FirmwareUpdateResult[] Update(IEnumerable<string> devicePaths)
+		{
+			if (devicePaths == null)
+				throw new ArgumentNullException("devicePaths");
+
+			Task<FirmwareUpdateResult>[] tasks = devicePaths.Select(path => Task.Run(() => update(path))).ToArray();
+
+			Task.WaitAll(tasks);
+
+			return tasks.Select(t => t.Result).ToArray();
+		}
+
+		/// <summary>
+		/// Connects to a device and updates it.
+		/// </summary>
+		/// <param name="devicePath">Path of the device.</param>
+		/// <returns>The result of the update.</returns>
+		private FirmwareUpdateResult update(string devicePath)
+		{
+			using (Device device = new Device())
+			{
+				if (!device.Connect(devicePath))
+					return new FirmwareUpdateResult(devicePath).Fail("Device not found.");
+
+				return Update(device);
+			}
+		}
+
+		/// <summary>
+		/// Updates a connected Blinky device. The device restarts with the new firmware, this
+		/// instance reconnects to it afterwards.
+		/// </summary>
+		/// <param name="device">The connected device.</param>
+		/// <returns>The result of the update.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="device"/> was NULL.</exception>
+		public FirmwareUpdateResult Update(Device device)
+		{
+			if (device == null)
+				throw new ArgumentNullException("device");
+
+			Stopwatch stopwatch = Stopwatch.StartNew();
+			FirmwareUpdateResult result = new FirmwareUpdateResult(device.DevicePath);
+
+			try
+			{
+				return update(device, result);
+			}
+			finally
+			{
+				result.Duration = stopwatch.Elapsed;
+			}
+		}
+
+		/// <summary>
+		/// Updates a connected Blinky device.
+		/// </summary>
+		/// <param name="device">The connected device.</param>
+		/// <param name="result">The result to be filled.</param>
+		/// <returns><paramref name="result"/></returns>
+		private FirmwareUpdateResult update(Device device, FirmwareUpdateResult result)
+		{
+			FlashInfo info = device.GetFlashInfo();
+
+			if (info == null)
+				return result.Fail("No answer from the device.");
+			if (info.Status != FlashStatus.Ok)
+				return result.Fail("The bootloader of the device doesn't support the update.", info.Status);
+
+			result.Pages = this.image.GetPageCount(info.PageSize, info.ReservedPage);
+
+			if (result.Pages > info.MaxPages)
+				return result.Fail("The image is too large.", FlashStatus.OutOfRange);
+
+			// The copier is never written, changing it requires the DFU bootloader.
+			for (int page = info.ReservedPage; this.image.IsPageUsed(page, info.PageSize); page++)
+			{
+				if (device.GetFlashPageCrc(page) != FirmwareImage.ComputeCrc(this.image.GetPage(page, info.PageSize)))
+					return result.Fail("The copier of the image differs, use the bootloader.", FlashStatus.OutOfRange);
+			}
+
+			List<int> pages = new List<int>();
+
+			for (int page = 0; page < result.Pages; page++)
+			{
+				// Pages in the staging area are overwritten during the transfer.
+				if (page < info.StagingBase)
+				{
+					ushort? crc = device.GetFlashPageCrc(page);
+
+					if (crc == null)
+						return result.Fail("No answer from the device.");
+
+					if (crc == FirmwareImage.ComputeCrc(this.image.GetPage(page, info.PageSize)))
+					{
+						result.PagesSkipped++;
+						continue;
+					}
+				}
+
+				pages.Add(page);
+			}
+
+			if (pages.Count == 0)
+				return result;
+
+			foreach (int page in pages)
+			{
+				FlashStatus? status = null;
+
+				for (int attempt = 0; attempt < writeAttempts && status != FlashStatus.Ok; attempt++)
+				{
+					if (attempt > 0)
+						result.Retries++;
+
+					status = device.WriteFlashPage(page, this.image.GetPage(page, info.PageSize));
+				}
+
+				if (status == null)
+					return result.Fail("No answer from the device.");
+				if (status != FlashStatus.Ok)
+					return result.Fail("The page " + page + " could not be written.", status.Value);
+
+				result.PagesWritten++;
+			}
+
+			// The device only answers if it refuses to install the image.
+			FlashStatus? commit = device.CommitFlash(result.Pages);
+
+			if (commit != null)
+				return result.Fail("The device refused to install the image.", commit.Value);
+
+			if (!reconnect(device, result.DevicePath))
+				return result.Fail("The device did not restart.");
+
+			for (int page = 0; page < result.Pages; page++)
+			{
+				if (device.GetFlashPageCrc(page) != FirmwareImage.ComputeCrc(this.image.GetPage(page, info.PageSize)))
+					return result.Fail("The page " + page + " doesn't match after the restart.", FlashStatus.VerifyFailed);
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Waits until the device is available again after the restart and reconnects to it.
+		/// </summary>
+		/// <param name="device">The device.</param>
+		/// <param name="devicePath">Path of the device.</param>
+		/// <returns>TRUE if the device is connected and answers.</returns>
+		private bool reconnect(Device device, string devicePath)
+		{
+			Stopwatch stopwatch = Stopwatch.StartNew();
+
+			device.Disconnect();
+
+			while (stopwatch.Elapsed < RestartTimeout)
+			{
+				Thread.Sleep(restartPollInterval);
+
+				if (!Device.IsPresent(devicePath) || !device.Connect(devicePath))
+					continue;
+
+				if (device.Ping())
+					return true;
+
+				device.Disconnect();
+			}
+
+			return false;
+		}
+	}
+}
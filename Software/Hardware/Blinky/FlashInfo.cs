@@ -0,0 +1,55 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the flash layout of the Blinky device relevant for a firmware update.
+	/// </summary>
+	internal class FlashInfo
+	{
+		/// <summary>
+		/// Gets the result of the command.
+		/// </summary>
+		public FlashStatus Status
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the size of a flash page in bytes.
+		/// </summary>
+		public int PageSize
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the first page of the staging area. This is the first page after the running firmware.
+		/// </summary>
+		public int StagingBase
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the maximum number of pages of a new firmware image.
+		/// </summary>
+		public int MaxPages
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the first page which is never written by a firmware update.
+		/// </summary>
+		public int ReservedPage
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the FlashInfo class.
+		/// </summary>
+		/// <param name="status">Result of the command.</param>
+		/// <param name="pageSize">Size of a flash page in bytes.</param>
+		/// <param name="stagingBase">First page of the staging area.</param>
+		/// <param name="maxPages">Maximum number of pages of a new firmware image.</param>
+		/// <param name="reservedPage">First page which is never written by a firmware update.</param>
+		public FlashInfo(FlashStatus status, int pageSize, int stagingBase, int maxPages, int reservedPage)
+		{
+			this.Status = status;
+			this.PageSize = pageSize;
+			this.StagingBase = stagingBase;
+			this.MaxPages = maxPages;
+			this.ReservedPage = reservedPage;
+		}
+	}
+}
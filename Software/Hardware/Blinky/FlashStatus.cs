@@ -0,0 +1,34 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Specifies the result of a flash command of the firmware update.
+	/// </summary>
+	/// <remarks>The values must be kept in sync with the FLASH_* status codes in the Blinky firmware.</remarks>
+	public enum FlashStatus : byte
+	{
+		/// <summary>
+		/// The command was successful.
+		/// </summary>
+		Ok = 0,
+		/// <summary>
+		/// The bootloader of the device doesn't support writing the flash from the firmware.
+		/// </summary>
+		Unsupported = 1,
+		/// <summary>
+		/// The page is outside of the area which can be updated.
+		/// </summary>
+		OutOfRange = 2,
+		/// <summary>
+		/// The data received by the device doesn't match the CRC.
+		/// </summary>
+		CrcMismatch = 3,
+		/// <summary>
+		/// The page written doesn't match the CRC.
+		/// </summary>
+		VerifyFailed = 4,
+		/// <summary>
+		/// The page or the image was not transferred completely.
+		/// </summary>
+		Incomplete = 5
+	}
+}
@@ -0,0 +1,115 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the distribution of a number of latency samples.
+	/// </summary>
+	public class LatencyDistribution
+	{
+		readonly TimeSpan[] samples;
+
+		/// <summary>
+		/// Gets the number of samples.
+		/// </summary>
+		public int Count
+		{
+			get
+			{
+				return this.samples.Length;
+			}
+		}
+
+		/// <summary>
+		/// Gets the smallest sample.
+		/// </summary>
+		public TimeSpan Minimum
+		{
+			get
+			{
+				return Percentile(0);
+			}
+		}
+
+		/// <summary>
+		/// Gets the largest sample.
+		/// </summary>
+		public TimeSpan Maximum
+		{
+			get
+			{
+				return Percentile(100);
+			}
+		}
+
+		/// <summary>
+		/// Gets the median of the samples.
+		/// </summary>
+		public TimeSpan Median
+		{
+			get
+			{
+				return Percentile(50);
+			}
+		}
+
+		/// <summary>
+		/// Gets the arithmetic mean of the samples.
+		/// </summary>
+		public TimeSpan Mean
+		{
+			get
+			{
+				if (Count == 0)
+					return TimeSpan.Zero;
+
+				return TimeSpan.FromTicks((long)this.samples.Average(x => x.Ticks));
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the LatencyDistribution class.
+		/// </summary>
+		/// <param name="samples">The latency samples.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="samples"/> was NULL.</exception>
+		public LatencyDistribution(IEnumerable<TimeSpan> samples)
+		{
+			if (samples == null)
+				throw new ArgumentNullException("samples");
+
+			this.samples = samples.OrderBy(x => x).ToArray();
+		}
+
+		/// <summary>
+		/// Returns the sample below which the specified percentage of the samples falls
+		/// (nearest-rank method).
+		/// </summary>
+		/// <param name="percent">Percentage between 0 and 100.</param>
+		/// <returns>The percentile or <see cref="TimeSpan.Zero"/> if there are no samples.</returns>
+		public TimeSpan Percentile(double percent)
+		{
+			if (percent < 0 || percent > 100)
+				throw new ArgumentOutOfRangeException("percent");
+
+			if (Count == 0)
+				return TimeSpan.Zero;
+
+			int rank = (int)Math.Ceiling(percent / 100 * Count);
+
+			return this.samples[Math.Max(rank, 1) - 1];
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current instance.
+		/// </summary>
+		/// <returns>Minimum, median, 90th and 99th percentile and maximum in milliseconds.</returns>
+		public override string ToString()
+		{
+			return String.Format("min {0:0.000} / median {1:0.000} / p90 {2:0.000} / p99 {3:0.000} / max {4:0.000} ms",
+				Minimum.TotalMilliseconds, Median.TotalMilliseconds, Percentile(90).TotalMilliseconds,
+				Percentile(99).TotalMilliseconds, Maximum.TotalMilliseconds);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Measures the latency of the communication with a Blinky device by sending echo requests.
+	/// </summary>
+	public class LatencyProfiler
+	{
+		readonly Device device;
+
+		/// <summary>
+		/// Initializes a new instance of the LatencyProfiler class.
+		/// </summary>
+		/// <param name="device">The connected device to be profiled.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="device"/> was NULL.</exception>
+		public LatencyProfiler(Device device)
+		{
+			if (device == null)
+				throw new ArgumentNullException("device");
+
+			this.device = device;
+		}
+
+		/// <summary>
+		/// Sends the specified number of echo requests to the device, one after another.
+		/// </summary>
+		/// <param name="count">Number of echo requests.</param>
+		/// <returns>The latency distribution of the echo requests.</returns>
+		/// <exception cref="ArgumentOutOfRangeException">The parameter <paramref name="count"/> was not positive.</exception>
+		public LatencyReport Run(int count)
+		{
+			if (count <= 0)
+				throw new ArgumentOutOfRangeException("count");
+
+			List<EchoResult> results = new List<EchoResult>(count);
+			int timeouts = 0;
+
+			for (int a = 0; a < count; a++)
+			{
+				EchoResult result = this.device.Echo();
+
+				if (result == null)
+					timeouts++;
+				else
+					results.Add(result);
+			}
+
+			return new LatencyReport(results, timeouts);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the result of a run of the <see cref="LatencyProfiler"/>.
+	/// </summary>
+	public class LatencyReport
+	{
+		/// <summary>
+		/// Gets the number of echo requests without an answer within the timeout.
+		/// </summary>
+		public int Timeouts
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the distribution of the time between sending an echo request and receiving the answer.
+		/// </summary>
+		public LatencyDistribution RoundTrip
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the distribution of the time the device needed for processing an echo request.
+		/// </summary>
+		public LatencyDistribution DeviceProcessing
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the LatencyReport class.
+		/// </summary>
+		/// <param name="results">The answers to the echo requests.</param>
+		/// <param name="timeouts">The number of echo requests without an answer.</param>
+		internal LatencyReport(ICollection<EchoResult> results, int timeouts)
+		{
+			this.Timeouts = timeouts;
+			this.RoundTrip = new LatencyDistribution(results.Select(x => x.RoundTrip));
+			this.DeviceProcessing = new LatencyDistribution(results.Select(x => x.DeviceProcessing));
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current instance.
+		/// </summary>
+		public override string ToString()
+		{
+			return String.Format("{0} samples, {1} timeouts{2}Round trip: {3}{2}Device:     {4}",
+				RoundTrip.Count, Timeouts, Environment.NewLine, RoundTrip, DeviceProcessing);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the RAM usage of the Blinky device.
+	/// </summary>
+	public class MemoryUsage
+	{
+		/// <summary>
+		/// Gets the number of bytes used by static variables.
+		/// </summary>
+		public int StaticBytes
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of bytes available for the stack.
+		/// </summary>
+		public int StackBytes
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of bytes of the stack which were never used since the device was reset.
+		/// </summary>
+		public int StackUnusedBytes
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the maximum number of bytes of the stack used since the device was reset.
+		/// </summary>
+		public int StackHighWaterMark
+		{
+			get
+			{
+				return StackBytes - StackUnusedBytes;
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the MemoryUsage class.
+		/// </summary>
+		/// <param name="staticBytes">Bytes used by static variables.</param>
+		/// <param name="stackBytes">Bytes available for the stack.</param>
+		/// <param name="stackUnusedBytes">Bytes of the stack which were never used.</param>
+		internal MemoryUsage(int staticBytes, int stackBytes, int stackUnusedBytes)
+		{
+			this.StaticBytes = staticBytes;
+			this.StackBytes = stackBytes;
+			this.StackUnusedBytes = stackUnusedBytes;
+		}
+	}
+}
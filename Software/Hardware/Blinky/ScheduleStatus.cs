@@ -0,0 +1,22 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Specifies the result of a scheduled trigger.
+	/// </summary>
+	/// <remarks>The values must be kept in sync with the SCHEDULE_* status codes in the Blinky firmware.</remarks>
+	public enum ScheduleStatus : byte
+	{
+		/// <summary>
+		/// The device triggers at the requested time.
+		/// </summary>
+		Ok = 0,
+		/// <summary>
+		/// The requested time had already passed, the device triggered at once.
+		/// </summary>
+		Late = 1,
+		/// <summary>
+		/// The requested time is too far in the future, the device didn't trigger.
+		/// </summary>
+		OutOfRange = 2
+	}
+}
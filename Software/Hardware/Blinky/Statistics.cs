@@ -0,0 +1,102 @@
+﻿using System;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents the statistics counters of the Blinky device. The counters are reset when the
+	/// device is reset.
+	/// </summary>
+	public class Statistics
+	{
+		/// <summary>
+		/// Number of counters provided by the device.
+		/// </summary>
+		/// <remarks>This value must be kept in sync with STATS_Count in the Blinky firmware.</remarks>
+		internal const int CounterCount = 8;
+
+		/// <summary>
+		/// Clock frequency of the device in Hz. The interrupt duration is measured in clock cycles.
+		/// </summary>
+		const double CpuFrequency = 16000000;
+
+		/// <summary>
+		/// Gets the number of reports processed by the device.
+		/// </summary>
+		public uint ReportsProcessed
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of reports containing an unknown command.
+		/// </summary>
+		public uint UnknownCommands
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of USB bus resets.
+		/// </summary>
+		public uint UsbResets
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of USB suspends.
+		/// </summary>
+		public uint UsbSuspends
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the longest duration of the blinker interrupt in timer ticks (CPU clock cycles).
+		/// </summary>
+		public uint MaxInterruptTicks
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the longest duration of the blinker interrupt.
+		/// </summary>
+		public TimeSpan MaxInterruptDuration
+		{
+			get
+			{
+				return TimeSpan.FromTicks((long)(MaxInterruptTicks / CpuFrequency * TimeSpan.TicksPerSecond));
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of main loop iterations of the device during the last second.
+		/// </summary>
+		public uint MainLoopIterationsPerSecond
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the time since the device was powered on or reset.
+		/// </summary>
+		public TimeSpan Uptime
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of writes to the EEPROM of the device.
+		/// </summary>
+		public uint EepromWrites
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the Statistics class.
+		/// </summary>
+		/// <param name="counters">The counter values in the order used by the firmware.</param>
+		internal Statistics(uint[] counters)
+		{
+			if (counters == null)
+				throw new ArgumentNullException("counters");
+			if (counters.Length != CounterCount)
+				throw new ArgumentException("Invalid number of counters.", "counters");
+
+			this.ReportsProcessed = counters[0];
+			this.UnknownCommands = counters[1];
+			this.UsbResets = counters[2];
+			this.UsbSuspends = counters[3];
+			this.MaxInterruptTicks = counters[4];
+			this.MainLoopIterationsPerSecond = counters[5];
+			this.Uptime = TimeSpan.FromSeconds(counters[6]);
+			this.EepromWrites = counters[7];
+		}
+	}
+}
@@ -0,0 +1,93 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents a HID trace written by a <see cref="TraceRecorder"/>.
+	/// </summary>
+	public class TraceFile
+	{
+		/// <summary>
+		/// Gets the time in UTC when the recording was started.
+		/// </summary>
+		public DateTime Started
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of records which were dropped because the file was full.
+		/// </summary>
+		public long Dropped
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the records in the order they were recorded.
+		/// </summary>
+		public IList<TraceRecord> Records
+		{ get; private set; }
+
+		private TraceFile(DateTime started, long dropped, IList<TraceRecord> records)
+		{
+			this.Started = started;
+			this.Dropped = dropped;
+			this.Records = records;
+		}
+
+		/// <summary>
+		/// Reads a trace file.
+		/// </summary>
+		/// <param name="path">Path of the trace file.</param>
+		/// <returns>The trace.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="path"/> was NULL.</exception>
+		/// <exception cref="FormatException">The file is not a trace file or has an unknown version.</exception>
+		/// <exception cref="IOException">The file could not be read.</exception>
+		public static TraceFile Load(string path)
+		{
+			if (path == null)
+				throw new ArgumentNullException("path");
+
+			// Share the file, so a trace which is still recorded can be read.
+			using (FileStream stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite))
+			using (BinaryReader reader = new BinaryReader(stream))
+			{
+				if (stream.Length < TraceRecorder.HeaderSize || reader.ReadUInt32() != TraceRecorder.Magic)
+					throw new FormatException("Not a trace file.");
+				if (reader.ReadUInt16() != TraceRecorder.Version || reader.ReadUInt16() != TraceRecorder.RecordSize)
+					throw new FormatException("Unsupported trace version.");
+
+				long frequency = reader.ReadInt64();
+				DateTime started = new DateTime(reader.ReadInt64(), DateTimeKind.Utc);
+				long dropped = reader.ReadInt64();
+
+				if (frequency <= 0)
+					throw new FormatException("Invalid timer frequency.");
+
+				List<TraceRecord> records = new List<TraceRecord>((int)((stream.Length - TraceRecorder.HeaderSize) / TraceRecorder.RecordSize));
+
+				while (stream.Length - stream.Position >= TraceRecorder.RecordSize)
+				{
+					long header = reader.ReadInt64();
+					byte[] report = reader.ReadBytes(8);
+
+					// The first empty record ends a trace which wasn't closed.
+					if (header == 0)
+						break;
+
+					TraceKind kind = (TraceKind)(header & 0xFF);
+					long ticks = header >> 8;
+
+					if (kind < TraceKind.Sent || kind > TraceKind.Timeout)
+						throw new FormatException("Invalid record at offset " + (stream.Position - TraceRecorder.RecordSize));
+
+					// Convert from Stopwatch ticks without losing precision for long traces.
+					TimeSpan time = TimeSpan.FromTicks(ticks / frequency * TimeSpan.TicksPerSecond + ticks % frequency * TimeSpan.TicksPerSecond / frequency);
+
+					records.Add(new TraceRecord(kind, time, report));
+				}
+
+				return new TraceFile(started, dropped, records);
+			}
+		}
+	}
+}
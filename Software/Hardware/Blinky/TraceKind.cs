@@ -0,0 +1,22 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Specifies the kind of a record of a HID trace.
+	/// </summary>
+	/// <remarks>The values are stored in trace files and must not be changed.</remarks>
+	public enum TraceKind : byte
+	{
+		/// <summary>
+		/// A report was sent to the device.
+		/// </summary>
+		Sent = 1,
+		/// <summary>
+		/// A report was received from the device. Reports with a sync byte of an earlier command are recorded, too.
+		/// </summary>
+		Received = 2,
+		/// <summary>
+		/// No answer was received from the device within the timeout.
+		/// </summary>
+		Timeout = 3
+	}
+}
@@ -0,0 +1,49 @@
+﻿using System;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Represents a single record of a HID trace.
+	/// </summary>
+	public class TraceRecord
+	{
+		/// <summary>
+		/// Gets the kind of the record.
+		/// </summary>
+		public TraceKind Kind
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the time of the record since the recording was started.
+		/// </summary>
+		public TimeSpan Time
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the report which was sent or received. A timeout contains the report which wasn't answered.
+		/// </summary>
+		public byte[] Report
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the sync byte of the report.
+		/// </summary>
+		public byte SyncByte => this.Report[7];
+
+		internal TraceRecord(TraceKind kind, TimeSpan time, byte[] report)
+		{
+			this.Kind = kind;
+			this.Time = time;
+			this.Report = report;
+		}
+
+		/// <summary>
+		/// Returns the record as readable text.
+		/// </summary>
+		/// <returns>The time, kind and the bytes of the report.</returns>
+		public override string ToString()
+		{
+			return String.Format("{0,12:F3} ms {1,-8} {2}", this.Time.TotalMilliseconds, this.Kind, BitConverter.ToString(this.Report).Replace('-', ' '));
+		}
+	}
+}
@@ -0,0 +1,180 @@
+﻿using System;
+using System.Diagnostics;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Threading;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Records the HID reports exchanged with a Blinky device into a trace file, which can be read
+	/// with <see cref="TraceFile"/>.
+	/// </summary>
+	/// <remarks>
+	/// <para>The file is memory-mapped with a fixed capacity and only appended to, so recording a
+	/// report is a few stores without a system call or an allocation. Records which don't fit anymore
+	/// are counted as <see cref="Dropped"/>. The file is truncated to the recorded records when the
+	/// recorder is disposed; a file which wasn't closed ends at the first empty record.</para>
+	/// <para>The file starts with a header of 32 bytes: the magic "BLTR", the format version (16 bit),
+	/// the size of a record (16 bit), the <see cref="Stopwatch.Frequency"/>, the start time in UTC
+	/// ticks and the number of dropped records, all little endian. Each record has 16 bytes: the
+	/// <see cref="Stopwatch"/> ticks since the start shifted left by 8 bits and the
+	/// <see cref="TraceKind"/> in the lowest byte, followed by the report.</para>
+	/// <para>Assign an instance to <see cref="Device.Recorder"/> of one device only; the records
+	/// don't identify the device.</para>
+	/// </remarks>
+	public unsafe class TraceRecorder : IDisposable
+	{
+		/// <summary>
+		/// Default capacity in records, which is 16 MB.
+		/// </summary>
+		public const int DefaultCapacity = 1024 * 1024;
+
+		internal const uint Magic = 0x52544C42;
+		internal const ushort Version = 1;
+		internal const int HeaderSize = 32;
+		internal const int RecordSize = 16;
+		internal const int DroppedOffset = 24;
+
+		readonly string path;
+		readonly int capacity;
+		readonly long start;
+		MemoryMappedFile file;
+		MemoryMappedViewAccessor view;
+		byte* records;
+		int next;
+		long dropped;
+		// Number of threads in Record, the view is only unmapped when it's zero.
+		int writers;
+		int disposed;
+
+		/// <summary>
+		/// Gets the number of records which were written.
+		/// </summary>
+		public int Count => Math.Min(Volatile.Read(ref this.next), this.capacity);
+
+		/// <summary>
+		/// Gets the number of records which were dropped because the file was full.
+		/// </summary>
+		public long Dropped => Interlocked.Read(ref this.dropped);
+
+		/// <summary>
+		/// Creates a trace file, an existing file is overwritten.
+		/// </summary>
+		/// <param name="path">Path of the trace file.</param>
+		/// <param name="capacity">Maximum number of records.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="path"/> was NULL.</exception>
+		/// <exception cref="ArgumentOutOfRangeException">The capacity is not positive.</exception>
+		/// <exception cref="IOException">The file could not be created.</exception>
+		public TraceRecorder(string path, int capacity = DefaultCapacity)
+		{
+			if (path == null)
+				throw new ArgumentNullException("path");
+			if (capacity <= 0)
+				throw new ArgumentOutOfRangeException("capacity");
+
+			this.path = path;
+			this.capacity = capacity;
+
+			// A new file is filled with zeros, so unused records end the trace.
+			this.file = MemoryMappedFile.CreateFromFile(path, FileMode.Create, null, HeaderSize + (long)capacity * RecordSize);
+			this.view = this.file.CreateViewAccessor();
+
+			byte* pointer = null;
+			this.view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+			pointer += this.view.PointerOffset;
+
+			this.start = Stopwatch.GetTimestamp();
+
+			*(uint*)pointer = Magic;
+			*(ushort*)(pointer + 4) = Version;
+			*(ushort*)(pointer + 6) = RecordSize;
+			*(long*)(pointer + 8) = Stopwatch.Frequency;
+			*(long*)(pointer + 16) = DateTime.UtcNow.Ticks;
+
+			this.records = pointer + HeaderSize;
+		}
+
+		/// <summary>
+		/// Appends a record to the trace.
+		/// </summary>
+		/// <param name="kind">Kind of the record.</param>
+		/// <param name="report">The report of 8 bytes.</param>
+		/// <param name="timestamp"><see cref="Stopwatch"/> timestamp of the record.</param>
+		internal void Record(TraceKind kind, byte[] report, long timestamp)
+		{
+			// Announce the write before checking for Dispose, which sets the flag before waiting
+			// for the writers; both are full fences, so either side sees the other.
+			Interlocked.Increment(ref this.writers);
+
+			try
+			{
+				if (Volatile.Read(ref this.disposed) != 0)
+				{
+					Interlocked.Increment(ref this.dropped);
+					return;
+				}
+
+				int index = Interlocked.Increment(ref this.next) - 1;
+
+				if (index >= this.capacity)
+				{
+					Interlocked.Increment(ref this.dropped);
+					return;
+				}
+
+				byte* record = this.records + (long)index * RecordSize;
+
+				// The first word is written last, so a reader of a file which is still recorded
+				// never sees a record without its report.
+				*(ulong*)(record + 8) = BitConverter.ToUInt64(report, 0);
+				Volatile.Write(ref *(long*)record, ((timestamp - this.start) << 8) | (long)kind);
+			}
+			finally
+			{
+				Interlocked.Decrement(ref this.writers);
+			}
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			if (Interlocked.Exchange(ref this.disposed, 1) == 0)
+			{
+				if (disposing)
+				{
+					// New records are dropped now, wait for the ones being written.
+					SpinWait spin = new SpinWait();
+					while (Volatile.Read(ref this.writers) != 0)
+						spin.SpinOnce();
+
+					*(long*)(this.records - HeaderSize + DroppedOffset) = Dropped;
+
+					this.view.SafeMemoryMappedViewHandle.ReleasePointer();
+					this.records = null;
+					this.view.Dispose();
+					this.file.Dispose();
+
+					// Cut the unused records.
+					using (FileStream stream = new FileStream(this.path, FileMode.Open, FileAccess.Write))
+						stream.SetLength(HeaderSize + (long)Count * RecordSize);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Finishes the trace and closes the file.
+		/// </summary>
+		/// <remarks>Waits for records being written; records of a device which still communicates
+		/// are counted as <see cref="Dropped"/> afterwards.</remarks>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
@@ -0,0 +1,25 @@
+﻿namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Specifies what the <see cref="TriggerScheduler"/> did with a trigger.
+	/// </summary>
+	public enum TriggerResult
+	{
+		/// <summary>
+		/// The Trigger command was sent to the device.
+		/// </summary>
+		Sent,
+		/// <summary>
+		/// The trigger was covered by the previous Trigger command, so nothing was sent.
+		/// </summary>
+		Coalesced,
+		/// <summary>
+		/// The Trigger command will be sent later due to the report rate ceiling.
+		/// </summary>
+		Deferred,
+		/// <summary>
+		/// Sending the Trigger command failed.
+		/// </summary>
+		Failed
+	}
+}
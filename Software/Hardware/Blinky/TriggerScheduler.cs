@@ -0,0 +1,364 @@
+﻿using System;
+using System.Diagnostics;
+using System.Threading;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Combines triggers of a Blinky device arriving in quick succession into a single Trigger command.
+	/// </summary>
+	/// <remarks>
+	/// Every Trigger command restarts the blink algorithm of the device, so repeated messages would
+	/// reset the blink phase and the timeout. A trigger whose options are already covered by the
+	/// previous Trigger command inside the coalescing window is dropped. The window starts when a
+	/// Trigger command is sent, so a steady stream of messages still restarts the timeout of the
+	/// device once per window. A trigger adding options is merged with the previous options and
+	/// sent, but not before the minimum interval since the last report has elapsed.
+	/// </remarks>
+	public class TriggerScheduler : IDisposable
+	{
+		readonly Device device;
+		readonly object lockObject;
+		readonly Timer timer;
+		bool disposed;
+
+		// Options and profile sent with the last Trigger command and end of its coalescing window.
+		TriggerOptions activeFlags;
+		int activeProfile;
+		long windowEnd;
+		// Options and profile of the Trigger command waiting for the rate ceiling and the state of the
+		// trigger which caused it.
+		TriggerOptions pendingFlags;
+		int pendingProfile;
+		uint? pendingAt;
+		object pendingState;
+		bool pending;
+		long lastSent;
+
+		/// <summary>
+		/// Gets or sets the time after a Trigger command in which identical triggers are coalesced.
+		/// Coalesced triggers don't extend the window. Defaults to two seconds.
+		/// </summary>
+		public TimeSpan CoalescingWindow
+		{ get; set; } = TimeSpan.FromSeconds(2);
+
+		/// <summary>
+		/// Gets or sets the minimum time between two reports sent to the device. Defaults to 100 ms.
+		/// </summary>
+		public TimeSpan MinimumInterval
+		{ get; set; } = TimeSpan.FromMilliseconds(100);
+
+		/// <summary>
+		/// Gets the number of triggers requested.
+		/// </summary>
+		public int Requested
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of Trigger commands sent to the device.
+		/// </summary>
+		public int Sent
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of Trigger commands which could not be sent.
+		/// </summary>
+		public int Failed
+		{ get; private set; }
+
+		/// <summary>
+		/// Occurs when a Trigger command was sent successfully, also if it was deferred. The event is
+		/// raised on the thread which sent the command.
+		/// </summary>
+		public event EventHandler<TriggerSentEventArgs> TriggerSent;
+
+		/// <summary>
+		/// Initializes a new instance of the TriggerScheduler class.
+		/// </summary>
+		/// <param name="device">The connected device to be triggered.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="device"/> was NULL.</exception>
+		public TriggerScheduler(Device device)
+		{
+			if (device == null)
+				throw new ArgumentNullException("device");
+
+			this.device = device;
+			this.lockObject = new object();
+			this.timer = new Timer(state => sendPending());
+		}
+
+		/// <summary>
+		/// Converts a time span into <see cref="Stopwatch"/> ticks.
+		/// </summary>
+		private static long toTicks(TimeSpan value)
+		{
+			return (long)(value.TotalSeconds * Stopwatch.Frequency);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device.
+		/// </summary>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult Trigger(TriggerOptions flags = Device.DefaultTriggerOptions)
+		{
+			return request(flags, 0, null, null);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device.
+		/// </summary>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="state">Object passed to <see cref="TriggerSent"/> if this trigger causes a Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult Trigger(TriggerOptions flags, object state)
+		{
+			return request(flags, 0, null, state);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device with the settings of a profile slot. A trigger
+		/// selecting another profile than the previous Trigger command isn't coalesced with it; of the
+		/// triggers combined into a deferred command, the last one selects the profile.
+		/// </summary>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="profile">The profile slot, starting at 1. Zero keeps the current settings.</param>
+		/// <param name="state">Object passed to <see cref="TriggerSent"/> if this trigger causes a Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 0 and 255.</exception>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult Trigger(TriggerOptions flags, int profile, object state)
+		{
+			if (profile < 0 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			return request(flags, profile, null, state);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device at a time of the device clock. It is coalesced like
+		/// <see cref="Trigger"/>; a deferred command still triggers at the requested time.
+		/// </summary>
+		/// <param name="deviceTime">Time of the device clock in microseconds, see <see cref="DeviceClock"/>.</param>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult TriggerAt(uint deviceTime, TriggerOptions flags = Device.DefaultTriggerOptions)
+		{
+			return request(flags, 0, deviceTime, null);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device at a time of the device clock, see <see cref="TriggerAt(uint, TriggerOptions)"/>.
+		/// </summary>
+		/// <param name="deviceTime">Time of the device clock in microseconds, see <see cref="DeviceClock"/>.</param>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="state">Object passed to <see cref="TriggerSent"/> if this trigger causes a Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult TriggerAt(uint deviceTime, TriggerOptions flags, object state)
+		{
+			return request(flags, 0, deviceTime, state);
+		}
+
+		/// <summary>
+		/// Requests the blink algorithm of the device with the settings of a profile slot at a time of the
+		/// device clock, see <see cref="TriggerAt(uint, TriggerOptions)"/> and <see cref="Trigger(TriggerOptions, int, object)"/>.
+		/// </summary>
+		/// <param name="deviceTime">Time of the device clock in microseconds, see <see cref="DeviceClock"/>.</param>
+		/// <param name="flags">Options to be used by the Trigger command.</param>
+		/// <param name="profile">The profile slot, starting at 1. Zero keeps the current settings.</param>
+		/// <param name="state">Object passed to <see cref="TriggerSent"/> if this trigger causes a Trigger command.</param>
+		/// <returns>What was done with the trigger.</returns>
+		/// <exception cref="ArgumentOutOfRangeException">The profile is not between 0 and 255.</exception>
+		/// <exception cref="ObjectDisposedException">Thrown when the object is already disposed.</exception>
+		public TriggerResult TriggerAt(uint deviceTime, TriggerOptions flags, int profile, object state)
+		{
+			if (profile < 0 || profile > byte.MaxValue)
+				throw new ArgumentOutOfRangeException("profile");
+
+			return request(flags, profile, deviceTime, state);
+		}
+
+		private TriggerResult request(TriggerOptions flags, int profile, uint? deviceTime, object state)
+		{
+			TriggerResult result;
+			TriggerSentEventArgs sent = null;
+
+			lock (this.lockObject)
+			{
+				if (this.disposed)
+					throw new ObjectDisposedException(GetType().FullName);
+
+				long now = Stopwatch.GetTimestamp();
+				bool inWindow = now < this.windowEnd;
+
+				this.Requested++;
+
+				if (inWindow && (flags & ~this.activeFlags) == 0 && profile == this.activeProfile)
+					return TriggerResult.Coalesced;
+
+				// Keep the options of the running blink algorithm, so it isn't weakened by the new trigger.
+				this.pendingFlags |= flags | (inWindow ? this.activeFlags : TriggerOptions.None);
+				this.pendingProfile = profile;
+
+				if (this.pending)
+					return TriggerResult.Coalesced;
+
+				this.pendingAt = deviceTime;
+				this.pendingState = state;
+				this.pending = true;
+
+				long due = this.lastSent + toTicks(MinimumInterval) - now;
+
+				if (this.Sent > 0 && due > 0)
+				{
+					this.timer.Change(due * 1000 / Stopwatch.Frequency + 1, Timeout.Infinite);
+
+					return TriggerResult.Deferred;
+				}
+
+				result = send(false, out sent) ? TriggerResult.Sent : TriggerResult.Failed;
+			}
+
+			if (sent != null)
+				OnTriggerSent(sent);
+
+			return result;
+		}
+
+		/// <summary>
+		/// Forgets the previous Trigger command, so the next trigger is sent in any case. Call this
+		/// method after the blink algorithm was turned off by other means.
+		/// </summary>
+		public void Reset()
+		{
+			lock (this.lockObject)
+			{
+				this.windowEnd = 0;
+				this.activeFlags = TriggerOptions.None;
+				this.activeProfile = 0;
+			}
+		}
+
+		/// <summary>
+		/// Sends the pending Trigger command. Must be called with the lock held.
+		/// </summary>
+		/// <param name="deferred">TRUE if the command was deferred.</param>
+		/// <param name="sent">Receives the data for <see cref="TriggerSent"/> on success, which has to
+		/// be raised after releasing the lock.</param>
+		/// <returns>TRUE on success.</returns>
+		private bool send(bool deferred, out TriggerSentEventArgs sent)
+		{
+			bool result = false;
+			TriggerOptions flags = this.pendingFlags;
+			int profile = this.pendingProfile;
+			uint? at = this.pendingAt;
+			object state = this.pendingState;
+
+			sent = null;
+			this.pending = false;
+			this.pendingFlags = TriggerOptions.None;
+			this.pendingProfile = 0;
+			this.pendingAt = null;
+			this.pendingState = null;
+			this.lastSent = Stopwatch.GetTimestamp();
+
+			try
+			{
+				// A time the device can't schedule is triggered at once.
+				if (at.HasValue && this.device.Supports(Command.ScheduleTrigger))
+				{
+					ScheduleStatus? status = this.device.ScheduleTrigger(at.Value, flags, profile);
+
+					result = status == ScheduleStatus.OutOfRange ? trigger(flags, profile) : status.HasValue;
+				}
+				else
+					result = trigger(flags, profile);
+			}
+			catch (InvalidOperationException)
+			{
+				// The device was disconnected or disposed meanwhile.
+			}
+
+			if (result)
+			{
+				this.Sent++;
+				this.activeFlags = flags;
+				this.activeProfile = profile;
+				this.windowEnd = this.lastSent + toTicks(CoalescingWindow);
+				sent = new TriggerSentEventArgs(state, Stopwatch.GetTimestamp(), deferred);
+			}
+			else
+			{
+				// Don't coalesce the next trigger with one that never reached the device.
+				this.Failed++;
+				this.windowEnd = 0;
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Sends the Trigger command, with the profile slot only if one is selected.
+		/// </summary>
+		private bool trigger(TriggerOptions flags, int profile)
+		{
+			return profile != 0 ? this.device.Trigger(flags, profile) : this.device.Trigger(flags);
+		}
+
+		private void sendPending()
+		{
+			TriggerSentEventArgs sent = null;
+
+			lock (this.lockObject)
+			{
+				if (this.pending && !this.disposed)
+					send(true, out sent);
+			}
+
+			if (sent != null)
+				OnTriggerSent(sent);
+		}
+
+		/// <summary>
+		/// Raises the <see cref="TriggerSent"/> event.
+		/// </summary>
+		/// <param name="e">The event data.</param>
+		protected virtual void OnTriggerSent(TriggerSentEventArgs e)
+		{
+			if (TriggerSent != null)
+				TriggerSent(this, e);
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance. A deferred Trigger command is discarded.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			lock (this.lockObject)
+			{
+				if (!disposed)
+				{
+					if (disposing)
+						this.timer.Dispose();
+
+					disposed = true;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
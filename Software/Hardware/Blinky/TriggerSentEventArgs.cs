@@ -0,0 +1,42 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace BISS.Hardware.Blinky
+{
+	/// <summary>
+	/// Provides data for the <see cref="TriggerScheduler.TriggerSent"/> event.
+	/// </summary>
+	public class TriggerSentEventArgs : EventArgs
+	{
+		/// <summary>
+		/// Gets the object passed with the trigger which caused the Trigger command.
+		/// </summary>
+		public object State
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the Trigger command was sent.
+		/// </summary>
+		public long SentTimestamp
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets a value indicating whether the Trigger command was deferred due to the report rate ceiling.
+		/// </summary>
+		public bool Deferred
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="TriggerSentEventArgs"/> class.
+		/// </summary>
+		/// <param name="state">Object passed with the trigger.</param>
+		/// <param name="sentTimestamp"><see cref="Stopwatch"/> timestamp when the command was sent.</param>
+		/// <param name="deferred">TRUE if the command was deferred.</param>
+		public TriggerSentEventArgs(object state, long sentTimestamp, bool deferred)
+		{
+			this.State = state;
+			this.SentTimestamp = sentTimestamp;
+			this.Deferred = deferred;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+﻿using System;
+using System.IO;
+using System.Net.Sockets;
+using System.Threading;
+using BISS.Networking;
+
+namespace BISS.Hub
+{
+	/// <summary>
+	/// Runs the receive hub, which receives the BISS packets once for all local subscribers.
+	/// </summary>
+	/// <remarks>
+	/// Command line: Hub [-path socket] [-keyfile file]
+	/// </remarks>
+	static class Program
+	{
+		static readonly ManualResetEvent exit = new ManualResetEvent(false);
+
+		/// <summary>
+		/// Der Haupteinstiegspunkt für die Anwendung.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			string path = null;
+			string keyPath = null;
+			PacketAuthenticator authenticator = null;
+
+			for (int a = 0; a < args.Length; a++)
+			{
+				if (args[a] == "-path" && a + 1 < args.Length)
+					path = args[++a];
+				else if (args[a] == "-keyfile" && a + 1 < args.Length)
+					keyPath = args[++a];
+				else
+				{
+					Console.Error.WriteLine("Usage: Hub [-path socket] [-keyfile file]");
+					return 1;
+				}
+			}
+
+			try
+			{
+				if (keyPath != null)
+					authenticator = PacketAuthenticator.FromKeyFile(keyPath);
+			}
+			catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException || ex is FormatException || ex is ArgumentException)
+			{
+				Console.Error.WriteLine("Invalid key file: {0}", ex.Message);
+				return 1;
+			}
+
+			Console.CancelKeyPress += (sender, e) =>
+			{
+				e.Cancel = true;
+				exit.Set();
+			};
+
+			using (ReceiveHub hub = new ReceiveHub(path))
+			{
+				hub.Authenticator = authenticator;
+				hub.SubscribersChanged += (sender, e) => Console.WriteLine("{0} subscribers", hub.SubscriberCount);
+
+				try
+				{
+					hub.Start();
+				}
+				catch (Exception ex) when (ex is InvalidOperationException || ex is SocketException || ex is IOException)
+				{
+					Console.Error.WriteLine("Hub could not be started: {0}", ex.Message);
+					return 1;
+				}
+
+				Console.WriteLine("Hub listening on {0}. Press Ctrl+C to exit.", path ?? ReceiveHub.DefaultPath);
+				exit.WaitOne();
+
+				Console.WriteLine("{0} packets dropped for slow subscribers.", hub.Dropped);
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,205 @@
+﻿using System;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Net.Sockets;
+using System.Text;
+using System.Threading;
+using BISS.Networking;
+
+namespace BISS.Listener
+{
+	/// <summary>
+	/// Headless listener, which writes every received BISS message as a line of JSON to stdout and
+	/// optionally runs a program for it. Meant to be published as a native AOT binary, so it starts
+	/// fast and needs little memory on small hosts.
+	/// </summary>
+	/// <remarks>
+	/// Command line: Listener [-text] [-exec program] [-keyfile file] [-path socket] [-direct] [-startup]
+	/// <para>
+	/// The program of <c>-exec</c> gets the message type as argument and the environment variables
+	/// BISS_MESSAGE_TYPE, BISS_PACKET_ID and BISS_FIRE_AT. <c>-startup</c> exits as soon as the
+	/// listener is ready to receive and prints the startup time and the resident memory to stderr.
+	/// </para>
+	/// </remarks>
+	static class Program
+	{
+		static readonly ManualResetEvent exit = new ManualResetEvent(false);
+		static readonly object outputLock = new object();
+
+		static HubReceiver receiver;
+		static bool text;
+		static string execPath;
+
+		/// <summary>
+		/// Der Haupteinstiegspunkt für die Anwendung.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			string keyPath = null;
+			string hubPath = null;
+			bool direct = false;
+			bool startup = false;
+			PacketAuthenticator authenticator = null;
+
+			for (int a = 0; a < args.Length; a++)
+			{
+				if (args[a] == "-text")
+					text = true;
+				else if (args[a] == "-exec" && a + 1 < args.Length)
+					execPath = args[++a];
+				else if (args[a] == "-keyfile" && a + 1 < args.Length)
+					keyPath = args[++a];
+				else if (args[a] == "-path" && a + 1 < args.Length)
+					hubPath = args[++a];
+				else if (args[a] == "-direct")
+					direct = true;
+				else if (args[a] == "-startup")
+					startup = true;
+				else
+				{
+					Console.Error.WriteLine("Usage: Listener [-text] [-exec program] [-keyfile file] [-path socket] [-direct] [-startup]");
+					return 1;
+				}
+			}
+
+			try
+			{
+				if (keyPath != null)
+					authenticator = PacketAuthenticator.FromKeyFile(keyPath);
+			}
+			catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException || ex is FormatException || ex is ArgumentException)
+			{
+				Console.Error.WriteLine("Invalid key file: {0}", ex.Message);
+				return 1;
+			}
+
+			try
+			{
+				receiver = new HubReceiver(hubPath, !direct);
+				receiver.Authenticator = authenticator;
+				receiver.PacketReceived += receiver_PacketReceived;
+				receiver.StartReceiving();
+			}
+			catch (SocketException ex)
+			{
+				Console.Error.WriteLine("Listener could not be started: {0}", ex.Message);
+				return 1;
+			}
+
+			if (startup)
+			{
+				printStartup();
+				receiver.Dispose();
+				return 0;
+			}
+
+			Console.CancelKeyPress += (sender, e) =>
+			{
+				e.Cancel = true;
+				exit.Set();
+			};
+			// Stopped as a service.
+			AppDomain.CurrentDomain.ProcessExit += (sender, e) => exit.Set();
+
+			exit.WaitOne();
+			receiver.Dispose();
+
+			return 0;
+		}
+
+		static void receiver_PacketReceived(object sender, PacketReceivedEventArgs e)
+		{
+			Packet packet = e.ReceivedPacket;
+			DateTime receivedAt = DateTime.UtcNow;
+
+			lock (outputLock)
+			{
+				Console.Out.WriteLine(text ? formatText(packet, receivedAt) : formatJson(packet, receivedAt));
+				Console.Out.Flush();
+			}
+
+			if (execPath != null)
+				runHook(packet);
+		}
+
+		/// <summary>
+		/// Formats a packet as a single line of JSON. Written by hand, because the serializers
+		/// of the framework need reflection, which is not available after trimming.
+		/// </summary>
+		static string formatJson(Packet packet, DateTime receivedAt)
+		{
+			StringBuilder json = new StringBuilder(160);
+
+			json.Append("{\"type\":\"").Append(packet.MessageType.ToString()).Append('"');
+			json.Append(",\"typeId\":").Append(((int)packet.MessageType).ToString(CultureInfo.InvariantCulture));
+			json.Append(",\"id\":").Append(packet.PacketIdentifier.ToString(CultureInfo.InvariantCulture));
+			json.Append(",\"authenticated\":").Append(packet.Authenticated ? "true" : "false");
+			json.Append(",\"fireAt\":");
+
+			if (packet.FireAt.HasValue)
+				json.Append('"').Append(formatTime(packet.FireAt.Value)).Append('"');
+			else
+				json.Append("null");
+
+			json.Append(",\"receivedAt\":\"").Append(formatTime(receivedAt)).Append("\"}");
+
+			return json.ToString();
+		}
+
+		static string formatText(Packet packet, DateTime receivedAt)
+		{
+			string result = string.Format(CultureInfo.InvariantCulture, "{0} {1} #{2}", formatTime(receivedAt), packet.MessageType, packet.PacketIdentifier);
+
+			if (packet.FireAt.HasValue)
+				result += " at " + formatTime(packet.FireAt.Value);
+
+			return packet.Authenticated ? result + " (authenticated)" : result;
+		}
+
+		static string formatTime(DateTime time)
+		{
+			return time.ToUniversalTime().ToString("yyyy-MM-dd'T'HH:mm:ss.fff'Z'", CultureInfo.InvariantCulture);
+		}
+
+		/// <summary>
+		/// Runs the program of <c>-exec</c> for a packet. It is not waited for the program, so a slow
+		/// hook doesn't delay the following messages.
+		/// </summary>
+		static void runHook(Packet packet)
+		{
+			ProcessStartInfo info = new ProcessStartInfo(execPath);
+
+			info.ArgumentList.Add(packet.MessageType.ToString());
+			info.UseShellExecute = false;
+			info.Environment["BISS_MESSAGE_TYPE"] = packet.MessageType.ToString();
+			info.Environment["BISS_PACKET_ID"] = packet.PacketIdentifier.ToString(CultureInfo.InvariantCulture);
+			info.Environment["BISS_FIRE_AT"] = packet.FireAt.HasValue ? formatTime(packet.FireAt.Value) : string.Empty;
+
+			try
+			{
+				using (Process.Start(info))
+				{
+				}
+			}
+			catch (Exception ex) when (ex is System.ComponentModel.Win32Exception || ex is InvalidOperationException)
+			{
+				Console.Error.WriteLine("Hook {0} could not be started: {1}", execPath, ex.Message);
+			}
+		}
+
+		/// <summary>
+		/// Prints the time since the start of the process and the resident memory to stderr.
+		/// </summary>
+		static void printStartup()
+		{
+			TimeSpan elapsed;
+
+			using (Process process = Process.GetCurrentProcess())
+				elapsed = DateTime.Now - process.StartTime;
+
+			Console.Error.WriteLine("startup {0:F1} ms, rss {1:F1} MB, {2}",
+				elapsed.TotalMilliseconds, Environment.WorkingSet / (1024.0 * 1024.0), receiver.Authenticator != null ? "authenticated" : "unauthenticated");
+		}
+	}
+}
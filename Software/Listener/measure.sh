@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# Measures the startup of the listener published as a native AOT binary and
+# built framework-dependent. Each binary is started RUNS times with -startup,
+# which exits as soon as the listener is ready to receive; the medians of the
+# startup time reported by the listener, its resident memory and the wall time
+# of the process are printed, with the size of the binary.
+#
+# Usage: measure.sh [runs]
+#
+# The AOT publish needs the ILCompiler package from the NuGet feed. If it
+# fails, only the framework-dependent build is measured.
+
+RUNS=${1:-20}
+RID=${RID:-linux-x64}
+OUT=${OUT:-bin/measure}
+
+cd "$(dirname "$0")" || exit 1
+
+# Median of the numbers on stdin
+median() {
+	sort -n | awk '{ v[NR] = $1 } END { if (NR) print v[int((NR + 1) / 2)] }'
+}
+
+# measure <name> <binary> <size of the deployment in KiB>
+measure() {
+	log="$OUT/$1.log"
+	: > "$log"
+	i=0
+	while [ $i -lt "$RUNS" ]; do
+		start=$(date +%s%N)
+		# "startup <ms> ms, rss <MB> MB, ..." on stderr
+		line=$("$2" -startup 2>&1 >/dev/null)
+		end=$(date +%s%N)
+		echo "$line $(( (end - start) / 1000 ))" >> "$log"
+		i=$((i + 1))
+	done
+	printf '%-8s %12s %10s %10s %10s\n' "$1" \
+		"$(awk '{ print $2 }' "$log" | median)" \
+		"$(awk '{ print $5 }' "$log" | median)" \
+		"$(awk '{ printf "%.1f\n", $NF / 1000 }' "$log" | median)" \
+		"$3"
+}
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+
+if dotnet publish -nologo -v q -c Release -r "$RID" -o "$OUT/aot" > "$OUT/aot-publish.log" 2>&1; then
+	aot=1
+else
+	aot=0
+	echo "Native AOT publish failed, see $OUT/aot-publish.log" >&2
+fi
+
+if ! dotnet build -nologo -v q -c Release -p:PublishAot=false -o "$OUT/jit" > "$OUT/jit-build.log" 2>&1; then
+	echo "Framework-dependent build failed, see $OUT/jit-build.log" >&2
+	exit 1
+fi
+
+echo "$RUNS runs each, medians"
+printf '%-8s %12s %10s %10s %10s\n' Build "Ready [ms]" "RSS [MB]" "Wall [ms]" "Size [KiB]"
+
+if [ $aot -eq 1 ]; then
+	measure aot "$OUT/aot/BISS.Listener" "$(du -k "$OUT/aot/BISS.Listener" | cut -f1)"
+fi
+
+# The framework-dependent build needs the shared runtime, which isn't counted.
+measure jit "$OUT/jit/BISS.Listener" "$(du -ck "$OUT/jit/"*.dll "$OUT/jit/BISS.Listener" | tail -1 | cut -f1)"
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Net;
+using System.Net.NetworkInformation;
 using System.Net.Sockets;
 
 namespace BISS.Networking
@@ -43,6 +44,44 @@ namespace BISS.Networking
 			return result;
 		}
 
+		/// <summary>
+		/// Returns the directed broadcast address of the subnet of the specified address, e.g.
+		/// 192.168.1.255 for 192.168.1.20/24. Unlike the limited broadcast address it is routed over
+		/// the interface of the subnet regardless of how the OS picks the interface for the limited broadcast.
+		/// </summary>
+		/// <param name="address">An IPv4 address of this host.</param>
+		/// <returns>The directed broadcast address or <see cref="IPAddress.Broadcast"/> if the subnet mask is unknown
+		/// or the subnet has no broadcast address (/31 and /32).</returns>
+		protected static IPAddress GetDirectedBroadcast(UnicastIPAddressInformation address)
+		{
+			IPAddress mask = address.IPv4Mask;
+
+			if (mask == null || address.Address.AddressFamily != AddressFamily.InterNetwork)
+				return IPAddress.Broadcast;
+
+			byte[] bytes = address.Address.GetAddressBytes();
+			byte[] maskBytes = mask.GetAddressBytes();
+			int hostBits = 0;
+
+			for (int a = 0; a < bytes.Length; a++)
+			{
+				bytes[a] |= (byte)~maskBytes[a];
+				hostBits += 8 - countBits(maskBytes[a]);
+			}
+
+			return hostBits >= 2 ? new IPAddress(bytes) : IPAddress.Broadcast;
+		}
+
+		private static int countBits(byte value)
+		{
+			int result = 0;
+
+			for (; value != 0; value >>= 1)
+				result += value & 1;
+
+			return result;
+		}
+
 		/// <summary>
 		/// Check if the IP address speficied in <paramref name="ipAddress"/> is useable.
 		/// Only IPv4 addresses are supported. Loopback and multicast addresses are not supported.
@@ -0,0 +1,190 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Net;
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Sends a datagram to several destinations with a single <c>sendmmsg</c> call on Linux. The source
+	/// address and the interface of each message are selected with <c>IP_PKTINFO</c>, so a single
+	/// unbound socket serves all interfaces.
+	/// </summary>
+	internal static class BatchSender
+	{
+		const int IPPROTO_IP = 0;
+		const int IP_PKTINFO = 8;
+		const short AF_INET = 2;
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct SocketAddress4
+		{
+			public short Family;
+			public ushort Port;
+			public uint Address;
+			public ulong Zero;
+		}
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct IOVector
+		{
+			public IntPtr Base;
+			public UIntPtr Length;
+		}
+
+		// struct cmsghdr followed by struct in_pktinfo.
+		[StructLayout(LayoutKind.Sequential)]
+		struct PacketInfoControl
+		{
+			public UIntPtr Length;
+			public int Level;
+			public int Type;
+			public int InterfaceIndex;
+			public uint SpecificDestination;
+			public uint Address;
+		}
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct MessageHeader
+		{
+			public IntPtr Name;
+			public uint NameLength;
+			public IntPtr Vector;
+			public UIntPtr VectorLength;
+			public IntPtr Control;
+			public UIntPtr ControlLength;
+			public int Flags;
+		}
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct MultiMessageHeader
+		{
+			public MessageHeader Header;
+			public uint Length;
+		}
+
+		[DllImport("libc", SetLastError = true)]
+		static extern unsafe int sendmmsg(IntPtr socket, MultiMessageHeader* messages, uint length, int flags);
+
+		/// <summary>
+		/// Gets a value indicating whether batch sends are possibly supported by the OS.
+		/// </summary>
+		public static bool Supported
+		{
+			get
+			{
+				return Environment.OSVersion.Platform == PlatformID.Unix;
+			}
+		}
+
+		/// <summary>
+		/// Sends the datagram to all targets and stores the result of each send in the target.
+		/// </summary>
+		/// <param name="socket">UDP socket with broadcasts enabled.</param>
+		/// <param name="datagram">The datagram.</param>
+		/// <param name="targets">The interfaces, source addresses and destinations.</param>
+		/// <returns>TRUE if the datagram was sent, FALSE if batch sends are not supported.</returns>
+		public static unsafe bool Send(Socket socket, byte[] datagram, IList<InterfaceSender.Target> targets)
+		{
+			if (!Supported)
+				return false;
+
+			int count = targets.Count;
+			SocketAddress4[] addresses = new SocketAddress4[count];
+			PacketInfoControl[] controls = new PacketInfoControl[count];
+			MultiMessageHeader[] messages = new MultiMessageHeader[count];
+			// The kernel expects the length without the padding of the last control message.
+			int controlLength = (int)Marshal.OffsetOf(typeof(PacketInfoControl), "InterfaceIndex") + 12;
+
+			fixed (byte* data = datagram)
+			fixed (SocketAddress4* address = addresses)
+			fixed (PacketInfoControl* control = controls)
+			fixed (MultiMessageHeader* message = messages)
+			{
+				IOVector vector = new IOVector() { Base = (IntPtr)data, Length = (UIntPtr)datagram.Length };
+
+				for (int a = 0; a < count; a++)
+				{
+					InterfaceSender.Target target = targets[a];
+
+					address[a].Family = AF_INET;
+					address[a].Port = (ushort)IPAddress.HostToNetworkOrder((short)target.Destination.Port);
+					address[a].Address = toNetwork(target.Destination.Address);
+
+					control[a].Length = (UIntPtr)controlLength;
+					control[a].Level = IPPROTO_IP;
+					control[a].Type = IP_PKTINFO;
+					control[a].InterfaceIndex = target.InterfaceIndex;
+					control[a].SpecificDestination = toNetwork(target.Address);
+
+					message[a].Header.Name = (IntPtr)(address + a);
+					message[a].Header.NameLength = (uint)sizeof(SocketAddress4);
+					message[a].Header.Vector = (IntPtr)(&vector);
+					message[a].Header.VectorLength = (UIntPtr)1;
+					message[a].Header.Control = (IntPtr)(control + a);
+					message[a].Header.ControlLength = (UIntPtr)sizeof(PacketInfoControl);
+				}
+
+				try
+				{
+					// The call stops at the first failed message, which is skipped before going on.
+					for (int sent = 0; sent < count; )
+					{
+						int result = sendmmsg(socket.Handle, message + sent, (uint)(count - sent), 0);
+
+						if (result > 0)
+						{
+							for (int a = sent; a < sent + result; a++)
+								targets[a].Result = message[a].Length == datagram.Length ? SocketError.Success : SocketError.MessageSize;
+
+							sent += result;
+						}
+						else
+						{
+							targets[sent].Result = toSocketError(Marshal.GetLastWin32Error());
+							sent++;
+						}
+					}
+				}
+				catch (DllNotFoundException)
+				{
+					return false;
+				}
+				catch (EntryPointNotFoundException)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// Returns the IPv4 address in network byte order.
+		/// </summary>
+		private static uint toNetwork(IPAddress address)
+		{
+			return BitConverter.ToUInt32(address.GetAddressBytes(), 0);
+		}
+
+		/// <summary>
+		/// Converts the errors which are likely for a UDP send from their Linux errno value.
+		/// </summary>
+		private static SocketError toSocketError(int errno)
+		{
+			switch (errno)
+			{
+				case 11: return SocketError.WouldBlock;
+				case 13: return SocketError.AccessDenied;
+				case 90: return SocketError.MessageSize;
+				case 99: return SocketError.AddressNotAvailable;
+				case 100: return SocketError.NetworkDown;
+				case 101: return SocketError.NetworkUnreachable;
+				case 105: return SocketError.NoBufferSpaceAvailable;
+				case 113: return SocketError.HostUnreachable;
+				default: return SocketError.SocketError;
+			}
+		}
+	}
+}
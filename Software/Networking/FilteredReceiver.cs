@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 
 namespace BISS.Networking
 {
@@ -8,7 +9,45 @@ namespace BISS.Networking
 	/// </summary>
 	public class FilteredReceiver : Receiver
 	{
-		readonly List<ushort> receivedIdentifiers;
+		/// <summary>
+		/// Maximum number of identifiers remembered. Identifiers are forgotten by their age, this only
+		/// bounds the list when a flood of forged packets arrives within <see cref="IdentifierLifetime"/>.
+		/// </summary>
+		const int identifierCapacity = 16384;
+
+		/// <summary>
+		/// The default time an identifier is remembered: all transmissions of a default
+		/// <see cref="RepetitiveSender"/> plus ten seconds for the network and the other interfaces.
+		/// </summary>
+		public static readonly TimeSpan DefaultIdentifierLifetime =
+			TimeSpan.FromSeconds(RepetitiveSender.DefaultRepetitions * RepetitiveSender.DefaultDelay + 10);
+
+		readonly HashSet<ushort> receivedIdentifiers;
+		// Identifiers with their timestamp in the order they were received, for forgetting the oldest one.
+		readonly Queue<KeyValuePair<ushort, long>> identifierOrder;
+		readonly object lockObject;
+		TimeSpan identifierLifetime;
+
+		/// <summary>
+		/// Gets or sets how long the identifier of a received packet is remembered. Repetitions
+		/// arriving within this time are filtered, afterwards the identifier may be used by another
+		/// message. It must cover all repetitions of the senders.
+		/// </summary>
+		/// <exception cref="ArgumentOutOfRangeException">The value is negative.</exception>
+		public TimeSpan IdentifierLifetime
+		{
+			get
+			{
+				return this.identifierLifetime;
+			}
+			set
+			{
+				if (value < TimeSpan.Zero)
+					throw new ArgumentOutOfRangeException("value");
+
+				this.identifierLifetime = value;
+			}
+		}
 
 		/// <summary>
 		/// Occurs when a received packet was filtered.
@@ -18,7 +57,54 @@ namespace BISS.Networking
 		public FilteredReceiver()
 			: base()
 		{
-			this.receivedIdentifiers = new List<ushort>();
+			this.receivedIdentifiers = new HashSet<ushort>();
+			this.identifierOrder = new Queue<KeyValuePair<ushort, long>>();
+			this.lockObject = new object();
+			this.identifierLifetime = DefaultIdentifierLifetime;
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="FilteredReceiver"/> class, which receives the
+		/// packets from the specified transport.
+		/// </summary>
+		/// <param name="transport">The transport providing the datagrams.</param>
+		public FilteredReceiver(Transport transport)
+			: base(transport)
+		{
+			this.receivedIdentifiers = new HashSet<ushort>();
+			this.identifierOrder = new Queue<KeyValuePair<ushort, long>>();
+			this.lockObject = new object();
+			this.identifierLifetime = DefaultIdentifierLifetime;
+		}
+
+		/// <summary>
+		/// Takes over the identifiers remembered by another receiver, which received the packets from
+		/// another transport before. Repetitions of the packets it received are filtered, too.
+		/// </summary>
+		/// <param name="previous">The previous receiver.</param>
+		internal void CopyIdentifiers(FilteredReceiver previous)
+		{
+			lock (previous.lockObject)
+			{
+				lock (this.lockObject)
+				{
+					foreach (KeyValuePair<ushort, long> identifier in previous.identifierOrder)
+					{
+						if (this.receivedIdentifiers.Add(identifier.Key))
+							this.identifierOrder.Enqueue(identifier);
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the current <see cref="Stopwatch"/> timestamp, which determines the age of the
+		/// remembered identifiers.
+		/// </summary>
+		/// <returns>The current timestamp.</returns>
+		protected virtual long GetTimestamp()
+		{
+			return Stopwatch.GetTimestamp();
 		}
 
 		/// <summary>
@@ -44,17 +130,37 @@ namespace BISS.Networking
 			if (receivedPacket == null)
 				throw new ArgumentNullException("receivedPacket");
 
-			// Check if the packet identifier was already received before
-			if (this.receivedIdentifiers.Contains(receivedPacket.PacketIdentifier))
+			long now = GetTimestamp();
+			long lifetime = (long)(this.identifierLifetime.TotalSeconds * Stopwatch.Frequency);
+			bool received;
+
+			// Only locked against CopyIdentifiers, the packets are received one after another.
+			lock (this.lockObject)
+			{
+				// Forget the identifiers which are older than the lifetime
+				while (this.identifierOrder.Count > 0 && now - this.identifierOrder.Peek().Value >= lifetime)
+					this.receivedIdentifiers.Remove(this.identifierOrder.Dequeue().Key);
+
+				// Check if the packet identifier was already received before
+				received = this.receivedIdentifiers.Contains(receivedPacket.PacketIdentifier);
+
+				if (!received)
+				{
+					if (this.identifierOrder.Count == identifierCapacity)
+						this.receivedIdentifiers.Remove(this.identifierOrder.Dequeue().Key);
+
+					this.receivedIdentifiers.Add(receivedPacket.PacketIdentifier);
+					this.identifierOrder.Enqueue(new KeyValuePair<ushort, long>(receivedPacket.PacketIdentifier, now));
+				}
+			}
+
+			if (received)
 			{
+				NetworkingEventSource.Log.PacketFiltered(receivedPacket.PacketIdentifier);
 				OnPacketFiltered(receivedPacket);
-				return;
 			}
 			else
-			{
-				this.receivedIdentifiers.Add(receivedPacket.PacketIdentifier);
 				base.OnPacketReceived(receivedPacket);
-			}
 		}
 	}
 }
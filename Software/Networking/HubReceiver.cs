@@ -0,0 +1,215 @@
+﻿using System;
+using System.Net.Sockets;
+using System.Threading;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Receives the packets from the <see cref="ReceiveHub"/> of this host if it is running, otherwise
+	/// directly from an own UDP socket.
+	/// </summary>
+	/// <remarks>
+	/// When the hub exits, the packets are received directly again. While receiving directly, it is
+	/// checked every <see cref="HubRetryInterval"/> whether a hub was started, which is used then.
+	/// The identifiers of the received packets are taken over on each switch, so repetitions of a
+	/// packet are filtered across the switch, too.
+	/// </remarks>
+	public class HubReceiver : IDisposable
+	{
+		readonly string path;
+		readonly bool useHub;
+		readonly object lockObject;
+		FilteredReceiver receiver;
+		PacketAuthenticator authenticator;
+		Timer hubRetry;
+		bool disposed;
+
+		/// <summary>
+		/// Gets or sets the authenticator verifying the packets, or NULL if unauthenticated packets are
+		/// accepted. See <see cref="Receiver.Authenticator"/>.
+		/// </summary>
+		public PacketAuthenticator Authenticator
+		{
+			get
+			{
+				return this.authenticator;
+			}
+			set
+			{
+				lock (this.lockObject)
+				{
+					this.authenticator = value;
+
+					if (this.receiver != null)
+						this.receiver.Authenticator = value;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the interval for looking for a started hub while receiving directly. Defaults to
+		/// 5 seconds. Must be set before receiving is started.
+		/// </summary>
+		public TimeSpan HubRetryInterval
+		{ get; set; } = TimeSpan.FromSeconds(5);
+
+		/// <summary>
+		/// Gets a value indicating whether the packets are currently received from the hub.
+		/// </summary>
+		public bool ReceivingFromHub
+		{ get; private set; }
+
+		/// <summary>
+		/// Occurs when a packet was received, which was not received before.
+		/// </summary>
+		public event EventHandler<PacketReceivedEventArgs> PacketReceived;
+
+		/// <summary>
+		/// Occurs when the packets are received from the hub or directly, see <see cref="ReceivingFromHub"/>.
+		/// Also raised when receiving starts.
+		/// </summary>
+		public event EventHandler TransportChanged;
+
+		/// <summary>
+		/// Initializes a new instance of the HubReceiver class.
+		/// </summary>
+		/// <param name="path">Path of the socket of the hub. <see cref="ReceiveHub.DefaultPath"/> is used
+		/// if this parameter is not set.</param>
+		/// <param name="useHub">FALSE if the packets are always received directly.</param>
+		public HubReceiver(string path = null, bool useHub = true)
+		{
+			this.path = path;
+			this.useHub = useHub;
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Connects to the hub or opens the UDP socket and starts receiving packets.
+		/// </summary>
+		/// <exception cref="SocketException">The UDP socket could not be opened.</exception>
+		public void StartReceiving()
+		{
+			if (this.disposed)
+				throw new ObjectDisposedException(GetType().FullName);
+
+			this.hubRetry = new Timer(state => retryHub());
+			switchTransport(this.useHub ? HubTransport.Connect(this.path) : null);
+		}
+
+		/// <summary>
+		/// Replaces the receiver by one receiving from the hub, or directly if <paramref name="hub"/> is NULL.
+		/// </summary>
+		private void switchTransport(HubTransport hub)
+		{
+			lock (this.lockObject)
+			{
+				if (this.disposed)
+				{
+					if (hub != null)
+						hub.Dispose();
+
+					return;
+				}
+
+				FilteredReceiver previous = this.receiver;
+				FilteredReceiver next;
+
+				// Both receive the same packets for a moment, so the previous one is closed first.
+				if (previous != null)
+					previous.Dispose();
+
+				next = hub != null ? new FilteredReceiver(hub) : new FilteredReceiver();
+				next.Authenticator = this.authenticator;
+				next.PacketReceived += receiver_PacketReceived;
+				next.TransportClosed += receiver_TransportClosed;
+
+				if (previous != null)
+					next.CopyIdentifiers(previous);
+
+				this.receiver = next;
+				this.ReceivingFromHub = hub != null;
+
+				if (hub == null && this.useHub)
+					this.hubRetry.Change(HubRetryInterval, HubRetryInterval);
+				else
+					this.hubRetry.Change(Timeout.Infinite, Timeout.Infinite);
+
+				next.StartReceiving();
+			}
+
+			OnTransportChanged();
+		}
+
+		private void retryHub()
+		{
+			HubTransport hub = HubTransport.Connect(this.path);
+
+			if (hub != null)
+				switchTransport(hub);
+		}
+
+		private void receiver_TransportClosed(object sender, EventArgs e)
+		{
+			// The hub exited, receive the packets directly again.
+			switchTransport(null);
+		}
+
+		private void receiver_PacketReceived(object sender, PacketReceivedEventArgs e)
+		{
+			OnPacketReceived(e);
+		}
+
+		/// <summary>
+		/// Raises the <see cref="PacketReceived"/> event.
+		/// </summary>
+		/// <param name="e">The event data of the received packet.</param>
+		protected virtual void OnPacketReceived(PacketReceivedEventArgs e)
+		{
+			if (PacketReceived != null)
+				PacketReceived(this, e);
+		}
+
+		/// <summary>
+		/// Raises the <see cref="TransportChanged"/> event.
+		/// </summary>
+		protected virtual void OnTransportChanged()
+		{
+			if (TransportChanged != null)
+				TransportChanged(this, EventArgs.Empty);
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			lock (this.lockObject)
+			{
+				if (!disposed)
+				{
+					disposed = true;
+
+					if (disposing)
+					{
+						if (this.hubRetry != null)
+							this.hubRetry.Dispose();
+
+						if (this.receiver != null)
+							this.receiver.Dispose();
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Stops receiving and releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
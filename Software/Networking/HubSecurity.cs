@@ -0,0 +1,141 @@
+﻿using System;
+using System.IO;
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Protects the socket of the <see cref="ReceiveHub"/> against other users of the host: the socket
+	/// is placed in a directory only its owner can access, and subscribers only accept a hub run by
+	/// their own user or root.
+	/// </summary>
+	internal static class HubSecurity
+	{
+		const int SOL_SOCKET = 1;
+		const int SO_PEERCRED = 17;
+		const int EEXIST = 17;
+
+		/// <summary>
+		/// Access only for the owner (rwx------).
+		/// </summary>
+		const uint privateMode = 0x1C0;
+
+		/// <summary>
+		/// Size of struct ucred.
+		/// </summary>
+		const int ucredLength = 12;
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct Ucred
+		{
+			public int Pid;
+			public uint Uid;
+			public uint Gid;
+		}
+
+		[DllImport("libc", SetLastError = true)]
+		static extern int getsockopt(IntPtr socket, int level, int optionName, out Ucred optionValue, ref int optionLength);
+
+		[DllImport("libc")]
+		static extern uint getuid();
+
+		[DllImport("libc", SetLastError = true)]
+		static extern int mkdir(string path, uint mode);
+
+		[DllImport("libc", SetLastError = true)]
+		static extern int chmod(string path, uint mode);
+
+		/// <summary>
+		/// Gets a value indicating whether the OS has Unix permissions. On Windows the temporary
+		/// directory belongs to the user already.
+		/// </summary>
+		public static bool Supported
+		{
+			get
+			{
+				return Environment.OSVersion.Platform == PlatformID.Unix;
+			}
+		}
+
+		/// <summary>
+		/// Gets the directory for the socket of the hub: the runtime directory of the user, or a directory
+		/// of the user in the temporary directory if there is none.
+		/// </summary>
+		public static string Directory
+		{
+			get
+			{
+				if (!Supported)
+					return Path.GetTempPath();
+
+				string runtime = Environment.GetEnvironmentVariable("XDG_RUNTIME_DIR");
+
+				return !String.IsNullOrEmpty(runtime) ? runtime : temporaryDirectory();
+			}
+		}
+
+		/// <summary>
+		/// Gets the directory of the current user in the temporary directory, which is shared by all users.
+		/// </summary>
+		private static string temporaryDirectory()
+		{
+			return Path.Combine(Path.GetTempPath(), "biss-" + getuid());
+		}
+
+		/// <summary>
+		/// Creates the directory of a socket if it doesn't exist, accessible only by the current user.
+		/// The directory of <see cref="Directory"/> in the temporary directory must belong to the current
+		/// user, otherwise another user could replace the socket.
+		/// </summary>
+		/// <param name="path">Path of the directory.</param>
+		/// <exception cref="InvalidOperationException">The directory belongs to another user.</exception>
+		/// <exception cref="IOException">The directory could not be created.</exception>
+		public static void CreateDirectory(string path)
+		{
+			if (!Supported)
+			{
+				System.IO.Directory.CreateDirectory(path);
+				return;
+			}
+
+			if (mkdir(path, privateMode) != 0 && Marshal.GetLastWin32Error() != EEXIST)
+				throw new IOException(String.Format("The directory {0} could not be created.", path));
+
+			// Only the owner may change the mode, so this also verifies the owner.
+			if (path == temporaryDirectory() && chmod(path, privateMode) != 0)
+				throw new InvalidOperationException(String.Format("The directory {0} belongs to another user.", path));
+		}
+
+		/// <summary>
+		/// Checks that the process at the other end of a connected Unix domain socket runs as the current
+		/// user or as root. Where the credentials can't be read, the peer is not trusted.
+		/// </summary>
+		/// <param name="socket">The connected socket.</param>
+		/// <returns>TRUE if the peer can be trusted.</returns>
+		public static bool IsTrustedPeer(Socket socket)
+		{
+			if (!Supported)
+				return true;
+
+			try
+			{
+				Ucred credentials;
+				int length = ucredLength;
+
+				if (getsockopt(socket.Handle, SOL_SOCKET, SO_PEERCRED, out credentials, ref length) != 0)
+					return false;
+
+				return credentials.Uid == 0 || credentials.Uid == getuid();
+			}
+			catch (DllNotFoundException)
+			{
+				return false;
+			}
+			catch (EntryPointNotFoundException)
+			{
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,126 @@
+﻿using System;
+using System.Net;
+using System.Net.Sockets;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Receives the packets from the <see cref="ReceiveHub"/> of this host.
+	/// </summary>
+	/// <remarks>The hub has already validated and deduplicated the packets. It forwards the original
+	/// datagrams, so authenticated packets are verified again by the receiver.</remarks>
+	public class HubTransport : Transport
+	{
+		readonly Socket socket;
+		readonly byte[] buffer;
+
+		/// <summary>
+		/// Initializes a new instance of the HubTransport class.
+		/// </summary>
+		/// <param name="socket">The socket connected to the hub.</param>
+		private HubTransport(Socket socket)
+		{
+			this.socket = socket;
+			this.buffer = new byte[ReceiveHub.RecordSize];
+		}
+
+		/// <summary>
+		/// Connects to the hub of this host.
+		/// </summary>
+		/// <param name="path">Path of the socket of the hub. <see cref="ReceiveHub.DefaultPath"/> is used
+		/// if this parameter is not set.</param>
+		/// <returns>Instance of <see cref="HubTransport"/> or NULL if no hub is running. A hub run by
+		/// another user (except root) is ignored, too, it could inject packets.</returns>
+		public static HubTransport Connect(string path = null)
+		{
+			Socket socket = null;
+
+			try
+			{
+				socket = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+				socket.Connect(new UnixEndPoint(path ?? ReceiveHub.DefaultPath));
+
+				if (HubSecurity.IsTrustedPeer(socket))
+					return new HubTransport(socket);
+			}
+			catch (SocketException)
+			{
+			}
+			catch (NotSupportedException)
+			{
+				// Unix domain sockets are not supported by the OS.
+			}
+
+			if (socket != null)
+				socket.Close();
+
+			return null;
+		}
+
+		/// <summary>
+		/// Begins to receive a packet asynchronously.
+		/// </summary>
+		/// <param name="callback">The method called when the packet was received.</param>
+		/// <param name="state">User defined object passed to the callback.</param>
+		/// <returns>An <see cref="IAsyncResult"/> referencing the asynchronous receive.</returns>
+		public override IAsyncResult BeginReceive(AsyncCallback callback, object state)
+		{
+			return this.socket.BeginReceive(this.buffer, 0, this.buffer.Length, SocketFlags.None, callback, state);
+		}
+
+		/// <summary>
+		/// Ends a pending asynchronous receive.
+		/// </summary>
+		/// <param name="asyncResult">The <see cref="IAsyncResult"/> returned by <see cref="BeginReceive"/>.</param>
+		/// <param name="remoteEndPoint">Always NULL, the hub doesn't forward the sender.</param>
+		/// <returns>The received datagram or NULL if the hub closed the connection.</returns>
+		public override byte[] EndReceive(IAsyncResult asyncResult, out IPEndPoint remoteEndPoint)
+		{
+			remoteEndPoint = null;
+
+			int received;
+
+			try
+			{
+				received = this.socket.EndReceive(asyncResult);
+
+				// The hub writes each record at once, so it is almost always received completely. Otherwise
+				// the rest follows immediately.
+				while (received > 0 && received < this.buffer.Length)
+				{
+					int read = this.socket.Receive(this.buffer, received, this.buffer.Length - received, SocketFlags.None);
+
+					if (read == 0)
+						break;
+
+					received += read;
+				}
+			}
+			catch (SocketException ex) when (ex.SocketErrorCode == SocketError.ConnectionReset)
+			{
+				// The hub exited.
+				return null;
+			}
+
+			if (received < this.buffer.Length)
+				return null;
+
+			// An invalid length yields an empty datagram, which the receiver rejects.
+			int length = this.buffer[0] < this.buffer.Length ? this.buffer[0] : 0;
+			byte[] result = new byte[length];
+
+			Buffer.BlockCopy(this.buffer, 1, result, 0, length);
+			return result;
+		}
+
+		/// <summary>
+		/// Closes the connection to the hub.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected override void Dispose(bool disposing)
+		{
+			if (disposing)
+				this.socket.Close();
+		}
+	}
+}
@@ -0,0 +1,313 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Net;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Passes the datagrams of another transport through an <see cref="Impairment"/>, so loss, delay,
+	/// duplication and reordering can be tested on a single host.
+	/// </summary>
+	/// <example>
+	/// <code>
+	/// Transport transport = new ImpairedTransport(new UdpTransport(client), Impairment.Parse("loss=10,jitter=50", 1));
+	/// FilteredReceiver receiver = new FilteredReceiver(transport);
+	/// </code>
+	/// </example>
+	public class ImpairedTransport : Transport
+	{
+		/// <summary>
+		/// A datagram waiting to be received.
+		/// </summary>
+		struct Datagram
+		{
+			public byte[] Data;
+			public IPEndPoint RemoteEndPoint;
+		}
+
+		/// <summary>
+		/// A datagram held back until its delay has passed.
+		/// </summary>
+		class Delayed
+		{
+			public Datagram Datagram;
+			public Timer Timer;
+		}
+
+		readonly Transport transport;
+		readonly Impairment impairment;
+		readonly Stopwatch clock;
+		readonly Queue<Datagram> ready;
+		// Referenced until they fired, otherwise unreferenced timers may be collected.
+		readonly HashSet<Delayed> delayed;
+		readonly TimeSpan[] delays;
+		readonly object lockObject;
+		TaskCompletionSource<Datagram> pending;
+		bool receiving;
+		bool closed;
+		bool disposed;
+
+		/// <summary>
+		/// Gets the impairment applied to the datagrams.
+		/// </summary>
+		public Impairment Impairment
+		{
+			get
+			{
+				return this.impairment;
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the ImpairedTransport class.
+		/// </summary>
+		/// <param name="transport">The transport providing the datagrams.</param>
+		/// <param name="impairment">The impairment applied to the datagrams.</param>
+		/// <exception cref="ArgumentNullException">A parameter was NULL.</exception>
+		public ImpairedTransport(Transport transport, Impairment impairment)
+		{
+			if (transport == null)
+				throw new ArgumentNullException("transport");
+			if (impairment == null)
+				throw new ArgumentNullException("impairment");
+
+			this.transport = transport;
+			this.impairment = impairment;
+			this.clock = Stopwatch.StartNew();
+			this.ready = new Queue<Datagram>();
+			this.delayed = new HashSet<Delayed>();
+			this.delays = new TimeSpan[Impairment.MaxCopies];
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Begins to receive a datagram asynchronously.
+		/// </summary>
+		/// <param name="callback">The method called when the datagram was received.</param>
+		/// <param name="state">User defined object passed to the callback.</param>
+		/// <returns>An <see cref="IAsyncResult"/> referencing the asynchronous receive.</returns>
+		public override IAsyncResult BeginReceive(AsyncCallback callback, object state)
+		{
+			TaskCompletionSource<Datagram> source = new TaskCompletionSource<Datagram>(state);
+			bool start;
+
+			lock (this.lockObject)
+			{
+				if (this.ready.Count > 0)
+					source.SetResult(this.ready.Dequeue());
+				else if (this.closed || this.disposed)
+					source.SetResult(new Datagram());
+				else
+					this.pending = source;
+
+				start = !this.receiving;
+				this.receiving = true;
+			}
+
+			// The callback runs on the thread pool even for queued datagrams, so the stack doesn't grow.
+			if (callback != null)
+				source.Task.ContinueWith(task => callback(task));
+
+			if (start)
+				receiveLoop();
+
+			return source.Task;
+		}
+
+		/// <summary>
+		/// Ends a pending asynchronous receive.
+		/// </summary>
+		/// <param name="asyncResult">The <see cref="IAsyncResult"/> returned by <see cref="BeginReceive"/>.</param>
+		/// <param name="remoteEndPoint">The sender of the datagram, or NULL if it is unknown.</param>
+		/// <returns>The received datagram, or NULL if the impaired transport was closed.</returns>
+		/// <exception cref="ObjectDisposedException">This instance was disposed.</exception>
+		public override byte[] EndReceive(IAsyncResult asyncResult, out IPEndPoint remoteEndPoint)
+		{
+			if (this.disposed)
+				throw new ObjectDisposedException(GetType().FullName);
+
+			Datagram datagram = ((Task<Datagram>)asyncResult).Result;
+
+			remoteEndPoint = datagram.RemoteEndPoint;
+			return datagram.Data;
+		}
+
+		/// <summary>
+		/// Receives the datagrams of the impaired transport, in the same way as <see cref="Receiver"/>.
+		/// </summary>
+		private void receiveLoop()
+		{
+			IAsyncResult asyncResult;
+
+			do
+			{
+				try
+				{
+					asyncResult = this.transport.BeginReceive(receiveCallback, null);
+				}
+				catch (ObjectDisposedException)
+				{
+					return;
+				}
+
+				if (!asyncResult.CompletedSynchronously)
+					return;
+			}
+			while (receive(asyncResult));
+		}
+
+		private void receiveCallback(IAsyncResult asyncResult)
+		{
+			if (asyncResult.CompletedSynchronously)
+				return;
+
+			if (receive(asyncResult))
+				receiveLoop();
+		}
+
+		/// <summary>
+		/// Completes the receive of a datagram and impairs it.
+		/// </summary>
+		/// <returns>TRUE if receiving should go on.</returns>
+		private bool receive(IAsyncResult asyncResult)
+		{
+			Datagram datagram;
+
+			try
+			{
+				datagram.Data = this.transport.EndReceive(asyncResult, out datagram.RemoteEndPoint);
+			}
+			catch (Exception ex) when (ex is ObjectDisposedException || ex is System.Net.Sockets.SocketException)
+			{
+				return false;
+			}
+
+			if (datagram.Data == null)
+			{
+				close();
+				return false;
+			}
+
+			int copies = this.impairment.Apply(this.clock.Elapsed, this.delays);
+
+			for (int a = 0; a < copies; a++)
+			{
+				if (this.delays[a] <= TimeSpan.Zero)
+				{
+					deliver(datagram);
+					continue;
+				}
+
+				Delayed item = new Delayed();
+				item.Datagram = datagram;
+
+				lock (this.lockObject)
+				{
+					if (this.disposed)
+						return false;
+
+					// The callback waits for the lock, so the timer is assigned before it runs.
+					this.delayed.Add(item);
+					item.Timer = new Timer(delayCallback, item, this.delays[a], Timeout.InfiniteTimeSpan);
+				}
+			}
+
+			return !this.disposed;
+		}
+
+		private void delayCallback(object state)
+		{
+			Delayed item = (Delayed)state;
+
+			lock (this.lockObject)
+			{
+				if (!this.delayed.Remove(item))
+					return;
+
+				item.Timer.Dispose();
+			}
+
+			deliver(item.Datagram);
+		}
+
+		/// <summary>
+		/// Completes the pending receive with the datagram, or queues it.
+		/// </summary>
+		private void deliver(Datagram datagram)
+		{
+			TaskCompletionSource<Datagram> source;
+
+			lock (this.lockObject)
+			{
+				source = this.pending;
+				this.pending = null;
+
+				if (source == null)
+				{
+					this.ready.Enqueue(datagram);
+					return;
+				}
+			}
+
+			source.SetResult(datagram);
+		}
+
+		/// <summary>
+		/// Marks the impaired transport as closed. The datagrams still delayed are received first.
+		/// </summary>
+		private void close()
+		{
+			TaskCompletionSource<Datagram> source = null;
+
+			lock (this.lockObject)
+			{
+				this.closed = true;
+
+				if (this.delayed.Count == 0)
+				{
+					source = this.pending;
+					this.pending = null;
+				}
+			}
+
+			if (source != null)
+				source.SetResult(new Datagram());
+		}
+
+		/// <summary>
+		/// Disposes of the impaired transport and drops the delayed datagrams.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected override void Dispose(bool disposing)
+		{
+			if (!disposing)
+				return;
+
+			TaskCompletionSource<Datagram> source;
+
+			lock (this.lockObject)
+			{
+				if (this.disposed)
+					return;
+
+				this.disposed = true;
+
+				foreach (Delayed item in this.delayed)
+					item.Timer.Dispose();
+
+				this.delayed.Clear();
+				source = this.pending;
+				this.pending = null;
+			}
+
+			this.transport.Dispose();
+
+			// The receiver gets an ObjectDisposedException from EndReceive.
+			if (source != null)
+				source.SetResult(new Datagram());
+		}
+	}
+}
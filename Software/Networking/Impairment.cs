@@ -0,0 +1,323 @@
+﻿using System;
+using System.Globalization;
+using System.Text;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Simulates an unreliable network: decides for each datagram if it is lost, duplicated, delayed
+	/// or reordered.
+	/// </summary>
+	/// <remarks>
+	/// Besides the independent loss of <see cref="Loss"/>, outages can be simulated in which all
+	/// datagrams are lost. Outages start on average every <see cref="BurstInterval"/> and last
+	/// <see cref="BurstLength"/> on average, both exponentially distributed. The outages depend on
+	/// the time, not on the number of datagrams, so the delay between repetitions matters like on a
+	/// real network. The time passed to <see cref="Apply"/> must not decrease.
+	/// </remarks>
+	public class Impairment
+	{
+		/// <summary>
+		/// Maximum number of copies of a datagram, see <see cref="Apply"/>.
+		/// </summary>
+		public const int MaxCopies = 2;
+
+		readonly Random random;
+		readonly object lockObject;
+		bool started;
+		bool outage;
+		TimeSpan nextChange;
+		long dropped;
+		long duplicated;
+		long reordered;
+
+		/// <summary>
+		/// Gets or sets the probability from 0 to 1 that a datagram is lost outside of outages.
+		/// </summary>
+		public double Loss
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the mean time between two outages, or zero if there are none.
+		/// </summary>
+		public TimeSpan BurstInterval
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the mean length of an outage.
+		/// </summary>
+		public TimeSpan BurstLength
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the time every datagram is delayed.
+		/// </summary>
+		public TimeSpan Latency
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the maximum time added to or subtracted from <see cref="Latency"/>, uniformly distributed.
+		/// </summary>
+		public TimeSpan Jitter
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the probability from 0 to 1 that a datagram arrives twice.
+		/// </summary>
+		public double Duplication
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the probability from 0 to 1 that a datagram is held back by <see cref="ReorderDelay"/>,
+		/// so the following datagrams overtake it.
+		/// </summary>
+		public double Reordering
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the time a reordered datagram is held back.
+		/// </summary>
+		public TimeSpan ReorderDelay
+		{ get; set; }
+
+		/// <summary>
+		/// Gets the number of datagrams lost.
+		/// </summary>
+		public long Dropped
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.dropped;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of datagrams which arrived twice.
+		/// </summary>
+		public long Duplicated
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.duplicated;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of datagrams which were held back.
+		/// </summary>
+		public long Reordered
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.reordered;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the Impairment class, which doesn't impair the datagrams
+		/// until its properties are set.
+		/// </summary>
+		/// <param name="seed">Seed of the random numbers, so a simulation can be repeated.</param>
+		public Impairment(int seed)
+		{
+			this.random = new Random(seed);
+			this.lockObject = new object();
+			this.ReorderDelay = TimeSpan.FromMilliseconds(10);
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the Impairment class with a random seed.
+		/// </summary>
+		public Impairment()
+			: this(Environment.TickCount)
+		{ }
+
+		/// <summary>
+		/// Decides the fate of a datagram sent at the specified time.
+		/// </summary>
+		/// <param name="time">Time the datagram is sent, e.g. since the start of the simulation.</param>
+		/// <param name="delays">Receives the delay of each copy of the datagram which arrives; at
+		/// least <see cref="MaxCopies"/> elements long.</param>
+		/// <returns>Number of copies arriving, zero if the datagram is lost.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="delays"/> was NULL.</exception>
+		/// <exception cref="ArgumentException">The array in <paramref name="delays"/> was too short.</exception>
+		public int Apply(TimeSpan time, TimeSpan[] delays)
+		{
+			if (delays == null)
+				throw new ArgumentNullException("delays");
+			if (delays.Length < MaxCopies)
+				throw new ArgumentException("The array is too short.", "delays");
+
+			lock (this.lockObject)
+			{
+				if (inOutage(time) || this.random.NextDouble() < this.Loss)
+				{
+					this.dropped++;
+					return 0;
+				}
+
+				int copies = 1;
+
+				if (this.random.NextDouble() < this.Duplication)
+				{
+					copies = MaxCopies;
+					this.duplicated++;
+				}
+
+				for (int a = 0; a < copies; a++)
+				{
+					delays[a] = this.Latency + TimeSpan.FromTicks((long)((this.random.NextDouble() * 2 - 1) * this.Jitter.Ticks));
+
+					if (this.random.NextDouble() < this.Reordering)
+					{
+						delays[a] += this.ReorderDelay;
+						this.reordered++;
+					}
+
+					if (delays[a] < TimeSpan.Zero)
+						delays[a] = TimeSpan.Zero;
+				}
+
+				return copies;
+			}
+		}
+
+		/// <summary>
+		/// Advances the outages to the specified time.
+		/// </summary>
+		/// <returns>TRUE if the network is down at that time.</returns>
+		private bool inOutage(TimeSpan time)
+		{
+			if (this.BurstInterval <= TimeSpan.Zero || this.BurstLength <= TimeSpan.Zero)
+				return false;
+
+			if (!this.started)
+			{
+				this.started = true;
+				this.nextChange = time + exponential(this.BurstInterval);
+			}
+
+			while (time >= this.nextChange)
+			{
+				this.outage = !this.outage;
+				this.nextChange += exponential(this.outage ? this.BurstLength : this.BurstInterval);
+			}
+
+			return this.outage;
+		}
+
+		private TimeSpan exponential(TimeSpan mean)
+		{
+			return TimeSpan.FromTicks((long)(-Math.Log(1 - this.random.NextDouble()) * mean.Ticks));
+		}
+
+		/// <summary>
+		/// Creates an impairment from a comma separated list of settings, e.g.
+		/// <c>loss=5,burst=30000/2000,latency=2,jitter=1,dup=1,reorder=1,reorderdelay=10</c>.
+		/// Probabilities are given in percent and times in milliseconds; burst is the mean interval
+		/// and length of the outages.
+		/// </summary>
+		/// <param name="settings">The settings; missing settings are zero.</param>
+		/// <param name="seed">Seed of the random numbers.</param>
+		/// <returns>The impairment.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="settings"/> was NULL.</exception>
+		/// <exception cref="FormatException">A setting was unknown or its value invalid.</exception>
+		public static Impairment Parse(string settings, int seed)
+		{
+			if (settings == null)
+				throw new ArgumentNullException("settings");
+
+			Impairment result = new Impairment(seed);
+
+			foreach (string setting in settings.Split(new char[] { ',' }, StringSplitOptions.RemoveEmptyEntries))
+			{
+				string[] pair = setting.Split('=');
+
+				if (pair.Length != 2)
+					throw new FormatException(String.Format("Invalid setting \"{0}\".", setting));
+
+				string name = pair[0].Trim().ToLowerInvariant();
+
+				if (name == "burst")
+				{
+					string[] times = pair[1].Split('/');
+
+					if (times.Length != 2)
+						throw new FormatException("The burst needs an interval and a length, e.g. burst=30000/2000.");
+
+					result.BurstInterval = parseTime(times[0]);
+					result.BurstLength = parseTime(times[1]);
+				}
+				else if (name == "loss")
+					result.Loss = parsePercent(pair[1]);
+				else if (name == "latency")
+					result.Latency = parseTime(pair[1]);
+				else if (name == "jitter")
+					result.Jitter = parseTime(pair[1]);
+				else if (name == "dup")
+					result.Duplication = parsePercent(pair[1]);
+				else if (name == "reorder")
+					result.Reordering = parsePercent(pair[1]);
+				else if (name == "reorderdelay")
+					result.ReorderDelay = parseTime(pair[1]);
+				else
+					throw new FormatException(String.Format("Unknown setting \"{0}\".", pair[0]));
+			}
+
+			return result;
+		}
+
+		private static double parseNumber(string value)
+		{
+			double result;
+
+			if (!double.TryParse(value.Trim(), NumberStyles.Float, CultureInfo.InvariantCulture, out result) || result < 0)
+				throw new FormatException(String.Format("Invalid value \"{0}\".", value));
+
+			return result;
+		}
+
+		private static double parsePercent(string value)
+		{
+			double result = parseNumber(value);
+
+			if (result > 100)
+				throw new FormatException(String.Format("Invalid percentage \"{0}\".", value));
+
+			return result / 100;
+		}
+
+		private static TimeSpan parseTime(string value)
+		{
+			return TimeSpan.FromTicks((long)(parseNumber(value) * TimeSpan.TicksPerMillisecond));
+		}
+
+		/// <summary>
+		/// Returns the settings in the format of <see cref="Parse"/>.
+		/// </summary>
+		public override string ToString()
+		{
+			StringBuilder result = new StringBuilder();
+
+			result.AppendFormat(CultureInfo.InvariantCulture, "loss={0}", this.Loss * 100);
+
+			if (this.BurstInterval > TimeSpan.Zero && this.BurstLength > TimeSpan.Zero)
+				result.AppendFormat(CultureInfo.InvariantCulture, ",burst={0}/{1}", this.BurstInterval.TotalMilliseconds, this.BurstLength.TotalMilliseconds);
+
+			result.AppendFormat(CultureInfo.InvariantCulture, ",latency={0},jitter={1},dup={2},reorder={3},reorderdelay={4}",
+				this.Latency.TotalMilliseconds, this.Jitter.TotalMilliseconds, this.Duplication * 100, this.Reordering * 100,
+				this.ReorderDelay.TotalMilliseconds);
+
+			return result.ToString();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+﻿using System.Net.NetworkInformation;
+using System.Net.Sockets;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Result of transmitting a packet over a single network interface.
+	/// </summary>
+	public class InterfaceSendResult
+	{
+		/// <summary>
+		/// Gets the network interface.
+		/// </summary>
+		public NetworkInterface Interface
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of usable IP addresses of the interface, i.e. the number of packets which should be sent.
+		/// </summary>
+		public int Addresses
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of packets successfully sent.
+		/// </summary>
+		public int Sent
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the error of the first failed send or <see cref="SocketError.Success"/> if no send failed.
+		/// </summary>
+		public SocketError Error
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets a value indicating whether the packet was sent from all usable addresses of the interface.
+		/// </summary>
+		public bool Success
+		{
+			get
+			{
+				return this.Addresses > 0 && this.Sent == this.Addresses;
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the InterfaceSendResult class.
+		/// </summary>
+		/// <param name="interface">The network interface.</param>
+		internal InterfaceSendResult(NetworkInterface @interface)
+		{
+			this.Interface = @interface;
+			this.Error = SocketError.Success;
+		}
+
+		/// <summary>
+		/// Adds the result of the send from one address of the interface.
+		/// </summary>
+		/// <param name="error">The result of the send.</param>
+		internal void Add(SocketError error)
+		{
+			this.Addresses++;
+
+			if (error == SocketError.Success)
+				this.Sent++;
+			else if (this.Error == SocketError.Success)
+				this.Error = error;
+		}
+
+		/// <summary>
+		/// Returns a string that represents the current object.
+		/// </summary>
+		/// <returns>A string that represents the current object.</returns>
+		public override string ToString()
+		{
+			return string.Format("{0}: {1}/{2} sent{3}", this.Interface.Name, this.Sent, this.Addresses,
+				this.Error != SocketError.Success ? " (" + this.Error + ")" : "");
+		}
+	}
+}
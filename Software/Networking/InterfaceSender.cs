@@ -1,13 +1,35 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Net;
 using System.Net.NetworkInformation;
+using System.Net.Sockets;
+using System.Threading.Tasks;
 
 namespace BISS.Networking
 {
 	/// <summary>
 	/// Transmits a packet over a network interface.
 	/// </summary>
+	/// <remarks>
+	/// The packet is sent from every usable address of the interfaces to the directed broadcast address
+	/// of the address' subnet. All sends are issued at once: on Linux with a single batch send, otherwise
+	/// in parallel. So the time needed doesn't grow with the number of interfaces.
+	/// </remarks>
 	public class InterfaceSender : Sender
 	{
+		/// <summary>
+		/// A single send from an address of an interface.
+		/// </summary>
+		internal class Target
+		{
+			public InterfaceSendResult Interface;
+			public int InterfaceIndex;
+			public IPAddress Address;
+			public IPEndPoint Destination;
+			public SocketError Result;
+		}
+
 		/// <summary>
 		/// Transmit the specified packet using the network interface specified.
 		/// </summary>
@@ -31,43 +53,143 @@ namespace BISS.Networking
 				throw new ArgumentException(String.Format("The speficied interface ({0}) has no unicast address.",
 					@interface), "interface");
 
-			uint sent = 0;
+			return (uint)Send(packet, new NetworkInterface[] { @interface })[0].Sent;
+		}
+
+		/// <summary>
+		/// Transmit the specified packet over all available network interfaces on this system.
+		/// </summary>
+		/// <param name="packet">Packet to be transmitted.</param>
+		/// <returns>Number of packets successfully sent.</returns>
+		public uint Send(Packet packet)
+		{
+			return (uint)SendToAll(packet).Sum(r => r.Sent);
+		}
 
-			foreach (UnicastIPAddressInformation addr in props.UnicastAddresses)
+		/// <summary>
+		/// Transmit the specified packet over all available network interfaces on this system.
+		/// </summary>
+		/// <param name="packet">Packet to be transmitted.</param>
+		/// <returns>The result of each interface.</returns>
+		public IList<InterfaceSendResult> SendToAll(Packet packet)
+		{
+			// Ignore unsupported interfaces
+			NetworkInterface[] nis = NetworkInterface.GetAllNetworkInterfaces()
+				.Where(i => i.NetworkInterfaceType != NetworkInterfaceType.Loopback && i.OperationalStatus == OperationalStatus.Up)
+				.ToArray();
+
+			return Send(packet, nis);
+		}
+
+		/// <summary>
+		/// Transmit the specified packet over the specified interfaces at once.
+		/// </summary>
+		/// <param name="packet">Packet to be transmitted.</param>
+		/// <param name="interfaces">The network interfaces.</param>
+		/// <returns>The result of each interface, in the order of <paramref name="interfaces"/>.</returns>
+		private IList<InterfaceSendResult> Send(Packet packet, NetworkInterface[] interfaces)
+		{
+			if (packet == null)
+				throw new ArgumentNullException("packet");
+
+			List<InterfaceSendResult> results = new List<InterfaceSendResult>();
+			List<Target> targets = new List<Target>();
+
+			foreach (NetworkInterface @interface in interfaces)
 			{
-				// Check if the IP address is suitable.
-				if (IsUsableIPAddress(addr.Address))
+				InterfaceSendResult result = new InterfaceSendResult(@interface);
+				IPInterfaceProperties props = @interface.GetIPProperties();
+				int index;
+
+				results.Add(result);
+
+				try
 				{
-					if (base.Send(packet, addr.Address))
-						sent++;
+					index = props.GetIPv4Properties().Index;
+				}
+				catch (NetworkInformationException)
+				{
+					// IPv4 is not enabled on this interface.
+					continue;
+				}
+
+				foreach (UnicastIPAddressInformation addr in props.UnicastAddresses)
+				{
+					// Check if the IP address is suitable.
+					if (IsUsableIPAddress(addr.Address))
+					{
+						targets.Add(new Target()
+						{
+							Interface = result,
+							InterfaceIndex = index,
+							Address = addr.Address,
+							Destination = new IPEndPoint(GetDirectedBroadcast(addr), Port)
+						});
+					}
 				}
 			}
 
-			return sent;
+			if (targets.Count > 0 && !sendBatch(packet, targets))
+				Parallel.ForEach(targets, target => sendSingle(packet, target));
+
+			foreach (Target target in targets)
+				target.Interface.Add(target.Result);
+
+			return results;
 		}
 
 		/// <summary>
-		/// Transmit the specified packet over all available network interfaces on this system.
+		/// Sends the packet to all targets with a single batch send.
 		/// </summary>
-		/// <param name="packet">Packet to be transmitted.</param>
-		/// <returns>Number of packets successfully sent.</returns>
-		public uint Send(Packet packet)
+		/// <returns>FALSE if batch sends are not supported.</returns>
+		private bool sendBatch(Packet packet, IList<Target> targets)
 		{
-			NetworkInterface[] nis = NetworkInterface.GetAllNetworkInterfaces();
-			uint sent = 0;
+			if (!BatchSender.Supported)
+				return false;
 
-			foreach (NetworkInterface @interface in nis)
+			byte[] data = packet.GenerateDatagram(this.Authenticator);
+
+			using (UdpClient client = CreateClient())
 			{
-				// Ignore unsupported interfaces
-				if (@interface.NetworkInterfaceType == NetworkInterfaceType.Loopback)
-					continue;
-				if (@interface.OperationalStatus != OperationalStatus.Up)
-					continue;
+				client.EnableBroadcast = true;
+				client.Client.SetSocketOption(SocketOptionLevel.Socket, SocketOptionName.DontRoute, 1);
 
-				sent += Send(packet, @interface);
+				if (!BatchSender.Send(client.Client, data, targets))
+					return false;
 			}
 
-			return sent;
+			foreach (Target target in targets)
+			{
+				string localAddress = new IPEndPoint(target.Address, Port).ToString();
+
+				if (target.Result == SocketError.Success)
+					NetworkingEventSource.Log.PacketSent(localAddress);
+				else
+					NetworkingEventSource.Log.SendFailed(localAddress, target.Result.ToString());
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// Sends the packet from the address of the target with its own socket.
+		/// </summary>
+		private void sendSingle(Packet packet, Target target)
+		{
+			try
+			{
+				using (UdpClient client = CreateClient(target.Address))
+				{
+					client.EnableBroadcast = true;
+					client.Client.SetSocketOption(SocketOptionLevel.Socket, SocketOptionName.DontRoute, 1);
+
+					target.Result = Send(client, packet, target.Destination) ? SocketError.Success : SocketError.MessageSize;
+				}
+			}
+			catch (SocketException ex)
+			{
+				target.Result = ex.SocketErrorCode;
+			}
 		}
 	}
 }
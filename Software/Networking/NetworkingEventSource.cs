@@ -0,0 +1,261 @@
+﻿using System;
+using System.Diagnostics.Tracing;
+using System.Threading;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Provides the events and counters of the networking layer.
+	/// </summary>
+	/// <remarks>
+	/// The event source is named "BISS-Networking". On .NET Core the counters can be watched with
+	/// <c>dotnet-counters monitor --counters BISS-Networking</c>, the events can be recorded with
+	/// <c>dotnet-trace collect --providers BISS-Networking</c>.
+	/// </remarks>
+	[EventSource(Name = "BISS-Networking")]
+	public sealed class NetworkingEventSource : EventSource
+	{
+		/// <summary>
+		/// The single instance of the event source.
+		/// </summary>
+		public static readonly NetworkingEventSource Log = new NetworkingEventSource();
+
+		long packetsSent;
+		long sendFailures;
+		long packetsReceived;
+		long packetsFiltered;
+		long packetsThrottled;
+		// Rejected datagrams by ParseError, index 0 holds the total.
+		readonly long[] packetsRejected;
+
+#if NETCOREAPP
+		DiagnosticCounter[] counters;
+#endif
+
+		/// <summary>
+		/// Gets the number of packets sent.
+		/// </summary>
+		public long PacketsSent
+		{
+			get
+			{
+				return Interlocked.Read(ref this.packetsSent);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of packets which could not be sent.
+		/// </summary>
+		public long SendFailures
+		{
+			get
+			{
+				return Interlocked.Read(ref this.sendFailures);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of valid packets received, including the filtered ones.
+		/// </summary>
+		public long PacketsReceived
+		{
+			get
+			{
+				return Interlocked.Read(ref this.packetsReceived);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of received packets which were filtered as duplicates.
+		/// </summary>
+		public long PacketsFiltered
+		{
+			get
+			{
+				return Interlocked.Read(ref this.packetsFiltered);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of received datagrams which were dropped by the rate limit of their source.
+		/// </summary>
+		public long PacketsThrottled
+		{
+			get
+			{
+				return Interlocked.Read(ref this.packetsThrottled);
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of received datagrams which were not a valid packet.
+		/// </summary>
+		public long PacketsRejected
+		{
+			get
+			{
+				return Interlocked.Read(ref this.packetsRejected[0]);
+			}
+		}
+
+		private NetworkingEventSource()
+		{
+			// GetNames needs no instances of the enum created at runtime, so this works with native AOT, too.
+			this.packetsRejected = new long[Enum.GetNames(typeof(ParseError)).Length];
+		}
+
+		/// <summary>
+		/// Returns the number of received datagrams which were rejected for the specified reason.
+		/// </summary>
+		/// <param name="reason">The reason of the rejection.</param>
+		/// <returns>Number of rejected datagrams.</returns>
+		[NonEvent]
+		public long GetPacketsRejected(ParseError reason)
+		{
+			if (reason == ParseError.None)
+				throw new ArgumentOutOfRangeException("reason");
+
+			return Interlocked.Read(ref this.packetsRejected[(int)reason]);
+		}
+
+		/// <summary>
+		/// A packet was sent.
+		/// </summary>
+		/// <param name="localAddress">The local address used for sending.</param>
+		[Event(1, Level = EventLevel.Verbose)]
+		public void PacketSent(string localAddress)
+		{
+			Interlocked.Increment(ref this.packetsSent);
+
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(1, localAddress);
+		}
+
+		/// <summary>
+		/// A packet could not be sent.
+		/// </summary>
+		/// <param name="localAddress">The local address used for sending, which identifies the interface.</param>
+		/// <param name="error">Description of the error.</param>
+		[Event(2, Level = EventLevel.Warning)]
+		public void SendFailed(string localAddress, string error)
+		{
+			Interlocked.Increment(ref this.sendFailures);
+
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(2, localAddress, error);
+		}
+
+		/// <summary>
+		/// A valid packet was received.
+		/// </summary>
+		/// <param name="messageType">The message type of the packet.</param>
+		/// <param name="packetIdentifier">The identifier of the packet.</param>
+		[Event(3, Level = EventLevel.Verbose)]
+		public void PacketReceived(int messageType, int packetIdentifier)
+		{
+			Interlocked.Increment(ref this.packetsReceived);
+
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(3, messageType, packetIdentifier);
+		}
+
+		/// <summary>
+		/// A received datagram was not a valid packet.
+		/// </summary>
+		/// <param name="reason">Why the datagram was rejected.</param>
+		/// <param name="length">Length of the datagram in bytes.</param>
+		[Event(4, Level = EventLevel.Warning)]
+		public void PacketRejected(ParseError reason, int length)
+		{
+			Interlocked.Increment(ref this.packetsRejected[0]);
+			Interlocked.Increment(ref this.packetsRejected[(int)reason]);
+
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(4, (int)reason, length);
+		}
+
+		/// <summary>
+		/// A received packet was filtered, because it was already received before.
+		/// </summary>
+		/// <param name="packetIdentifier">The identifier of the packet.</param>
+		[Event(5, Level = EventLevel.Verbose)]
+		public void PacketFiltered(int packetIdentifier)
+		{
+			Interlocked.Increment(ref this.packetsFiltered);
+
+			if (IsEnabled(EventLevel.Verbose, EventKeywords.None))
+				WriteEvent(5, packetIdentifier);
+		}
+
+		/// <summary>
+		/// A source exceeded its rate limit. Raised once until the source is accepted again.
+		/// </summary>
+		/// <param name="source">Address of the source.</param>
+		[Event(6, Level = EventLevel.Warning)]
+		public void SourceThrottled(string source)
+		{
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(6, source);
+		}
+
+		/// <summary>
+		/// A received datagram was dropped by the rate limit of its source. Only counted, the
+		/// event is <see cref="SourceThrottled"/>.
+		/// </summary>
+		[NonEvent]
+		public void PacketThrottled()
+		{
+			Interlocked.Increment(ref this.packetsThrottled);
+		}
+
+		/// <summary>
+		/// The receive hub could not accept a subscriber. It tries again after a moment.
+		/// </summary>
+		/// <param name="error">Description of the error.</param>
+		[Event(7, Level = EventLevel.Warning)]
+		public void AcceptFailed(string error)
+		{
+			if (IsEnabled(EventLevel.Warning, EventKeywords.None))
+				WriteEvent(7, error);
+		}
+
+#if NETCOREAPP
+		/// <summary>
+		/// Creates the counters when a listener enables this event source.
+		/// </summary>
+		protected override void OnEventCommand(EventCommandEventArgs command)
+		{
+			if (command.Command != EventCommand.Enable || this.counters != null)
+				return;
+
+			this.counters = new DiagnosticCounter[]
+			{
+				rateCounter("packets-sent", "Packets Sent", () => PacketsSent),
+				rateCounter("send-failures", "Send Failures", () => SendFailures),
+				rateCounter("packets-received", "Packets Received", () => PacketsReceived),
+				rateCounter("packets-filtered", "Packets Filtered", () => PacketsFiltered),
+				rateCounter("packets-throttled", "Packets Throttled", () => PacketsThrottled),
+				rateCounter("packets-rejected", "Packets Rejected", () => PacketsRejected),
+				rateCounter("rejected-length", "Rejected: Length", () => GetPacketsRejected(ParseError.Length)),
+				rateCounter("rejected-stx", "Rejected: Start of Packet", () => GetPacketsRejected(ParseError.StartOfPacket)),
+				rateCounter("rejected-magic", "Rejected: Magic", () => GetPacketsRejected(ParseError.Magic)),
+				rateCounter("rejected-version", "Rejected: Protocol Version", () => GetPacketsRejected(ParseError.ProtocolVersion)),
+				rateCounter("rejected-etx", "Rejected: End of Packet", () => GetPacketsRejected(ParseError.EndOfPacket)),
+				rateCounter("rejected-authentication", "Rejected: Authentication", () => GetPacketsRejected(ParseError.Authentication)),
+				rateCounter("rejected-replay", "Rejected: Replay", () => GetPacketsRejected(ParseError.Replay)),
+				rateCounter("rejected-unauthenticated", "Rejected: Unauthenticated", () => GetPacketsRejected(ParseError.Unauthenticated)),
+				rateCounter("rejected-fire-at", "Rejected: Fire At", () => GetPacketsRejected(ParseError.FireAt))
+			};
+		}
+
+		private IncrementingPollingCounter rateCounter(string name, string displayName, Func<double> value)
+		{
+			return new IncrementingPollingCounter(name, this, value)
+			{
+				DisplayName = displayName,
+				DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+			};
+		}
+#endif
+	}
+}
@@ -1,4 +1,6 @@
-﻿namespace BISS.Networking
+﻿using System;
+
+namespace BISS.Networking
 {
 	/// <summary>
 	/// Represents a single transmission packet of the BISS protocol.
@@ -7,6 +9,9 @@
 	{
 		readonly MessageType messageType;
 		readonly ushort packetIdentifier;
+		readonly bool authenticated;
+		readonly DateTime? fireAt;
+		byte[] datagram;
 
 		/// <summary>
 		/// Gets the message type of this packet.
@@ -30,20 +35,113 @@
 			}
 		}
 
+		/// <summary>
+		/// Gets a value indicating whether the tag of this packet was verified with a <see cref="PacketAuthenticator"/>.
+		/// </summary>
+		public bool Authenticated
+		{
+			get
+			{
+				return this.authenticated;
+			}
+		}
+
+		/// <summary>
+		/// Gets the time (UTC) when the receivers shall trigger, or NULL if they trigger at once.
+		/// </summary>
+		/// <remarks>
+		/// The receivers convert this time into the time of their devices, so all devices start
+		/// at the same time. This requires synchronized clocks of the hosts, e.g. by NTP.
+		/// </remarks>
+		public DateTime? FireAt
+		{
+			get
+			{
+				return this.fireAt;
+			}
+		}
+
+		/// <summary>
+		/// Length of the packet in bytes
+		/// </summary>
+		internal const int Length = 10;
+
 		/// <summary>
 		/// First byte of the packet
 		/// </summary>
-		const byte StartOfPacket = 0x02;	// STX;
+		internal const byte StartOfPacket = 0x02;	// STX;
 
 		/// <summary>
 		/// Last byte of the packet
 		/// </summary>
-		const byte EndOfPacket = 0x03;		// ETX;
+		internal const byte EndOfPacket = 0x03;		// ETX;
 
 		/// <summary>
 		/// Protocol version used
 		/// </summary>
-		const byte ProtocolVersion = 0x01;
+		internal const byte ProtocolVersion = 0x01;
+
+		/// <summary>
+		/// Length of an authenticated packet in bytes
+		/// </summary>
+		internal const int AuthenticatedLength = 22;
+
+		/// <summary>
+		/// Protocol version of authenticated packets
+		/// </summary>
+		internal const byte AuthenticatedVersion = 0x02;
+
+		/// <summary>
+		/// Length of a scheduled packet in bytes
+		/// </summary>
+		internal const int ScheduledLength = 16;
+
+		/// <summary>
+		/// Protocol version of scheduled packets
+		/// </summary>
+		internal const byte ScheduledVersion = 0x03;
+
+		/// <summary>
+		/// Length of an authenticated and scheduled packet in bytes
+		/// </summary>
+		internal const int AuthenticatedScheduledLength = 28;
+
+		/// <summary>
+		/// Protocol version of authenticated and scheduled packets
+		/// </summary>
+		internal const byte AuthenticatedScheduledVersion = 0x04;
+
+		/// <summary>
+		/// Offset of the time to fire at (milliseconds since 1970-01-01 UTC, 48 bits) in a scheduled packet
+		/// </summary>
+		internal const int FireAtOffset = 9;
+
+		/// <summary>
+		/// Length of the time to fire at in bytes
+		/// </summary>
+		internal const int FireAtLength = 6;
+
+		/// <summary>
+		/// Length of the send time in an authenticated packet; it is followed by the tag
+		/// </summary>
+		internal const int TimestampLength = 4;
+
+		/// <summary>
+		/// Length of the truncated HMAC in bytes; it is followed by the end byte
+		/// </summary>
+		internal const int TagLength = 8;
+
+		/// <summary>
+		/// Lengths of the packets of all protocol versions
+		/// </summary>
+		internal static readonly int[] Lengths = new int[] { Length, AuthenticatedLength, ScheduledLength, AuthenticatedScheduledLength };
+
+		/// <summary>
+		/// Protocol versions, in the same order as <see cref="Lengths"/>
+		/// </summary>
+		internal static readonly byte[] Versions = new byte[] { ProtocolVersion, AuthenticatedVersion, ScheduledVersion, AuthenticatedScheduledVersion };
+
+		static readonly DateTime epoch = new DateTime(1970, 1, 1, 0, 0, 0, DateTimeKind.Utc);
 
 		/// <summary>
 		/// Magic string
@@ -62,13 +160,102 @@
 			this.packetIdentifier = packetIdentifier;
 		}
 
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Packet"/> class with the specified
+		/// message type, packet identifier and time to trigger.
+		/// </summary>
+		/// <param name="messageType">Message type of this packet.</param>
+		/// <param name="packetIdentifier">Packet identifier of this packet.</param>
+		/// <param name="fireAt">Time when the receivers shall trigger, or NULL if they trigger at once.</param>
+		public Packet(MessageType messageType, ushort packetIdentifier, DateTime? fireAt)
+			: this(messageType, packetIdentifier)
+		{
+			if (fireAt.HasValue)
+				this.fireAt = fireAt.Value.ToUniversalTime();
+		}
+
+		private Packet(MessageType messageType, ushort packetIdentifier, DateTime? fireAt, bool authenticated)
+			: this(messageType, packetIdentifier, fireAt)
+		{
+			this.authenticated = authenticated;
+		}
+
+		/// <summary>
+		/// Gets the raw bytes this packet was parsed from, or NULL if it was not received.
+		/// </summary>
+		internal byte[] Datagram
+		{
+			get
+			{
+				return this.datagram;
+			}
+		}
+
+		/// <summary>
+		/// Gets the protocol version of a packet.
+		/// </summary>
+		/// <param name="length">Length of the packet in bytes.</param>
+		/// <returns>The protocol version, or zero if the length is invalid.</returns>
+		private static byte getVersion(int length)
+		{
+			int index = Array.IndexOf(Lengths, length);
+
+			return index < 0 ? (byte)0 : Versions[index];
+		}
+
+		/// <summary>
+		/// Reads the time to trigger of a packet.
+		/// </summary>
+		/// <param name="datagram">Raw bytes representing the packet.</param>
+		/// <param name="version">Protocol version of the packet.</param>
+		/// <param name="fireAt">The time to trigger, or NULL if the packet triggers at once.</param>
+		/// <returns>FALSE if the time is out of range.</returns>
+		private static bool readFireAt(byte[] datagram, byte version, out DateTime? fireAt)
+		{
+			long milliseconds = 0;
+
+			fireAt = null;
+
+			if (version != ScheduledVersion && version != AuthenticatedScheduledVersion)
+				return true;
+
+			for (int a = 0; a < FireAtLength; a++)
+				milliseconds = milliseconds << 8 | datagram[FireAtOffset + a];
+
+			if (milliseconds > (long)(DateTime.MaxValue - epoch).TotalMilliseconds)
+				return false;
+
+			if (milliseconds != 0)
+				fireAt = epoch.AddMilliseconds(milliseconds);
+
+			return true;
+		}
+
 		/// <summary>
 		/// Generates the raw bytes of the packet for transmission over the network.
 		/// </summary>
 		/// <returns>Raw bytes of the packet.</returns>
 		internal byte[] GenerateDatagram()
 		{
-			byte[] data = new byte[10];
+			return GenerateDatagram(null);
+		}
+
+		/// <summary>
+		/// Generates the raw bytes of the packet for transmission over the network.
+		/// </summary>
+		/// <param name="authenticator">Signs the packet, or NULL for an unauthenticated packet.</param>
+		/// <returns>Raw bytes of the packet.</returns>
+		internal byte[] GenerateDatagram(PacketAuthenticator authenticator)
+		{
+			if (this.fireAt.HasValue)
+				return generate(authenticator != null ? AuthenticatedScheduledLength : ScheduledLength, authenticator);
+			else
+				return generate(authenticator != null ? AuthenticatedLength : Length, authenticator);
+		}
+
+		private byte[] generate(int length, PacketAuthenticator authenticator)
+		{
+			byte[] data = new byte[length];
 
 			// Start
 			data[0] = StartOfPacket;
@@ -80,7 +267,7 @@
 			data[4] = (byte)Magic[3];
 
 			// Used protocol version
-			data[5] = ProtocolVersion;
+			data[5] = getVersion(data.Length);
 
 			// Packet identifier
 			data[6] = (byte)(this.packetIdentifier >> 8);
@@ -89,8 +276,21 @@
 			// Message type
 			data[8] = (byte)this.messageType;
 
+			// Time to trigger; zero means at once, so earlier times are sent as the earliest time.
+			if (this.fireAt.HasValue)
+			{
+				long milliseconds = Math.Max(1, (long)(this.fireAt.Value - epoch).TotalMilliseconds);
+
+				for (int a = 0; a < FireAtLength; a++)
+					data[FireAtOffset + a] = (byte)(milliseconds >> (40 - a * 8));
+			}
+
 			// End
-			data[9] = EndOfPacket;
+			data[data.Length - 1] = EndOfPacket;
+
+			// Time and tag
+			if (authenticator != null)
+				authenticator.Sign(data);
 
 			return data;
 		}
@@ -102,32 +302,81 @@
 		/// <returns>Instance of <see cref="Packet"/> or NULL if the conversion was unsuccessfull.</returns>
 		public static Packet Parse(byte[] datagram)
 		{
+			ParseError error;
+
+			return Parse(datagram, out error);
+		}
+
+		/// <summary>
+		/// Converts the raw data bytes into a packet.
+		/// </summary>
+		/// <param name="datagram">Raw bytes representing the packet.</param>
+		/// <param name="error">Reason why the conversion was unsuccessfull.</param>
+		/// <returns>Instance of <see cref="Packet"/> or NULL if the conversion was unsuccessfull.</returns>
+		public static Packet Parse(byte[] datagram, out ParseError error)
+		{
+			return Parse(datagram, null, out error);
+		}
+
+		/// <summary>
+		/// Converts the raw data bytes into a packet and verifies its authenticity.
+		/// </summary>
+		/// <param name="datagram">Raw bytes representing the packet.</param>
+		/// <param name="authenticator">Verifies the packet. If NULL, authenticated packets are accepted
+		/// without verifying them; otherwise unauthenticated packets are rejected.</param>
+		/// <param name="error">Reason why the conversion was unsuccessfull.</param>
+		/// <returns>Instance of <see cref="Packet"/> or NULL if the conversion was unsuccessfull.</returns>
+		public static Packet Parse(byte[] datagram, PacketAuthenticator authenticator, out ParseError error)
+		{
+			DateTime? fireAt = null;
+			error = ParseError.None;
+
 			// Wrong length
-			if (datagram.Length != 10)
-				return null;
+			byte version = getVersion(datagram.Length);
+
+			if (version == 0)
+				error = ParseError.Length;
 
 			// Wrong start byte
-			if (datagram[0] != StartOfPacket)
-				return null;
+			else if (datagram[0] != StartOfPacket)
+				error = ParseError.StartOfPacket;
 
 			// Wrong magic bytes
-			if (datagram[1] != (byte)Magic[0] || datagram[2] != (byte)Magic[1]
+			else if (datagram[1] != (byte)Magic[0] || datagram[2] != (byte)Magic[1]
 				|| datagram[3] != (byte)Magic[2] || datagram[4] != (byte)Magic[3])
-				return null;
+				error = ParseError.Magic;
 
 			// Unsupported protocol version
-			if (datagram[5] != ProtocolVersion)
-				return null;
+			else if (datagram[5] != version)
+				error = ParseError.ProtocolVersion;
 
 			// Wrong end byte
-			if (datagram[9] != EndOfPacket)
+			else if (datagram[datagram.Length - 1] != EndOfPacket)
+				error = ParseError.EndOfPacket;
+
+			// Time to trigger out of range
+			else if (!readFireAt(datagram, version, out fireAt))
+				error = ParseError.FireAt;
+
+			// Unauthenticated packet, but authentication is required
+			else if (authenticator != null && (version == ProtocolVersion || version == ScheduledVersion))
+				error = ParseError.Unauthenticated;
+
+			// Forged or replayed packet
+			else if (authenticator != null)
+				error = authenticator.Verify(datagram);
+
+			if (error != ParseError.None)
 				return null;
 
 			MessageType messageType = (MessageType)datagram[8];
 			ushort packetIdentifier = (ushort)(datagram[6] << 8);
 			packetIdentifier += datagram[7];
 
-			return new Packet(messageType, packetIdentifier);
+			Packet result = new Packet(messageType, packetIdentifier, fireAt, authenticator != null);
+			result.datagram = datagram;
+
+			return result;
 		}
 	}
 }
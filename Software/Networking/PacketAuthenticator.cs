@@ -0,0 +1,440 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.CompilerServices;
+using System.Security.Cryptography;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Signs and verifies authenticated packets (protocol versions 2 and 4) with a shared key.
+	/// </summary>
+	/// <remarks>
+	/// <para>An authenticated packet carries the time of its transmission (seconds since 1970, UTC)
+	/// and the first 8 bytes of the HMAC-SHA256 of the packet up to and including this time.
+	/// Packets outside of the <see cref="ReplayWindow"/> and packets which were already accepted are
+	/// rejected as replays. The tag of an accepted packet is remembered until its time left the
+	/// window, so a replay is always rejected by one of both checks.</para>
+	/// <para>The SHA-256 states after hashing the inner and outer key block are computed once, so
+	/// verifying a tag only takes two SHA-256 block operations. These are specialized for the
+	/// mostly padded blocks of short messages and unrolled. All buffers are on the stack, verifying
+	/// allocates nothing once the set of accepted tags has grown to the traffic of a window.</para>
+	/// </remarks>
+	public class PacketAuthenticator
+	{
+		/// <summary>
+		/// Minimum length of the key in bytes.
+		/// </summary>
+		public const int MinimumKeyLength = 16;
+
+		/// <summary>
+		/// Block size of SHA-256 in bytes.
+		/// </summary>
+		const int blockSize = 64;
+
+		/// <summary>
+		/// Maximum number of tags remembered. Tags are forgotten when their time left the
+		/// <see cref="ReplayWindow"/>, this only bounds the memory if more packets are accepted within it.
+		/// </summary>
+		const int acceptedCapacity = 16384;
+
+		static readonly uint[] initialState = new uint[]
+		{
+			0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+		};
+
+		static readonly DateTime epoch = new DateTime(1970, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+
+		// SHA-256 states after the key XOR ipad and the key XOR opad block.
+		readonly uint[] innerState;
+		readonly uint[] outerState;
+		// Tags of the accepted packets, and the same tags with the time they may be forgotten
+		// (seconds since 1970) in the order of this time.
+		readonly HashSet<ulong> accepted;
+		readonly Queue<KeyValuePair<ulong, long>> acceptedExpiry;
+		readonly object lockObject;
+		long lastExpiry;
+
+		/// <summary>
+		/// Gets or sets the maximum difference between the time of a packet and the local time.
+		/// Defaults to 30 seconds. The clocks of senders and receivers must be synchronised this well.
+		/// </summary>
+		public TimeSpan ReplayWindow
+		{ get; set; } = TimeSpan.FromSeconds(30);
+
+		/// <summary>
+		/// Initializes a new instance of the PacketAuthenticator class.
+		/// </summary>
+		/// <param name="key">The key shared by all senders and receivers.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="key"/> was NULL.</exception>
+		/// <exception cref="ArgumentException">The key is shorter than <see cref="MinimumKeyLength"/>.</exception>
+		public PacketAuthenticator(byte[] key)
+		{
+			if (key == null)
+				throw new ArgumentNullException("key");
+			if (key.Length < MinimumKeyLength)
+				throw new ArgumentException(String.Format("The key must have at least {0} bytes.", MinimumKeyLength), "key");
+
+			// Keys longer than a block are hashed first (RFC 2104).
+			if (key.Length > blockSize)
+			{
+				using (SHA256 sha = SHA256.Create())
+				{
+					key = sha.ComputeHash(key);
+				}
+			}
+
+			this.innerState = keyState(key, 0x36);
+			this.outerState = keyState(key, 0x5c);
+			this.accepted = new HashSet<ulong>();
+			this.acceptedExpiry = new Queue<KeyValuePair<ulong, long>>();
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Creates an instance with the key read from a file. The file contains the key in Base64.
+		/// </summary>
+		/// <param name="path">Path of the key file.</param>
+		/// <returns>Instance of <see cref="PacketAuthenticator"/>.</returns>
+		/// <exception cref="FormatException">The file doesn't contain Base64.</exception>
+		public static PacketAuthenticator FromKeyFile(string path)
+		{
+			return new PacketAuthenticator(Convert.FromBase64String(File.ReadAllText(path).Trim()));
+		}
+
+		/// <summary>
+		/// Returns the SHA-256 state after hashing the padded key XOR the specified byte.
+		/// </summary>
+		private static unsafe uint[] keyState(byte[] key, byte pad)
+		{
+			uint[] result = (uint[])initialState.Clone();
+			uint* w = stackalloc uint[64];
+
+			for (int a = 0; a < blockSize; a++)
+				w[a / 4] = w[a / 4] << 8 | (byte)((a < key.Length ? key[a] : 0) ^ pad);
+
+			expand(w, 16);
+
+			fixed (uint* state = result)
+			{
+				rounds(state, w);
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Returns the current time in seconds since 1970.
+		/// </summary>
+		private static uint now()
+		{
+			return (uint)(DateTime.UtcNow - epoch).TotalSeconds;
+		}
+
+		/// <summary>
+		/// Computes the message schedule words from <paramref name="start"/> to 63.
+		/// </summary>
+		/// <param name="w">The 64 words of the message schedule, the first 16 are the block.</param>
+		/// <param name="start">Index of the first word computed.</param>
+		private static unsafe void expand(uint* w, int start)
+		{
+			for (int a = start; a < 64; a++)
+				w[a] = w[a - 16] + sigma0(w[a - 15]) + w[a - 7] + sigma1(w[a - 2]);
+		}
+
+		/// <summary>
+		/// Computes the message schedule of a padded block whose words 9 to 14 are zero, like the
+		/// blocks of short messages. The terms of the zero words are left out of the first 16
+		/// computed words, the others only depend on computed words anyway.
+		/// </summary>
+		/// <param name="w">The 64 words of the message schedule, the first 16 are the block.</param>
+		private static unsafe void expandPadded(uint* w)
+		{
+			w[16] = w[0] + sigma0(w[1]);
+			w[17] = w[1] + sigma0(w[2]) + sigma1(w[15]);
+			w[18] = w[2] + sigma0(w[3]) + sigma1(w[16]);
+			w[19] = w[3] + sigma0(w[4]) + sigma1(w[17]);
+			w[20] = w[4] + sigma0(w[5]) + sigma1(w[18]);
+			w[21] = w[5] + sigma0(w[6]) + sigma1(w[19]);
+			w[22] = w[6] + sigma0(w[7]) + w[15] + sigma1(w[20]);
+			w[23] = w[7] + sigma0(w[8]) + w[16] + sigma1(w[21]);
+			w[24] = w[8] + w[17] + sigma1(w[22]);
+			w[25] = w[18] + sigma1(w[23]);
+			w[26] = w[19] + sigma1(w[24]);
+			w[27] = w[20] + sigma1(w[25]);
+			w[28] = w[21] + sigma1(w[26]);
+			w[29] = w[22] + sigma1(w[27]);
+			w[30] = sigma0(w[15]) + w[23] + sigma1(w[28]);
+			w[31] = w[15] + sigma0(w[16]) + w[24] + sigma1(w[29]);
+			expand(w, 32);
+		}
+
+		/// <summary>
+		/// Runs the 64 rounds of SHA-256 over a message schedule and adds the result to the state.
+		/// The rounds are unrolled, so the round constants are immediates and the working variables
+		/// are renamed instead of moved: each round only updates the new a and e, which are stored
+		/// in the variables of the old h and d.
+		/// </summary>
+		/// <param name="state">The 8 words of the hash state, which are updated.</param>
+		/// <param name="w">The 64 words of the message schedule.</param>
+		private static unsafe void rounds(uint* state, uint* w)
+		{
+			uint a = state[0], b = state[1], c = state[2], d = state[3];
+			uint e = state[4], f = state[5], g = state[6], h = state[7];
+
+			h += sum1(e) + choose(e, f, g) + 0x428a2f98 + w[0]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0x71374491 + w[1]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0xb5c0fbcf + w[2]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0xe9b5dba5 + w[3]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x3956c25b + w[4]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0x59f111f1 + w[5]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x923f82a4 + w[6]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0xab1c5ed5 + w[7]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0xd807aa98 + w[8]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0x12835b01 + w[9]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0x243185be + w[10]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0x550c7dc3 + w[11]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x72be5d74 + w[12]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0x80deb1fe + w[13]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x9bdc06a7 + w[14]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0xc19bf174 + w[15]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0xe49b69c1 + w[16]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0xefbe4786 + w[17]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0x0fc19dc6 + w[18]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0x240ca1cc + w[19]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x2de92c6f + w[20]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0x4a7484aa + w[21]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x5cb0a9dc + w[22]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0x76f988da + w[23]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0x983e5152 + w[24]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0xa831c66d + w[25]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0xb00327c8 + w[26]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0xbf597fc7 + w[27]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0xc6e00bf3 + w[28]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0xd5a79147 + w[29]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x06ca6351 + w[30]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0x14292967 + w[31]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0x27b70a85 + w[32]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0x2e1b2138 + w[33]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0x4d2c6dfc + w[34]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0x53380d13 + w[35]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x650a7354 + w[36]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0x766a0abb + w[37]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x81c2c92e + w[38]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0x92722c85 + w[39]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0xa2bfe8a1 + w[40]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0xa81a664b + w[41]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0xc24b8b70 + w[42]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0xc76c51a3 + w[43]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0xd192e819 + w[44]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0xd6990624 + w[45]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0xf40e3585 + w[46]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0x106aa070 + w[47]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0x19a4c116 + w[48]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0x1e376c08 + w[49]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0x2748774c + w[50]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0x34b0bcb5 + w[51]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x391c0cb3 + w[52]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0x4ed8aa4a + w[53]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0x5b9cca4f + w[54]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0x682e6ff3 + w[55]; e += a; a += sum0(b) + majority(b, c, d);
+
+			h += sum1(e) + choose(e, f, g) + 0x748f82ee + w[56]; d += h; h += sum0(a) + majority(a, b, c);
+			g += sum1(d) + choose(d, e, f) + 0x78a5636f + w[57]; c += g; g += sum0(h) + majority(h, a, b);
+			f += sum1(c) + choose(c, d, e) + 0x84c87814 + w[58]; b += f; f += sum0(g) + majority(g, h, a);
+			e += sum1(b) + choose(b, c, d) + 0x8cc70208 + w[59]; a += e; e += sum0(f) + majority(f, g, h);
+			d += sum1(a) + choose(a, b, c) + 0x90befffa + w[60]; h += d; d += sum0(e) + majority(e, f, g);
+			c += sum1(h) + choose(h, a, b) + 0xa4506ceb + w[61]; g += c; c += sum0(d) + majority(d, e, f);
+			b += sum1(g) + choose(g, h, a) + 0xbef9a3f7 + w[62]; f += b; b += sum0(c) + majority(c, d, e);
+			a += sum1(f) + choose(f, g, h) + 0xc67178f2 + w[63]; e += a; a += sum0(b) + majority(b, c, d);
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
+			state[5] += f;
+			state[6] += g;
+			state[7] += h;
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint sum0(uint value)
+		{
+			return rotate(value, 2) ^ rotate(value, 13) ^ rotate(value, 22);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint sum1(uint value)
+		{
+			return rotate(value, 6) ^ rotate(value, 11) ^ rotate(value, 25);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint choose(uint x, uint y, uint z)
+		{
+			return z ^ (x & (y ^ z));
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint majority(uint x, uint y, uint z)
+		{
+			return (x & y) | (z & (x | y));
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint sigma0(uint value)
+		{
+			return rotate(value, 7) ^ rotate(value, 18) ^ (value >> 3);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint sigma1(uint value)
+		{
+			return rotate(value, 17) ^ rotate(value, 19) ^ (value >> 10);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static uint rotate(uint value, int count)
+		{
+			return value >> count | value << (32 - count);
+		}
+
+		/// <summary>
+		/// Computes the truncated HMAC-SHA256 of the first bytes of the datagram.
+		/// </summary>
+		/// <remarks>
+		/// Both blocks hashed after the key blocks are mostly padding: the inner one holds the message
+		/// in its first 5 words, the outer one the inner hash in its first 8 words. The words in between
+		/// are zero and the last one is the constant length, so <see cref="expandPadded"/> leaves them out.
+		/// </remarks>
+		/// <param name="datagram">The datagram.</param>
+		/// <param name="length">Number of bytes authenticated; must be less than 20.</param>
+		/// <returns>The first 8 bytes of the HMAC in big endian order.</returns>
+		private unsafe ulong computeTag(byte[] datagram, int length)
+		{
+			uint* state = stackalloc uint[8];
+			uint* w = stackalloc uint[64];
+
+			// Inner hash: the message and its padding fill the first words of the block after the key block.
+			for (int a = 0; a < 16; a++)
+				w[a] = 0;
+			for (int a = 0; a < length; a++)
+				w[a / 4] |= (uint)datagram[a] << (24 - a % 4 * 8);
+			w[length / 4] |= 0x80u << (24 - length % 4 * 8);
+			w[15] = (uint)(blockSize + length) * 8;
+
+			expandPadded(w);
+
+			fixed (uint* inner = this.innerState, outer = this.outerState)
+			{
+				for (int a = 0; a < 8; a++)
+					state[a] = inner[a];
+				rounds(state, w);
+
+				// Outer hash over the 32 byte inner hash, the rest of the block is constant padding.
+				for (int a = 0; a < 8; a++)
+				{
+					w[a] = state[a];
+					state[a] = outer[a];
+				}
+				w[8] = 0x80000000;
+				for (int a = 9; a < 15; a++)
+					w[a] = 0;
+				w[15] = (blockSize + 32) * 8;
+
+				expandPadded(w);
+				rounds(state, w);
+			}
+
+			return (ulong)state[0] << 32 | state[1];
+		}
+
+		/// <summary>
+		/// Writes the current time and the tag into an authenticated datagram.
+		/// </summary>
+		/// <param name="datagram">The datagram with all other fields set.</param>
+		internal void Sign(byte[] datagram)
+		{
+			uint timestamp = now();
+			int tagOffset = getTagOffset(datagram);
+			int timestampOffset = tagOffset - Packet.TimestampLength;
+
+			datagram[timestampOffset] = (byte)(timestamp >> 24);
+			datagram[timestampOffset + 1] = (byte)(timestamp >> 16);
+			datagram[timestampOffset + 2] = (byte)(timestamp >> 8);
+			datagram[timestampOffset + 3] = (byte)timestamp;
+
+			ulong tag = computeTag(datagram, tagOffset);
+
+			for (int a = 0; a < Packet.TagLength; a++)
+				datagram[tagOffset + a] = (byte)(tag >> (56 - a * 8));
+		}
+
+		/// <summary>
+		/// Gets the offset of the tag; the time and the tag are at the end of the datagram, right before ETX.
+		/// </summary>
+		private static int getTagOffset(byte[] datagram)
+		{
+			return datagram.Length - 1 - Packet.TagLength;
+		}
+
+		/// <summary>
+		/// Verifies the time and the tag of an authenticated datagram. The framing must be checked already.
+		/// </summary>
+		/// <param name="datagram">The datagram.</param>
+		/// <returns>The reason of the rejection or <see cref="ParseError.None"/> if the datagram is authentic.</returns>
+		internal ParseError Verify(byte[] datagram)
+		{
+			if (datagram.Length != Packet.AuthenticatedLength && datagram.Length != Packet.AuthenticatedScheduledLength)
+				return ParseError.Unauthenticated;
+
+			int tagOffset = getTagOffset(datagram);
+			int timestampOffset = tagOffset - Packet.TimestampLength;
+
+			// Checking the time is cheap, so old packets are rejected before computing the HMAC.
+			uint timestamp = (uint)(datagram[timestampOffset] << 24 | datagram[timestampOffset + 1] << 16
+				| datagram[timestampOffset + 2] << 8 | datagram[timestampOffset + 3]);
+
+			long current = now();
+			long window = (long)ReplayWindow.TotalSeconds;
+
+			if (Math.Abs(timestamp - current) > window)
+				return ParseError.Replay;
+
+			ulong received = 0;
+			for (int a = 0; a < Packet.TagLength; a++)
+				received = received << 8 | datagram[tagOffset + a];
+
+			// Compare all bits at once, so the time doesn't reveal how many bytes matched.
+			if ((computeTag(datagram, tagOffset) ^ received) != 0)
+				return ParseError.Authentication;
+
+			lock (this.lockObject)
+			{
+				// Forget the tags whose time left the window, the packets are rejected by their time now
+				while (this.acceptedExpiry.Count > 0 && this.acceptedExpiry.Peek().Value < current)
+					this.accepted.Remove(this.acceptedExpiry.Dequeue().Key);
+
+				if (this.accepted.Contains(received))
+					return ParseError.Replay;
+
+				if (this.acceptedExpiry.Count == acceptedCapacity)
+					this.accepted.Remove(this.acceptedExpiry.Dequeue().Key);
+
+				// The times of the packets are not in order, a tag is kept at least until its own time
+				// left the window and as long as the tags before it, so the queue stays ordered.
+				this.lastExpiry = Math.Max(this.lastExpiry, timestamp + window);
+				this.accepted.Add(received);
+				this.acceptedExpiry.Enqueue(new KeyValuePair<ulong, long>(received, this.lastExpiry));
+			}
+
+			return ParseError.None;
+		}
+	}
+}
@@ -43,5 +43,21 @@ namespace BISS.Networking
 
 			return new Packet(messageType, BitConverter.ToUInt16(rand, 0));
 		}
+
+		/// <summary>
+		/// Builds a packet of the BISS protocol using the message type specified
+		/// in <paramref name="messageType"/>, which triggers all receivers at the same time.
+		/// </summary>
+		/// <param name="messageType">Message type for this packet.</param>
+		/// <param name="fireDelay">Time from now until the receivers trigger. It must be longer
+		/// than the packet takes to reach all receivers.</param>
+		/// <returns>Packet with the specified information encapsulated.</returns>
+		public Packet Build(MessageType messageType, TimeSpan fireDelay)
+		{
+			byte[] rand = new byte[2];
+			this.random.NextBytes(rand);
+
+			return new Packet(messageType, BitConverter.ToUInt16(rand, 0), DateTime.UtcNow + fireDelay);
+		}
 	}
 }
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Diagnostics;
 
 namespace BISS.Networking
 {
@@ -13,6 +14,25 @@ namespace BISS.Networking
 		public Packet ReceivedPacket
 		{ get; private set; }
 
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the datagram was received.
+		/// </summary>
+		public long ReceivedTimestamp
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the datagram was parsed.
+		/// </summary>
+		public long ParsedTimestamp
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the <see cref="Stopwatch"/> timestamp when the packet was accepted, i.e. after
+		/// duplicates were filtered.
+		/// </summary>
+		public long AcceptedTimestamp
+		{ get; private set; }
+
 		/// <summary>
 		/// Initializes a new instance of the <see cref="PacketReceivedEventArgs"/> class.
 		/// </summary>
@@ -23,6 +43,22 @@ namespace BISS.Networking
 				throw new ArgumentNullException("receivedPacket");
 
 			this.ReceivedPacket = receivedPacket;
+			this.ReceivedTimestamp = this.ParsedTimestamp = this.AcceptedTimestamp = Stopwatch.GetTimestamp();
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="PacketReceivedEventArgs"/> class.
+		/// </summary>
+		/// <param name="receivedPacket">Instance of the packet which was received.</param>
+		/// <param name="receivedTimestamp"><see cref="Stopwatch"/> timestamp when the datagram was received.</param>
+		/// <param name="parsedTimestamp"><see cref="Stopwatch"/> timestamp when the datagram was parsed.</param>
+		/// <param name="acceptedTimestamp"><see cref="Stopwatch"/> timestamp when the packet was accepted.</param>
+		public PacketReceivedEventArgs(Packet receivedPacket, long receivedTimestamp, long parsedTimestamp, long acceptedTimestamp)
+			: this(receivedPacket)
+		{
+			this.ReceivedTimestamp = receivedTimestamp;
+			this.ParsedTimestamp = parsedTimestamp;
+			this.AcceptedTimestamp = acceptedTimestamp;
 		}
 	}
 }
@@ -0,0 +1,49 @@
+﻿namespace BISS.Networking
+{
+	/// <summary>
+	/// Specifies why a datagram could not be converted into a packet.
+	/// </summary>
+	public enum ParseError
+	{
+		/// <summary>
+		/// The datagram is a valid packet.
+		/// </summary>
+		None = 0,
+		/// <summary>
+		/// The datagram has the wrong length.
+		/// </summary>
+		Length,
+		/// <summary>
+		/// The first byte is not STX.
+		/// </summary>
+		StartOfPacket,
+		/// <summary>
+		/// The magic string is wrong.
+		/// </summary>
+		Magic,
+		/// <summary>
+		/// The protocol version is not supported.
+		/// </summary>
+		ProtocolVersion,
+		/// <summary>
+		/// The last byte is not ETX.
+		/// </summary>
+		EndOfPacket,
+		/// <summary>
+		/// The tag of an authenticated packet is wrong.
+		/// </summary>
+		Authentication,
+		/// <summary>
+		/// The authenticated packet is too old or was already received.
+		/// </summary>
+		Replay,
+		/// <summary>
+		/// The packet is not authenticated, but authentication is required.
+		/// </summary>
+		Unauthenticated,
+		/// <summary>
+		/// The time to trigger of a scheduled packet is out of range.
+		/// </summary>
+		FireAt
+	}
+}
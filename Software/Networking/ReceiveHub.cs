@@ -0,0 +1,310 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Net.Sockets;
+using System.Threading;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Receives the BISS packets once per host and distributes them to the local subscribers.
+	/// </summary>
+	/// <remarks>
+	/// Without a hub every process on the host has its own UDP socket and parses and deduplicates
+	/// every datagram. The hub owns the single socket and forwards the accepted packets over a Unix
+	/// domain socket. Subscribers connect with <see cref="HubTransport.Connect"/>, so they are
+	/// only woken up for valid packets which were not received before.
+	/// <para>The hub forwards the datagrams as received, including the tags of authenticated packets.
+	/// A subscriber with an authenticator verifies them itself, so a hub without the key can't make it
+	/// accept unauthenticated packets.</para>
+	/// </remarks>
+	public class ReceiveHub : IDisposable
+	{
+		/// <summary>
+		/// Size of a packet record sent to the subscribers: the length of the datagram followed by the
+		/// datagram, padded to the longest protocol version.
+		/// </summary>
+		internal const int RecordSize = 1 + Packet.AuthenticatedScheduledLength;
+
+		/// <summary>
+		/// Time in milliseconds until a subscriber is accepted again after an error.
+		/// </summary>
+		const int acceptRetryDelay = 100;
+
+		readonly string path;
+		readonly List<Socket> subscribers;
+		readonly object lockObject;
+		FilteredReceiver receiver;
+		Socket listener;
+		// Accepts again after an error. Created in advance, an error is likely out of file descriptors.
+		Timer acceptRetry;
+		long dropped;
+		bool disposed;
+
+		/// <summary>
+		/// Gets the default path of the socket of the hub. On Unix it is in the runtime directory of
+		/// the user ($XDG_RUNTIME_DIR) or in a directory of the user only it can access, so other users
+		/// can't replace the hub.
+		/// </summary>
+		public static string DefaultPath
+		{
+			get
+			{
+				return Path.Combine(HubSecurity.Directory, "biss-hub.sock");
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of connected subscribers.
+		/// </summary>
+		public int SubscriberCount
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.subscribers.Count;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of packets not delivered, because a subscriber didn't read its socket.
+		/// </summary>
+		public long Dropped
+		{
+			get
+			{
+				return Interlocked.Read(ref this.dropped);
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the authenticator verifying the received packets, or NULL if unauthenticated
+		/// packets are accepted. Must be set before the hub is started.
+		/// </summary>
+		public PacketAuthenticator Authenticator
+		{ get; set; }
+
+		/// <summary>
+		/// Occurs when a subscriber connected or disconnected.
+		/// </summary>
+		public event EventHandler SubscribersChanged;
+
+		/// <summary>
+		/// Initializes a new instance of the ReceiveHub class.
+		/// </summary>
+		/// <param name="path">Path of the socket. <see cref="DefaultPath"/> is used if this parameter is not set.</param>
+		public ReceiveHub(string path = null)
+		{
+			this.path = path ?? DefaultPath;
+			this.subscribers = new List<Socket>();
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Starts accepting subscribers and receiving packets.
+		/// </summary>
+		/// <exception cref="InvalidOperationException">Another hub is already running or the directory
+		/// of the socket belongs to another user.</exception>
+		/// <exception cref="IOException">The directory of the socket could not be created.</exception>
+		/// <exception cref="SocketException">The socket could not be created.</exception>
+		public void Start()
+		{
+			if (this.disposed)
+				throw new ObjectDisposedException(GetType().FullName);
+
+			HubSecurity.CreateDirectory(Path.GetDirectoryName(Path.GetFullPath(this.path)));
+
+			// A socket file left behind by a crashed hub prevents binding.
+			if (File.Exists(this.path))
+			{
+				HubTransport running = HubTransport.Connect(this.path);
+
+				if (running != null)
+				{
+					running.Dispose();
+					throw new InvalidOperationException("Another hub is already running.");
+				}
+
+				File.Delete(this.path);
+			}
+
+			this.receiver = new FilteredReceiver();
+			this.receiver.Authenticator = this.Authenticator;
+			this.receiver.PacketReceived += receiver_PacketReceived;
+
+			this.listener = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+			this.listener.Bind(new UnixEndPoint(this.path));
+			this.listener.Listen(16);
+			this.acceptRetry = new Timer(state => beginAccept());
+			this.listener.BeginAccept(accept, null);
+
+			this.receiver.StartReceiving();
+		}
+
+		private void accept(IAsyncResult asyncResult)
+		{
+			Socket subscriber;
+
+			try
+			{
+				subscriber = this.listener.EndAccept(asyncResult);
+			}
+			catch (ObjectDisposedException)
+			{
+				// The hub was disposed.
+				return;
+			}
+			catch (SocketException) when (this.disposed)
+			{
+				return;
+			}
+			catch (SocketException ex)
+			{
+				retryAccept(ex);
+				return;
+			}
+
+			// A subscriber which doesn't read its socket must not stall the others.
+			subscriber.Blocking = false;
+
+			lock (this.lockObject)
+			{
+				this.subscribers.Add(subscriber);
+			}
+
+			OnSubscribersChanged();
+			beginAccept();
+		}
+
+		/// <summary>
+		/// Begins to accept the next subscriber, unless the hub was disposed.
+		/// </summary>
+		private void beginAccept()
+		{
+			try
+			{
+				this.listener.BeginAccept(accept, null);
+			}
+			catch (ObjectDisposedException)
+			{
+				// The hub was disposed.
+			}
+			catch (SocketException ex) when (!this.disposed)
+			{
+				retryAccept(ex);
+			}
+			catch (SocketException)
+			{
+				// The hub was disposed.
+			}
+		}
+
+		/// <summary>
+		/// Logs an error of accepting a subscriber and accepts again after a moment.
+		/// </summary>
+		/// <remarks>E.g. out of file descriptors or a subscriber which gave up connecting. The hub keeps
+		/// running, but waits, so a lasting error doesn't keep a thread busy.</remarks>
+		private void retryAccept(SocketException ex)
+		{
+			NetworkingEventSource.Log.AcceptFailed(ex.SocketErrorCode.ToString());
+
+			try
+			{
+				this.acceptRetry.Change(acceptRetryDelay, Timeout.Infinite);
+			}
+			catch (ObjectDisposedException)
+			{
+				// The hub was disposed.
+			}
+		}
+
+		private void receiver_PacketReceived(object sender, PacketReceivedEventArgs e)
+		{
+			byte[] datagram = e.ReceivedPacket.Datagram;
+			byte[] record = new byte[RecordSize];
+
+			record[0] = (byte)datagram.Length;
+			Buffer.BlockCopy(datagram, 0, record, 1, datagram.Length);
+			bool removed = false;
+
+			lock (this.lockObject)
+			{
+				for (int a = this.subscribers.Count - 1; a >= 0; a--)
+				{
+					SocketError error;
+					int sent = this.subscribers[a].Send(record, 0, record.Length, SocketFlags.None, out error);
+
+					if (error == SocketError.WouldBlock)
+						Interlocked.Increment(ref this.dropped);
+					else if (error != SocketError.Success || sent != record.Length)
+					{
+						// The subscriber disconnected. A partially sent record can't be recovered either.
+						this.subscribers[a].Close();
+						this.subscribers.RemoveAt(a);
+						removed = true;
+					}
+				}
+			}
+
+			if (removed)
+				OnSubscribersChanged();
+		}
+
+		/// <summary>
+		/// Raises the <see cref="SubscribersChanged"/> event.
+		/// </summary>
+		protected virtual void OnSubscribersChanged()
+		{
+			if (SubscribersChanged != null)
+				SubscribersChanged(this, EventArgs.Empty);
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			if (!disposed)
+			{
+				// Set first, so the aborted accept knows it was expected.
+				disposed = true;
+
+				if (disposing)
+				{
+					if (this.receiver != null)
+						this.receiver.Dispose();
+
+					if (this.acceptRetry != null)
+						this.acceptRetry.Dispose();
+
+					if (this.listener != null)
+					{
+						this.listener.Close();
+						File.Delete(this.path);
+					}
+
+					lock (this.lockObject)
+					{
+						foreach (Socket subscriber in this.subscribers)
+							subscriber.Close();
+
+						this.subscribers.Clear();
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
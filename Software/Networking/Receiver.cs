@@ -1,4 +1,6 @@
 ﻿using System;
+using System.Diagnostics;
+using System.Net;
 using System.Net.Sockets;
 
 namespace BISS.Networking
@@ -6,10 +8,27 @@ namespace BISS.Networking
 	/// <summary>
 	/// Receives a packet.
 	/// </summary>
-	public class Receiver : Base
+	public class Receiver : Base, IDisposable
 	{
-		readonly UdpClient client;
+		readonly Transport transport;
 		IAsyncResult asyncResult;
+		bool disposed;
+		long receivedTimestamp;
+		long parsedTimestamp;
+
+		/// <summary>
+		/// Gets or sets the rate limit applied to each source of datagrams, or NULL if all datagrams are
+		/// processed. By default a <see cref="SourceRateLimiter"/> with the default limits is used.
+		/// </summary>
+		public SourceRateLimiter RateLimiter
+		{ get; set; }
+
+		/// <summary>
+		/// Gets or sets the authenticator verifying the packets. If set, only authentic packets are
+		/// received, also if they were forwarded by the hub.
+		/// </summary>
+		public PacketAuthenticator Authenticator
+		{ get; set; }
 
 		/// <summary>
 		/// Occurs when a packet was successfully received.
@@ -21,9 +40,37 @@ namespace BISS.Networking
 		/// </summary>
 		public event EventHandler ErrorReceived;
 
+		/// <summary>
+		/// Occurs when the transport was closed, e.g. because the hub exited. No more packets are received.
+		/// </summary>
+		public event EventHandler TransportClosed;
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Receiver"/> class, which receives the
+		/// packets from its own UDP socket. On Linux invalid datagrams are already dropped by the kernel.
+		/// </summary>
 		public Receiver()
 		{
-			this.client = CreateClient();
+			UdpTransport udpTransport = new UdpTransport(CreateClient());
+
+			udpTransport.AttachFilter();
+			this.transport = udpTransport;
+			this.RateLimiter = new SourceRateLimiter();
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Receiver"/> class, which receives the
+		/// packets from the specified transport.
+		/// </summary>
+		/// <param name="transport">The transport providing the datagrams, e.g. a <see cref="HubTransport"/>.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="transport"/> was NULL.</exception>
+		public Receiver(Transport transport)
+		{
+			if (transport == null)
+				throw new ArgumentNullException("transport");
+
+			this.transport = transport;
+			this.RateLimiter = new SourceRateLimiter();
 		}
 
 		/// <summary>
@@ -31,24 +78,103 @@ namespace BISS.Networking
 		/// </summary>
 		public void StartReceiving()
 		{
-			this.asyncResult = this.client.BeginReceive(receive, new object());
+			if (this.disposed)
+				throw new ObjectDisposedException(GetType().FullName);
+
+			receiveLoop();
+		}
+
+		/// <summary>
+		/// Begins to receive the next datagram. A receive completes synchronously if a datagram was
+		/// queued already. These are handled in this loop instead of the callback, so the stack
+		/// doesn't grow with every queued datagram during a flood.
+		/// </summary>
+		private void receiveLoop()
+		{
+			do
+			{
+				this.asyncResult = this.transport.BeginReceive(receiveCallback, null);
+
+				if (!this.asyncResult.CompletedSynchronously)
+					return;
+			}
+			while (receive(this.asyncResult));
+		}
+
+		private void receiveCallback(IAsyncResult asyncResult)
+		{
+			if (asyncResult.CompletedSynchronously)
+				return;
+
+			if (receive(asyncResult))
+				receiveLoop();
+		}
+
+		/// <summary>
+		/// Completes the receive of a datagram and processes it.
+		/// </summary>
+		/// <param name="asyncResult">The <see cref="IAsyncResult"/> of the receive.</param>
+		/// <returns>TRUE if receiving should go on.</returns>
+		private bool receive(IAsyncResult asyncResult)
+		{
+			byte[] datagram;
+			IPEndPoint remoteEndPoint;
+
+			try
+			{
+				datagram = this.transport.EndReceive(asyncResult, out remoteEndPoint);
+			}
+			catch (ObjectDisposedException)
+			{
+				// This instance was disposed.
+				return false;
+			}
+			catch (SocketException) when (this.disposed)
+			{
+				// Newer runtimes abort the pending receive instead.
+				return false;
+			}
+
+			if (datagram == null)
+			{
+				OnTransportClosed();
+				return false;
+			}
+
+			// Drop the datagrams of flooding sources before doing any work on them. The sources of
+			// packets forwarded by the hub are unknown, the hub has limited them already.
+			SourceRateLimiter rateLimiter = this.RateLimiter;
+
+			if (rateLimiter == null || remoteEndPoint == null || rateLimiter.TryAcquire(remoteEndPoint.Address))
+				process(datagram);
+
+			return !this.disposed;
 		}
 
-		private void receive(IAsyncResult asyncResult)
+		/// <summary>
+		/// Converts a received datagram into a packet and raises the corresponding event.
+		/// </summary>
+		/// <param name="datagram">The received datagram.</param>
+		private void process(byte[] datagram)
 		{
-			byte[] datagram = this.client.EndReceive(asyncResult, ref this.BroadcastEndPoint);
+			this.receivedTimestamp = Stopwatch.GetTimestamp();
 
 			// Convert the received bytes into a packet
-			Packet receivedPacket = Packet.Parse(datagram);
+			ParseError error;
+			Packet receivedPacket = Packet.Parse(datagram, this.Authenticator, out error);
+			this.parsedTimestamp = Stopwatch.GetTimestamp();
 
 			// Is it a valid packet?
 			if (receivedPacket != null)
+			{
+				NetworkingEventSource.Log.PacketReceived((int)receivedPacket.MessageType, receivedPacket.PacketIdentifier);
 				OnPacketReceived(receivedPacket);
+			}
 			else
+			{
+				NetworkingEventSource.Log.PacketRejected(error, datagram.Length);
 				OnErrorReceived();
-
-			// Start receiving again
-			StartReceiving();
+			}
 		}
 
 		/// <summary>
@@ -61,7 +187,8 @@ namespace BISS.Networking
 				throw new ArgumentNullException("receivedPacket");
 
 			if (PacketReceived != null)
-				PacketReceived(this, new PacketReceivedEventArgs(receivedPacket));
+				PacketReceived(this, new PacketReceivedEventArgs(receivedPacket, this.receivedTimestamp,
+					this.parsedTimestamp, Stopwatch.GetTimestamp()));
 		}
 
 		/// <summary>
@@ -72,5 +199,40 @@ namespace BISS.Networking
 			if (ErrorReceived != null)
 				ErrorReceived(this, EventArgs.Empty);
 		}
+
+		/// <summary>
+		/// Raises the <see cref="TransportClosed"/> event.
+		/// </summary>
+		protected virtual void OnTransportClosed()
+		{
+			if (TransportClosed != null)
+				TransportClosed(this, EventArgs.Empty);
+		}
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{
+			if (!disposed)
+			{
+				// Set first, so the aborted receive knows it was expected.
+				disposed = true;
+
+				if (disposing)
+					this.transport.Dispose();
+			}
+		}
+
+		/// <summary>
+		/// Stops receiving and releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
 	}
 }
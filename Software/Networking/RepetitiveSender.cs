@@ -9,6 +9,16 @@ namespace BISS.Networking
 	/// </summary>
 	public class RepetitiveSender : Sender
 	{
+		/// <summary>
+		/// The default number of repetitions.
+		/// </summary>
+		public const uint DefaultRepetitions = 9;
+
+		/// <summary>
+		/// The default delay in seconds between the repetitions.
+		/// </summary>
+		public const uint DefaultDelay = 1;
+
 		/// <summary>
 		/// Gets or sets the number of repetitions of the transmission.
 		/// </summary>
@@ -50,7 +60,7 @@ namespace BISS.Networking
 		/// and a delay of one second is used.
 		/// </summary>
 		public RepetitiveSender()
-			: this(9, 1)
+			: this(DefaultRepetitions, DefaultDelay)
 		{ }
 
 		/// <summary>
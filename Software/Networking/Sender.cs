@@ -12,6 +12,12 @@ namespace BISS.Networking
 	/// </summary>
 	public class Sender : Base
 	{
+		/// <summary>
+		/// Gets or sets the authenticator signing the packets, or NULL if unauthenticated packets are sent.
+		/// </summary>
+		public PacketAuthenticator Authenticator
+		{ get; set; }
+
 		/// <summary>
 		/// Transmits the specified packet over the network.
 		/// </summary>
@@ -45,15 +51,47 @@ namespace BISS.Networking
 		/// <param name="packet">Packet to be transmitted.</param>
 		/// <returns>TRUE if the packet was successfully sent.</returns>
 		protected bool Send(UdpClient client, Packet packet)
+		{
+			return Send(client, packet, this.BroadcastEndPoint);
+		}
+
+		/// <summary>
+		/// Transmit the specified packet to the specified destination using the UDP client in <paramref name="client"/>.
+		/// </summary>
+		/// <param name="client">UDP client used for transmitting.</param>
+		/// <param name="packet">Packet to be transmitted.</param>
+		/// <param name="destination">The destination, e.g. the directed broadcast address of a subnet.</param>
+		/// <returns>TRUE if the packet was successfully sent.</returns>
+		protected bool Send(UdpClient client, Packet packet, IPEndPoint destination)
 		{
 			if (client == null)
 				throw new ArgumentNullException("client");
+			if (destination == null)
+				throw new ArgumentNullException("destination");
 
 			// Generate the raw byte data and send them
-			byte[] data = packet.GenerateDatagram();
-			int sent = client.Send(data, data.Length, this.BroadcastEndPoint);
+			byte[] data = packet.GenerateDatagram(this.Authenticator);
+			string localAddress = client.Client.LocalEndPoint.ToString();
+			int sent;
+
+			try
+			{
+				sent = client.Send(data, data.Length, destination);
+			}
+			catch (SocketException ex)
+			{
+				NetworkingEventSource.Log.SendFailed(localAddress, ex.SocketErrorCode.ToString());
+				throw;
+			}
+
+			if (data.Length != sent)
+			{
+				NetworkingEventSource.Log.SendFailed(localAddress, "Incomplete");
+				return false;
+			}
 
-			return data.Length == sent;
+			NetworkingEventSource.Log.PacketSent(localAddress);
+			return true;
 		}
 	}
 }
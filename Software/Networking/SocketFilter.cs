@@ -0,0 +1,189 @@
+﻿using System;
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Attaches a classic BPF program to the receive socket on Linux, so the kernel drops datagrams
+	/// which are no BISS packets before the receiver is woken up.
+	/// </summary>
+	internal static class SocketFilter
+	{
+		const int SOL_SOCKET = 1;
+		const int SO_ATTACH_FILTER = 26;
+
+		// Instruction classes and modes of classic BPF (linux/filter.h).
+		const ushort BPF_LD = 0x00;
+		const ushort BPF_JMP = 0x05;
+		const ushort BPF_RET = 0x06;
+		const ushort BPF_W = 0x00;
+		const ushort BPF_B = 0x10;
+		const ushort BPF_ABS = 0x20;
+		const ushort BPF_LEN = 0x80;
+		const ushort BPF_JEQ = 0x10;
+		const ushort BPF_K = 0x00;
+
+		/// <summary>
+		/// Offset of the UDP payload. The filter of a UDP socket sees the packet from the UDP header on.
+		/// </summary>
+		const int udpHeaderLength = 8;
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct SockFilter
+		{
+			public ushort Code;
+			public byte JumpTrue;
+			public byte JumpFalse;
+			public uint K;
+
+			public SockFilter(ushort code, byte jumpTrue, byte jumpFalse, uint k)
+			{
+				this.Code = code;
+				this.JumpTrue = jumpTrue;
+				this.JumpFalse = jumpFalse;
+				this.K = k;
+			}
+		}
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct SockFprog
+		{
+			public ushort Length;
+			public IntPtr Filter;
+		}
+
+		[DllImport("libc", SetLastError = true)]
+		static extern int setsockopt(IntPtr socket, int level, int optionName, ref SockFprog optionValue, int optionLength);
+
+		/// <summary>
+		/// Gets a value indicating whether socket filters are possibly supported by the OS.
+		/// </summary>
+		public static bool Supported
+		{
+			get
+			{
+				return Environment.OSVersion.Platform == PlatformID.Unix;
+			}
+		}
+
+		/// <summary>
+		/// Builds the filter program. The length of the datagram selects the protocol version, whose
+		/// version and end byte are checked. Then the start byte and the magic string common to all
+		/// versions are checked. Each check jumps to the final "drop" instruction if the datagram doesn't
+		/// have the expected value.
+		/// </summary>
+		/// <returns>The instructions of the program.</returns>
+		private static SockFilter[] build()
+		{
+			int[] lengths = Packet.Lengths;
+			byte[] versions = Packet.Versions;
+
+			// Length dispatch, a block of four instructions per version, common checks and the two returns.
+			int versionBlocks = 1 + lengths.Length;
+			int common = versionBlocks + lengths.Length * 4;
+			int drop = common + 5;
+			SockFilter[] program = new SockFilter[drop + 1];
+
+			program[0] = load(BPF_W | BPF_LEN, 0);
+
+			for (int a = 0; a < lengths.Length; a++)
+			{
+				int dispatch = 1 + a;
+				int block = versionBlocks + a * 4;
+
+				// The length includes the UDP header. Unknown lengths are dropped after the last comparison.
+				program[dispatch] = compare((uint)(udpHeaderLength + lengths[a]), jump(dispatch, block),
+					a == lengths.Length - 1 ? jump(dispatch, drop) : (byte)0);
+
+				program[block] = load(BPF_B | BPF_ABS, 5);
+				program[block + 1] = compare(versions[a], 0, jump(block + 1, drop));
+				program[block + 2] = load(BPF_B | BPF_ABS, lengths[a] - 1);
+				program[block + 3] = compare(Packet.EndOfPacket, jump(block + 3, common), jump(block + 3, drop));
+			}
+
+			program[common] = load(BPF_B | BPF_ABS, 0);
+			program[common + 1] = compare(Packet.StartOfPacket, 0, jump(common + 1, drop));
+			program[common + 2] = load(BPF_W | BPF_ABS, 1);
+			program[common + 3] = compare((uint)(Packet.Magic[0] << 24 | Packet.Magic[1] << 16 | Packet.Magic[2] << 8 | Packet.Magic[3]),
+				0, jump(common + 3, drop));
+
+			// Accept the whole datagram or drop it.
+			program[drop - 1] = new SockFilter(BPF_RET | BPF_K, 0, 0, 0xFFFF);
+			program[drop] = new SockFilter(BPF_RET | BPF_K, 0, 0, 0);
+
+			return program;
+		}
+
+		/// <summary>
+		/// Returns an instruction comparing the accumulator with a constant.
+		/// </summary>
+		/// <param name="expected">The constant.</param>
+		/// <param name="jumpTrue">Instructions skipped if equal.</param>
+		/// <param name="jumpFalse">Instructions skipped if not equal.</param>
+		private static SockFilter compare(uint expected, byte jumpTrue, byte jumpFalse)
+		{
+			return new SockFilter(BPF_JMP | BPF_JEQ | BPF_K, jumpTrue, jumpFalse, expected);
+		}
+
+		/// <summary>
+		/// Returns the offset of a jump. Jumps are relative to the next instruction.
+		/// </summary>
+		/// <param name="from">Index of the jump instruction.</param>
+		/// <param name="to">Index of the target instruction.</param>
+		private static byte jump(int from, int to)
+		{
+			return (byte)(to - from - 1);
+		}
+
+		/// <summary>
+		/// Returns an instruction loading a value into the accumulator.
+		/// </summary>
+		/// <param name="mode">Size and addressing mode of the load.</param>
+		/// <param name="payloadOffset">Offset of the value in the UDP payload.</param>
+		private static SockFilter load(int mode, int payloadOffset)
+		{
+			uint k = (mode & BPF_LEN) != 0 ? 0 : (uint)(udpHeaderLength + payloadOffset);
+
+			return new SockFilter((ushort)(BPF_LD | mode), 0, 0, k);
+		}
+
+		/// <summary>
+		/// Attaches the filter to the specified socket.
+		/// </summary>
+		/// <param name="socket">The bound UDP socket.</param>
+		/// <returns>TRUE if the filter was attached, FALSE if it isn't supported.</returns>
+		public static bool Attach(Socket socket)
+		{
+			if (!Supported)
+				return false;
+
+			SockFilter[] program = build();
+			GCHandle handle = GCHandle.Alloc(program, GCHandleType.Pinned);
+
+			try
+			{
+				SockFprog fprog = new SockFprog()
+				{
+					Length = (ushort)program.Length,
+					Filter = handle.AddrOfPinnedObject()
+				};
+
+				// The kernel copies the program, so it doesn't need to stay pinned.
+				return setsockopt(socket.Handle, SOL_SOCKET, SO_ATTACH_FILTER, ref fprog, Marshal.SizeOf(fprog)) == 0;
+			}
+			catch (DllNotFoundException)
+			{
+				return false;
+			}
+			catch (EntryPointNotFoundException)
+			{
+				return false;
+			}
+			finally
+			{
+				handle.Free();
+			}
+		}
+	}
+}
@@ -0,0 +1,255 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Net;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Limits the number of datagrams accepted per source address with a token bucket.
+	/// </summary>
+	/// <remarks>
+	/// Each source gets a bucket of <see cref="Burst"/> tokens, which is refilled with <see cref="Rate"/>
+	/// tokens per second. A datagram takes one token; if the bucket is empty it is dropped. At most
+	/// <see cref="Capacity"/> sources are tracked, the least recently seen source is evicted first.
+	/// <para>Sources which are not tracked share a single bucket, so a flood from changing or spoofed
+	/// addresses is limited like a single source. A source is only tracked once a datagram of it was
+	/// accepted, and it starts with an empty bucket, because this datagram took the token from the
+	/// shared one. Dropped datagrams of new sources don't evict the tracked sources.</para>
+	/// </remarks>
+	public class SourceRateLimiter
+	{
+		/// <summary>
+		/// State of a single source.
+		/// </summary>
+		class Bucket
+		{
+			public IPAddress Source;
+			public double Tokens;
+			public long Timestamp;
+			public bool Throttled;
+		}
+
+		readonly Dictionary<IPAddress, LinkedListNode<Bucket>> buckets;
+		// Most recently seen source first.
+		readonly LinkedList<Bucket> recentlyUsed;
+		// Bucket of the sources which are not tracked.
+		readonly Bucket shared;
+		readonly object lockObject;
+		long dropped;
+		long throttleEvents;
+
+		/// <summary>
+		/// Gets the number of tokens refilled per second.
+		/// </summary>
+		public double Rate
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the maximum number of tokens of a bucket, i.e. the number of datagrams accepted at once.
+		/// </summary>
+		public int Burst
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the maximum number of sources tracked.
+		/// </summary>
+		public int Capacity
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the number of datagrams dropped.
+		/// </summary>
+		public long Dropped
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.dropped;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets how often a source started to be throttled.
+		/// </summary>
+		public long ThrottleEvents
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					return this.throttleEvents;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of tracked sources which are currently throttled.
+		/// </summary>
+		public int ThrottledSources
+		{
+			get
+			{
+				lock (this.lockObject)
+				{
+					int result = 0;
+
+					foreach (Bucket bucket in this.recentlyUsed)
+					{
+						if (bucket.Throttled)
+							result++;
+					}
+
+					return result;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the SourceRateLimiter class.
+		/// </summary>
+		/// <param name="rate">Number of datagrams per second accepted from a source.</param>
+		/// <param name="burst">Number of datagrams accepted at once from a source.</param>
+		/// <param name="capacity">Maximum number of sources tracked.</param>
+		/// <exception cref="ArgumentOutOfRangeException">A parameter was not positive.</exception>
+		public SourceRateLimiter(double rate, int burst, int capacity)
+		{
+			if (rate <= 0)
+				throw new ArgumentOutOfRangeException("rate");
+			if (burst <= 0)
+				throw new ArgumentOutOfRangeException("burst");
+			if (capacity <= 0)
+				throw new ArgumentOutOfRangeException("capacity");
+
+			this.Rate = rate;
+			this.Burst = burst;
+			this.Capacity = capacity;
+			this.buckets = new Dictionary<IPAddress, LinkedListNode<Bucket>>(capacity);
+			this.recentlyUsed = new LinkedList<Bucket>();
+			this.shared = new Bucket();
+			this.shared.Tokens = burst;
+			this.shared.Timestamp = Stopwatch.GetTimestamp();
+			this.lockObject = new object();
+		}
+
+		/// <summary>
+		/// Initializes a new instance of the SourceRateLimiter class with the default limits: a burst of
+		/// 20 datagrams, 10 datagrams per second and 256 sources.
+		/// </summary>
+		/// <remarks>A <see cref="RepetitiveSender"/> sends one datagram per second and interface.</remarks>
+		public SourceRateLimiter()
+			: this(10, 20, 256)
+		{ }
+
+		/// <summary>
+		/// Gets the current <see cref="Stopwatch"/> timestamp, which determines the refilled tokens.
+		/// </summary>
+		/// <returns>The current timestamp.</returns>
+		protected virtual long GetTimestamp()
+		{
+			return Stopwatch.GetTimestamp();
+		}
+
+		/// <summary>
+		/// Takes a token from the bucket of the specified source, or from the shared bucket if the source
+		/// is not tracked.
+		/// </summary>
+		/// <param name="source">Address of the source.</param>
+		/// <returns>TRUE if the datagram is accepted, FALSE if it has to be dropped.</returns>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="source"/> was NULL.</exception>
+		public bool TryAcquire(IPAddress source)
+		{
+			if (source == null)
+				throw new ArgumentNullException("source");
+
+			long now = GetTimestamp();
+			LinkedListNode<Bucket> node;
+
+			lock (this.lockObject)
+			{
+				if (this.buckets.TryGetValue(source, out node))
+				{
+					// A flood usually comes from the most recently seen source, which needs no move.
+					if (node != this.recentlyUsed.First)
+					{
+						this.recentlyUsed.Remove(node);
+						this.recentlyUsed.AddFirst(node);
+					}
+
+					refill(node.Value, now);
+				}
+				else
+				{
+					refill(this.shared, now);
+
+					if (!take(this.shared, null))
+						return false;
+
+					// Reuse the node of the least recently seen source if the table is full.
+					if (this.buckets.Count < this.Capacity)
+						node = new LinkedListNode<Bucket>(new Bucket());
+					else
+					{
+						node = this.recentlyUsed.Last;
+						this.recentlyUsed.RemoveLast();
+						this.buckets.Remove(node.Value.Source);
+					}
+
+					node.Value.Source = source;
+					node.Value.Tokens = 0;
+					node.Value.Timestamp = now;
+					node.Value.Throttled = false;
+					this.buckets.Add(source, node);
+					this.recentlyUsed.AddFirst(node);
+
+					return true;
+				}
+
+				return take(node.Value, source);
+			}
+		}
+
+		/// <summary>
+		/// Adds the tokens refilled since the last datagram to a bucket.
+		/// </summary>
+		private void refill(Bucket bucket, long now)
+		{
+			if (now > bucket.Timestamp)
+			{
+				bucket.Tokens = Math.Min(this.Burst, bucket.Tokens + (now - bucket.Timestamp) * this.Rate / Stopwatch.Frequency);
+				bucket.Timestamp = now;
+			}
+		}
+
+		/// <summary>
+		/// Takes a token from a bucket or counts the dropped datagram. Must be called with the lock held.
+		/// </summary>
+		/// <param name="bucket">The bucket.</param>
+		/// <param name="source">The source of the bucket, or NULL for the shared bucket.</param>
+		/// <returns>TRUE if the datagram is accepted.</returns>
+		private bool take(Bucket bucket, IPAddress source)
+		{
+			if (bucket.Tokens >= 1)
+			{
+				bucket.Tokens--;
+				bucket.Throttled = false;
+
+				return true;
+			}
+
+			this.dropped++;
+			NetworkingEventSource.Log.PacketThrottled();
+
+			if (!bucket.Throttled)
+			{
+				bucket.Throttled = true;
+				this.throttleEvents++;
+				NetworkingEventSource.Log.SourceThrottled(source != null ? source.ToString() : "new sources");
+			}
+
+			return false;
+		}
+	}
+}
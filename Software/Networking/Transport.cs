@@ -0,0 +1,44 @@
+﻿using System;
+using System.Net;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Base class for the transports a <see cref="Receiver"/> gets its datagrams from.
+	/// </summary>
+	public abstract class Transport : IDisposable
+	{
+		/// <summary>
+		/// Begins to receive a datagram asynchronously.
+		/// </summary>
+		/// <param name="callback">The method called when the datagram was received.</param>
+		/// <param name="state">User defined object passed to the callback.</param>
+		/// <returns>An <see cref="IAsyncResult"/> referencing the asynchronous receive.</returns>
+		public abstract IAsyncResult BeginReceive(AsyncCallback callback, object state);
+
+		/// <summary>
+		/// Ends a pending asynchronous receive.
+		/// </summary>
+		/// <param name="asyncResult">The <see cref="IAsyncResult"/> returned by <see cref="BeginReceive"/>.</param>
+		/// <param name="remoteEndPoint">The sender of the datagram, or NULL if it is unknown.</param>
+		/// <returns>The received datagram, or NULL if the transport was closed.</returns>
+		public abstract byte[] EndReceive(IAsyncResult asyncResult, out IPEndPoint remoteEndPoint);
+
+		#region IDisposable Support
+		/// <summary>
+		/// Disposes of the resources used by this instance.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected virtual void Dispose(bool disposing)
+		{ }
+
+		/// <summary>
+		/// Releases all resources used by this instance.
+		/// </summary>
+		public void Dispose()
+		{
+			Dispose(true);
+		}
+		#endregion
+	}
+}
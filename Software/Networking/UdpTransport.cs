@@ -0,0 +1,91 @@
+﻿using System;
+using System.Net;
+using System.Net.Sockets;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Receives the datagrams directly from a UDP socket.
+	/// </summary>
+	public class UdpTransport : Transport
+	{
+		readonly UdpClient client;
+
+		/// <summary>
+		/// Gets the UDP client used for receiving.
+		/// </summary>
+		public UdpClient Client
+		{
+			get
+			{
+				return this.client;
+			}
+		}
+
+		/// <summary>
+		/// Gets a value indicating whether the kernel filters the datagrams, see <see cref="AttachFilter"/>.
+		/// </summary>
+		public bool FilterAttached
+		{ get; private set; }
+
+		/// <summary>
+		/// Initializes a new instance of the UdpTransport class.
+		/// </summary>
+		/// <param name="client">The bound UDP client used for receiving.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="client"/> was NULL.</exception>
+		public UdpTransport(UdpClient client)
+		{
+			if (client == null)
+				throw new ArgumentNullException("client");
+
+			this.client = client;
+		}
+
+		/// <summary>
+		/// Lets the kernel drop all datagrams which are no BISS packets, so the receiver isn't woken up
+		/// for them. This is only supported on Linux.
+		/// </summary>
+		/// <returns>TRUE if the filter was attached.</returns>
+		public bool AttachFilter()
+		{
+			if (!this.FilterAttached)
+				this.FilterAttached = SocketFilter.Attach(this.client.Client);
+
+			return this.FilterAttached;
+		}
+
+		/// <summary>
+		/// Begins to receive a datagram asynchronously.
+		/// </summary>
+		/// <param name="callback">The method called when the datagram was received.</param>
+		/// <param name="state">User defined object passed to the callback.</param>
+		/// <returns>An <see cref="IAsyncResult"/> referencing the asynchronous receive.</returns>
+		public override IAsyncResult BeginReceive(AsyncCallback callback, object state)
+		{
+			return this.client.BeginReceive(callback, state);
+		}
+
+		/// <summary>
+		/// Ends a pending asynchronous receive.
+		/// </summary>
+		/// <param name="asyncResult">The <see cref="IAsyncResult"/> returned by <see cref="BeginReceive"/>.</param>
+		/// <param name="remoteEndPoint">The sender of the datagram.</param>
+		/// <returns>The received datagram.</returns>
+		public override byte[] EndReceive(IAsyncResult asyncResult, out IPEndPoint remoteEndPoint)
+		{
+			remoteEndPoint = null;
+
+			return this.client.EndReceive(asyncResult, ref remoteEndPoint);
+		}
+
+		/// <summary>
+		/// Closes the UDP client.
+		/// </summary>
+		/// <param name="disposing">TRUE to release both managed and unmanaged resources.</param>
+		protected override void Dispose(bool disposing)
+		{
+			if (disposing)
+				this.client.Close();
+		}
+	}
+}
@@ -0,0 +1,129 @@
+﻿using System;
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+
+namespace BISS.Networking
+{
+	/// <summary>
+	/// Represents the path of a Unix domain socket.
+	/// </summary>
+	/// <remarks>The .NET Framework 4.5 doesn't provide an endpoint for Unix domain sockets. They are
+	/// available on Linux and on Windows 10 (version 1803 and newer).</remarks>
+	public class UnixEndPoint : EndPoint
+	{
+		/// <summary>
+		/// Offset of the path in the socket address; the first two bytes hold the address family.
+		/// </summary>
+		const int pathOffset = 2;
+
+		/// <summary>
+		/// Maximum length of the path in bytes (sun_path is 108 bytes including the terminator).
+		/// </summary>
+		const int maxPathLength = 107;
+
+		/// <summary>
+		/// Gets the path of the socket.
+		/// </summary>
+		public string Path
+		{ get; private set; }
+
+		/// <summary>
+		/// Gets the address family, which is always <see cref="AddressFamily.Unix"/>.
+		/// </summary>
+		public override AddressFamily AddressFamily
+		{
+			get
+			{
+				return AddressFamily.Unix;
+			}
+		}
+
+		private UnixEndPoint()
+		{ }
+
+		/// <summary>
+		/// Initializes a new instance of the UnixEndPoint class.
+		/// </summary>
+		/// <param name="path">The path of the socket.</param>
+		/// <exception cref="ArgumentNullException">The parameter <paramref name="path"/> was NULL.</exception>
+		/// <exception cref="ArgumentException">The path is empty or too long.</exception>
+		public UnixEndPoint(string path)
+		{
+			if (path == null)
+				throw new ArgumentNullException("path");
+			if (path.Length == 0 || Encoding.UTF8.GetByteCount(path) > maxPathLength)
+				throw new ArgumentException("The path is empty or too long.", "path");
+
+			this.Path = path;
+		}
+
+		/// <summary>
+		/// Converts the path into a socket address.
+		/// </summary>
+		/// <returns>The socket address containing the NUL terminated path.</returns>
+		public override SocketAddress Serialize()
+		{
+			byte[] path = Encoding.UTF8.GetBytes(this.Path);
+			SocketAddress result = new SocketAddress(AddressFamily.Unix, pathOffset + path.Length + 1);
+
+			for (int a = 0; a < path.Length; a++)
+				result[pathOffset + a] = path[a];
+
+			return result;
+		}
+
+		/// <summary>
+		/// Creates an endpoint from a socket address.
+		/// </summary>
+		/// <param name="socketAddress">The socket address containing a path.</param>
+		/// <returns>Instance of <see cref="UnixEndPoint"/>.</returns>
+		public override EndPoint Create(SocketAddress socketAddress)
+		{
+			if (socketAddress == null)
+				throw new ArgumentNullException("socketAddress");
+
+			// The path is terminated by NUL or the end of the address. The address of an unbound
+			// peer (e.g. an accepted connection) is empty.
+			int length = 0;
+			while (pathOffset + length < socketAddress.Size && socketAddress[pathOffset + length] != 0)
+				length++;
+
+			byte[] path = new byte[length];
+			for (int a = 0; a < length; a++)
+				path[a] = socketAddress[pathOffset + a];
+
+			return new UnixEndPoint() { Path = Encoding.UTF8.GetString(path) };
+		}
+
+		/// <summary>
+		/// Determines whether the specified object is an endpoint with the same path.
+		/// </summary>
+		/// <param name="obj">The object to compare with.</param>
+		/// <returns>TRUE if the paths are equal.</returns>
+		public override bool Equals(object obj)
+		{
+			UnixEndPoint other = obj as UnixEndPoint;
+
+			return other != null && other.Path == this.Path;
+		}
+
+		/// <summary>
+		/// Returns the hash code of the path.
+		/// </summary>
+		/// <returns>The hash code.</returns>
+		public override int GetHashCode()
+		{
+			return this.Path.GetHashCode();
+		}
+
+		/// <summary>
+		/// Returns the path of the socket.
+		/// </summary>
+		/// <returns>The path.</returns>
+		public override string ToString()
+		{
+			return this.Path;
+		}
+	}
+}
@@ -10,7 +10,7 @@ namespace BISS.PopUp
 	{
 		static bool close;
 		static NotifyIcon notifyIcon;
-		static FilteredReceiver receiver;
+		static HubReceiver receiver;
 
 		/// <summary>
 		/// Der Haupteinstiegspunkt für die Anwendung.
@@ -21,7 +21,7 @@ namespace BISS.PopUp
 			Application.EnableVisualStyles();
 			Application.SetCompatibleTextRenderingDefault(false);
 
-			receiver = new FilteredReceiver();
+			receiver = new HubReceiver();
 			receiver.PacketReceived += receiver_PacketReceived;
 			
 			ContextMenu menu = new ContextMenu();
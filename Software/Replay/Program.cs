@@ -0,0 +1,89 @@
+﻿using System;
+using System.IO;
+using BISS.Hardware.Blinky;
+
+namespace BISS.Replay
+{
+	/// <summary>
+	/// Replays a HID trace recorded with <see cref="TraceRecorder"/> to a Blinky device and reports
+	/// the differences in the answers and their latencies.
+	/// </summary>
+	/// <remarks>
+	/// Command line: Replay trace.bin [-fast] [-path device] [-timeout ms]
+	/// </remarks>
+	static class Program
+	{
+		/// <summary>
+		/// Der Haupteinstiegspunkt für die Anwendung.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			string tracePath = null;
+			string devicePath = null;
+			bool fast = false;
+			uint timeout = 0;
+
+			for (int a = 0; a < args.Length; a++)
+			{
+				if (args[a] == "-fast")
+					fast = true;
+				else if (args[a] == "-path" && a + 1 < args.Length)
+					devicePath = args[++a];
+				else if (args[a] == "-timeout" && a + 1 < args.Length && uint.TryParse(args[a + 1], out timeout) && timeout > 0)
+					a++;
+				else if (tracePath == null && !args[a].StartsWith("-"))
+					tracePath = args[a];
+				else
+					return usage();
+			}
+
+			if (tracePath == null)
+				return usage();
+
+			TraceFile trace;
+
+			try
+			{
+				trace = TraceFile.Load(tracePath);
+			}
+			catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException || ex is FormatException)
+			{
+				Console.Error.WriteLine("Invalid trace: {0}", ex.Message);
+				return 1;
+			}
+
+			Console.WriteLine("Trace of {0} records recorded at {1:u}.", trace.Records.Count, trace.Started);
+			if (trace.Dropped > 0)
+				Console.WriteLine("The trace is incomplete, {0} records were dropped.", trace.Dropped);
+
+			TraceReplayer replayer = new TraceReplayer(trace) { Fast = fast };
+
+			using (Device device = new Device())
+			{
+				if (timeout > 0)
+					device.Timeout = timeout;
+
+				if (!(devicePath == null ? device.Connect() : device.Connect(devicePath)))
+				{
+					Console.Error.WriteLine("Device not found.");
+					return 1;
+				}
+
+				if (!replayer.Run(device))
+					return 1;
+			}
+
+			return replayer.Differences == 0 ? 0 : 2;
+		}
+
+		static int usage()
+		{
+			Console.Error.WriteLine("Usage: Replay trace.bin [-fast] [-path device] [-timeout ms]");
+			Console.Error.WriteLine("  -fast     Sends the reports as fast as possible instead of at the recorded times.");
+			Console.Error.WriteLine("  -path     Path of the device, the first device found is used otherwise.");
+			Console.Error.WriteLine("  -timeout  Timeout for answers in milliseconds.");
+			Console.Error.WriteLine("Exits with 2 if answers differ from the trace.");
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,211 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading;
+using BISS.Hardware.Blinky;
+
+namespace BISS.Replay
+{
+	/// <summary>
+	/// Sends the reports of a HID trace to a device again and compares its answers and their
+	/// latencies with the recorded ones.
+	/// </summary>
+	class TraceReplayer
+	{
+		/// <summary>
+		/// Commands whose answers contain the clock or counters of the device, so they always differ.
+		/// </summary>
+		static readonly HashSet<byte> timeDependent = new HashSet<byte> { 9, 10, 20 };
+
+		/// <summary>
+		/// Latencies differing by more than this are reported.
+		/// </summary>
+		static readonly TimeSpan latencyTolerance = TimeSpan.FromMilliseconds(2);
+
+		/// <summary>
+		/// A report which was sent and its recorded answer.
+		/// </summary>
+		class Step
+		{
+			public TraceRecord Sent;
+			public TraceRecord Answer;
+			public bool TimedOut;
+		}
+
+		readonly List<Step> steps = new List<Step>();
+		readonly TimeSpan recordedDuration;
+
+		/// <summary>
+		/// Gets or sets a value indicating whether the reports are sent as fast as possible instead
+		/// of at the recorded times.
+		/// </summary>
+		public bool Fast { get; set; }
+
+		/// <summary>
+		/// Gets the number of reports which were sent.
+		/// </summary>
+		public int Replayed { get; private set; }
+
+		/// <summary>
+		/// Gets the number of answers which differ from the recorded ones, not counting commands
+		/// which answer with the clock of the device.
+		/// </summary>
+		public int Differences { get; private set; }
+
+		/// <summary>
+		/// Creates a replayer for a trace.
+		/// </summary>
+		/// <param name="trace">The recorded trace.</param>
+		public TraceReplayer(TraceFile trace)
+		{
+			if (trace == null)
+				throw new ArgumentNullException("trace");
+
+			IList<TraceRecord> records = trace.Records;
+
+			// The answer to a report has its sync byte and was received before the next report was
+			// sent. Reports without answer or timeout were sent without waiting.
+			for (int a = 0; a < records.Count; a++)
+			{
+				if (records[a].Kind != TraceKind.Sent)
+					continue;
+
+				Step step = new Step { Sent = records[a] };
+
+				for (int b = a + 1; b < records.Count && records[b].Kind != TraceKind.Sent; b++)
+				{
+					if (records[b].Kind == TraceKind.Timeout)
+						step.TimedOut = true;
+					else if (step.Answer == null && records[b].SyncByte == step.Sent.SyncByte)
+						step.Answer = records[b];
+				}
+
+				this.steps.Add(step);
+			}
+
+			if (records.Count > 0)
+				this.recordedDuration = records[records.Count - 1].Time;
+		}
+
+		/// <summary>
+		/// Sends all reports to the device and prints each difference.
+		/// </summary>
+		/// <param name="device">The connected device.</param>
+		/// <returns>FALSE if a report could not be sent.</returns>
+		public bool Run(Device device)
+		{
+			long start = Stopwatch.GetTimestamp();
+			TimeSpan recordedLatency = TimeSpan.Zero, replayedLatency = TimeSpan.Zero;
+			TimeSpan recordedMax = TimeSpan.Zero, replayedMax = TimeSpan.Zero;
+			int answered = 0, timeDependentCount = 0;
+
+			foreach (Step step in this.steps)
+			{
+				if (!Fast)
+					waitUntil(start, step.Sent.Time);
+
+				long sent, received;
+				bool waitForAnswer = step.Answer != null || step.TimedOut;
+				byte[] answer = device.SendRawReport(step.Sent.Report, waitForAnswer, out sent, out received);
+
+				if (answer == null && !waitForAnswer)
+				{
+					Console.Error.WriteLine("Sending the report at {0:F3} ms failed.", step.Sent.Time.TotalMilliseconds);
+					return false;
+				}
+
+				this.Replayed++;
+
+				if (!waitForAnswer)
+					continue;
+
+				if (answer == null || step.Answer == null)
+				{
+					if (answer != null || step.Answer != null)
+						difference(step, answer == null ? "no answer" : "answered, recorded timeout");
+					continue;
+				}
+
+				TimeSpan recorded = step.Answer.Time - step.Sent.Time;
+				TimeSpan replayed = TimeSpan.FromTicks((received - sent) * TimeSpan.TicksPerSecond / Stopwatch.Frequency);
+
+				answered++;
+				recordedLatency += recorded;
+				replayedLatency += replayed;
+				if (recorded > recordedMax)
+					recordedMax = recorded;
+				if (replayed > replayedMax)
+					replayedMax = replayed;
+
+				if (timeDependent.Contains(step.Sent.Report[0]))
+					timeDependentCount++;
+				else if (!sameAnswer(answer, step.Answer.Report))
+					difference(step, "answer " + BitConverter.ToString(answer).Replace('-', ' '));
+				else if ((replayed - recorded).Duration() > latencyTolerance)
+					Console.WriteLine("{0,12:F3} ms  latency {1:F3} ms, recorded {2:F3} ms", step.Sent.Time.TotalMilliseconds,
+						replayed.TotalMilliseconds, recorded.TotalMilliseconds);
+			}
+
+			TimeSpan duration = TimeSpan.FromTicks((Stopwatch.GetTimestamp() - start) * TimeSpan.TicksPerSecond / Stopwatch.Frequency);
+
+			Console.WriteLine();
+			Console.WriteLine("{0} reports replayed in {1:F1} ms, recorded in {2:F1} ms.", this.Replayed,
+				duration.TotalMilliseconds, this.recordedDuration.TotalMilliseconds);
+			if (answered > 0)
+			{
+				Console.WriteLine("Latency: avg {0:F3} ms, max {1:F3} ms; recorded avg {2:F3} ms, max {3:F3} ms.",
+					replayedLatency.TotalMilliseconds / answered, replayedMax.TotalMilliseconds,
+					recordedLatency.TotalMilliseconds / answered, recordedMax.TotalMilliseconds);
+			}
+			Console.WriteLine("{0} answers differ, {1} answers depend on the device clock and weren't compared.",
+				this.Differences, timeDependentCount);
+
+			return true;
+		}
+
+		/// <summary>
+		/// Compares the command and the answer bytes; the sync byte is the same anyway.
+		/// </summary>
+		static bool sameAnswer(byte[] answer, byte[] recorded)
+		{
+			for (int a = 0; a < 7; a++)
+			{
+				if (answer[a] != recorded[a])
+					return false;
+			}
+
+			return true;
+		}
+
+		void difference(Step step, string description)
+		{
+			this.Differences++;
+
+			Console.WriteLine("{0,12:F3} ms  {1}: {2}, recorded {3}", step.Sent.Time.TotalMilliseconds,
+				BitConverter.ToString(step.Sent.Report).Replace('-', ' '), description,
+				step.Answer == null ? "timeout" : BitConverter.ToString(step.Answer.Report).Replace('-', ' '));
+		}
+
+		/// <summary>
+		/// Waits until the recorded time of a report. Sleeping is only accurate to the timer
+		/// resolution, so the last milliseconds are spun.
+		/// </summary>
+		static void waitUntil(long start, TimeSpan time)
+		{
+			long due = start + (long)(time.TotalSeconds * Stopwatch.Frequency);
+
+			while (true)
+			{
+				long remaining = (due - Stopwatch.GetTimestamp()) * 1000 / Stopwatch.Frequency;
+
+				if (remaining <= 0)
+					return;
+
+				if (remaining > 20)
+					Thread.Sleep((int)remaining - 20);
+				else
+					Thread.SpinWait(100);
+			}
+		}
+	}
+}
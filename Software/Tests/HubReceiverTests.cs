@@ -0,0 +1,70 @@
+﻿using System;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+using BISS.Networking;
+
+namespace BISS.Tests
+{
+	/// <summary>
+	/// Tests of <see cref="HubReceiver"/> with a hub started and stopped by the test.
+	/// </summary>
+	static class HubReceiverTests
+	{
+		public static void Run()
+		{
+			SwitchesToHubAndBack();
+		}
+
+		/// <summary>
+		/// Waits until the condition is met, at most 5 seconds.
+		/// </summary>
+		static bool waitFor(Func<bool> condition)
+		{
+			Stopwatch stopwatch = Stopwatch.StartNew();
+
+			while (!condition() && stopwatch.Elapsed < TimeSpan.FromSeconds(5))
+				Thread.Sleep(10);
+
+			return condition();
+		}
+
+		static void SwitchesToHubAndBack()
+		{
+			string directory = Path.Combine(Path.GetTempPath(), "biss-tests-" + Process.GetCurrentProcess().Id);
+			string path = Path.Combine(directory, "hub.sock");
+			int changes = 0;
+
+			using (HubReceiver receiver = new HubReceiver(path))
+			{
+				receiver.HubRetryInterval = TimeSpan.FromMilliseconds(100);
+				receiver.TransportChanged += (sender, e) => Interlocked.Increment(ref changes);
+				receiver.StartReceiving();
+
+				Program.Check(!receiver.ReceivingFromHub, "receiving directly without a hub");
+				Program.CheckEqual(1, Volatile.Read(ref changes), "transport changes after start");
+
+				using (ReceiveHub hub = new ReceiveHub(path))
+				{
+					hub.Start();
+
+					Program.Check(waitFor(() => receiver.ReceivingFromHub), "receiving from the started hub");
+					Program.Check(waitFor(() => hub.SubscriberCount == 1), "subscribed to the hub");
+				}
+
+				Program.Check(waitFor(() => !receiver.ReceivingFromHub), "receiving directly after the hub exited");
+				Program.Check(waitFor(() => Volatile.Read(ref changes) == 3), "transport changed three times");
+
+				// The hub is used again when it is restarted.
+				using (ReceiveHub hub = new ReceiveHub(path))
+				{
+					hub.Start();
+
+					Program.Check(waitFor(() => receiver.ReceivingFromHub), "receiving from the restarted hub");
+				}
+			}
+
+			Directory.Delete(directory, true);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+﻿using System;
+using BISS.Networking;
+
+namespace BISS.Tests
+{
+	/// <summary>
+	/// Tests of <see cref="PacketAuthenticator"/>.
+	/// </summary>
+	static class PacketAuthenticatorTests
+	{
+		static readonly byte[] key = new byte[]
+		{
+			0x42, 0x49, 0x53, 0x53, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x2d, 0x6b, 0x65, 0x79, 0x2d, 0x30, 0x31
+		};
+
+		public static void Run()
+		{
+			AcceptsOnce();
+			RejectsForgery();
+			RejectsReplayAfterManyPackets();
+		}
+
+		static ParseError parse(PacketAuthenticator authenticator, byte[] datagram)
+		{
+			ParseError error;
+			Packet.Parse(datagram, authenticator, out error);
+
+			return error;
+		}
+
+		static void AcceptsOnce()
+		{
+			PacketAuthenticator authenticator = new PacketAuthenticator(key);
+			byte[] datagram = new Packet(MessageType.BakeryIsThere, 1).GenerateDatagram(authenticator);
+			byte[] scheduled = new Packet(MessageType.BakeryIsThere, 2, DateTime.UtcNow.AddSeconds(5)).GenerateDatagram(authenticator);
+
+			Program.CheckEqual(ParseError.None, parse(authenticator, datagram), "first reception");
+			Program.CheckEqual(ParseError.Replay, parse(authenticator, datagram), "second reception");
+			Program.CheckEqual(ParseError.None, parse(authenticator, scheduled), "first reception of a scheduled packet");
+			Program.CheckEqual(ParseError.Replay, parse(authenticator, scheduled), "second reception of a scheduled packet");
+		}
+
+		static void RejectsForgery()
+		{
+			PacketAuthenticator authenticator = new PacketAuthenticator(key);
+			byte[] datagram = new Packet(MessageType.BakeryIsThere, 1).GenerateDatagram(authenticator);
+			byte[] otherKey = (byte[])key.Clone();
+			otherKey[0] ^= 1;
+
+			// Changed message type
+			byte[] changed = (byte[])datagram.Clone();
+			changed[8] ^= 1;
+			Program.CheckEqual(ParseError.Authentication, parse(authenticator, changed), "changed packet");
+
+			// Signed with another key
+			byte[] foreign = new Packet(MessageType.BakeryIsThere, 1).GenerateDatagram(new PacketAuthenticator(otherKey));
+			Program.CheckEqual(ParseError.Authentication, parse(authenticator, foreign), "packet of another key");
+
+			// Unauthenticated
+			byte[] plain = new Packet(MessageType.BakeryIsThere, 1).GenerateDatagram();
+			Program.CheckEqual(ParseError.Unauthenticated, parse(authenticator, plain), "unauthenticated packet");
+
+			Program.CheckEqual(ParseError.None, parse(authenticator, datagram), "original packet");
+		}
+
+		static void RejectsReplayAfterManyPackets()
+		{
+			PacketAuthenticator authenticator = new PacketAuthenticator(key);
+			byte[] captured = new Packet(MessageType.BakeryIsThere, 0).GenerateDatagram(authenticator);
+			int accepted = 0;
+
+			Program.CheckEqual(ParseError.None, parse(authenticator, captured), "captured packet");
+
+			// Much more packets than a site sends within the replay window
+			for (ushort a = 1; a <= 1000; a++)
+			{
+				if (parse(authenticator, new Packet(MessageType.BakeryIsThere, a).GenerateDatagram(authenticator)) == ParseError.None)
+					accepted++;
+			}
+
+			Program.CheckEqual(1000, accepted, "accepted packets");
+			Program.CheckEqual(ParseError.Replay, parse(authenticator, captured), "replayed packet");
+		}
+	}
+}
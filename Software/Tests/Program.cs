@@ -0,0 +1,60 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+
+namespace BISS.Tests
+{
+	/// <summary>
+	/// Runs the unit tests and prints the failed checks.
+	/// </summary>
+	static class Program
+	{
+		static int checks;
+		static int failures;
+
+		/// <summary>
+		/// Counts a check and prints it if it failed.
+		/// </summary>
+		/// <param name="condition">Result of the check.</param>
+		/// <param name="message">Describes the check.</param>
+		public static void Check(bool condition, string message,
+			[CallerFilePath] string file = "", [CallerLineNumber] int line = 0)
+		{
+			checks++;
+
+			if (!condition)
+			{
+				failures++;
+				Console.WriteLine("{0}:{1}: check failed: {2}", file, line, message);
+			}
+		}
+
+		/// <summary>
+		/// Counts a check of a value and prints it if it differs from the expected one.
+		/// </summary>
+		public static void CheckEqual<T>(T expected, T actual, string message,
+			[CallerFilePath] string file = "", [CallerLineNumber] int line = 0)
+		{
+			checks++;
+
+			if (!Equals(expected, actual))
+			{
+				failures++;
+				Console.WriteLine("{0}:{1}: {2} is {3}, expected {4}", file, line, message, actual, expected);
+			}
+		}
+
+		/// <summary>
+		/// Runs all tests.
+		/// </summary>
+		static int Main(string[] args)
+		{
+			PacketAuthenticatorTests.Run();
+			SourceRateLimiterTests.Run();
+			HubReceiverTests.Run();
+
+			Console.WriteLine("{0} checks, {1} failed", checks, failures);
+
+			return failures;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+﻿using System;
+using System.Diagnostics;
+using System.Net;
+using BISS.Networking;
+
+namespace BISS.Tests
+{
+	/// <summary>
+	/// Tests of <see cref="SourceRateLimiter"/>.
+	/// </summary>
+	static class SourceRateLimiterTests
+	{
+		/// <summary>
+		/// Rate limiter with a clock advanced by the test.
+		/// </summary>
+		class ClockedLimiter : SourceRateLimiter
+		{
+			public long Now = Stopwatch.GetTimestamp();
+
+			public ClockedLimiter()
+				: base(10, 20, 256)
+			{ }
+
+			public void Advance(double seconds)
+			{
+				this.Now += (long)(seconds * Stopwatch.Frequency);
+			}
+
+			protected override long GetTimestamp()
+			{
+				return this.Now;
+			}
+		}
+
+		public static void Run()
+		{
+			LimitsSource();
+			LimitsFloodFromManySources();
+			KeepsTrackedSourcesDuringFlood();
+		}
+
+		static IPAddress address(int number)
+		{
+			return new IPAddress(new byte[] { 10, (byte)(number >> 16), (byte)(number >> 8), (byte)number });
+		}
+
+		static int acquire(SourceRateLimiter limiter, IPAddress source, int count)
+		{
+			int accepted = 0;
+
+			for (int a = 0; a < count; a++)
+			{
+				if (limiter.TryAcquire(source))
+					accepted++;
+			}
+
+			return accepted;
+		}
+
+		static void LimitsSource()
+		{
+			ClockedLimiter limiter = new ClockedLimiter();
+			IPAddress source = address(1);
+
+			Program.CheckEqual(1, acquire(limiter, source, 100), "accepted datagrams of a new source");
+
+			limiter.Advance(0.5);
+			Program.CheckEqual(5, acquire(limiter, source, 100), "accepted datagrams after 0.5 s");
+
+			limiter.Advance(10);
+			Program.CheckEqual(20, acquire(limiter, source, 100), "accepted datagrams after 10 s");
+			Program.CheckEqual(1, limiter.ThrottledSources, "throttled sources");
+		}
+
+		static void LimitsFloodFromManySources()
+		{
+			ClockedLimiter limiter = new ClockedLimiter();
+			int accepted = 0;
+
+			// Each address is used once per round, more than the tracked ones.
+			for (int round = 0; round < 3; round++)
+			{
+				for (int a = 0; a < 4 * limiter.Capacity; a++)
+					accepted += acquire(limiter, address(a), 1);
+			}
+
+			Program.CheckEqual(limiter.Burst, accepted, "accepted datagrams of the flood");
+
+			accepted = 0;
+			for (int second = 0; second < 10; second++)
+			{
+				limiter.Advance(1);
+
+				for (int a = 0; a < 4 * limiter.Capacity; a++)
+					accepted += acquire(limiter, address(100000 + second * 10000 + a), 1);
+			}
+
+			// The shared bucket was filled a moment after the clock of the test was read.
+			Program.Check(accepted >= 10 * limiter.Rate - 1 && accepted <= 10 * limiter.Rate,
+				String.Format("{0} accepted datagrams of a flood lasting 10 s", accepted));
+		}
+
+		static void KeepsTrackedSourcesDuringFlood()
+		{
+			ClockedLimiter limiter = new ClockedLimiter();
+			IPAddress source = address(1);
+
+			Program.CheckEqual(1, acquire(limiter, source, 1), "first datagram");
+			limiter.Advance(10);
+
+			for (int a = 0; a < 10 * limiter.Capacity; a++)
+				acquire(limiter, address(1000 + a), 1);
+
+			Program.CheckEqual(limiter.Burst, acquire(limiter, source, 100), "accepted datagrams of a tracked source");
+		}
+	}
+}